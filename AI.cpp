@@ -4,9 +4,14 @@
 #include "Game/ActorDefinition.hpp"
 #include "Game/WeaponDefinition.hpp"
 #include "Game/Weapon.hpp"
+#include "Game/Profiler.hpp"
 #include "Engine/Renderer/DebugRenderSystem.hpp"
 
 
+//flow field cost below which an AI stops pathing and heads straight for its target
+static const float k_directChaseFlowCost = 1.5f;
+
+
 //
 //constructor
 //
@@ -21,6 +26,8 @@ AI::AI(Map* map)
 //
 void AI::Update(float deltaSeconds)
 {
+	PROFILE_SCOPE("AI::Update");
+
 	Actor* thisActor = m_map->GetActorByUID(m_actorUID);
 
 	if (thisActor->m_health <= 0)
@@ -30,7 +37,7 @@ void AI::Update(float deltaSeconds)
 
 	Actor* targetActor = nullptr;
 	
-	if (m_targetUID.m_data == ActorUID::INVALID)
+	if (!m_targetUID.IsValid())
 	{
 		if (thisActor->m_definition->m_faction == ActorFaction::DEMON)
 		{
@@ -54,40 +61,38 @@ void AI::Update(float deltaSeconds)
 	if (targetActor != nullptr && thisActor != nullptr)
 	{
 		//don't go through with moving, turning, or attacking logic if being looked at
-		if (thisActor->m_definition->m_freezeWhenSeen)
+		if (thisActor->m_definition->m_freezeWhenSeen && m_map->IsActorWatchedBy(thisActor, targetActor))
 		{
-			Vec3 targetFacingDirection = targetActor->GetModelMatrixYawOnly().GetIBasis3D();
-			Vec3 eyeHeightVector = Vec3(0.0f, 0.0f, 1.0f) * targetActor->m_definition->m_eyeHeight;
-			Vec3 targetToSelf = thisActor->m_position - targetActor->m_position;
-
-			//Vec3 thisActorJBasisLeft = thisActor->GetModelMatrixYawOnly().GetJBasis3D() * thisActor->m_physicsRadius;
-			Vec3 thisActorJBasisLeft = thisActor->m_billboardMatrix.GetJBasis3D() * thisActor->m_physicsRadius;
-			Vec3 startPointLeft = thisActor->m_position + thisActorJBasisLeft + eyeHeightVector;
-			Vec3 startPointLeftToTarget = (targetActor->m_position + eyeHeightVector - startPointLeft).GetNormalized();
-			Vec3 startPointRight = thisActor->m_position - thisActorJBasisLeft + eyeHeightVector;
-			Vec3 startPointRightToTarget = (targetActor->m_position + eyeHeightVector - startPointRight).GetNormalized();
+			thisActor->m_velocity = Vec3(0.0f, 0.0f, 0.0f);
+			thisActor->m_acceleration = Vec3(0.0f, 0.0f, 0.0f);
+			return;
+		}
 
-			RaycastResult3D raycastWallLeft = m_map->RaycastAgainstTilesXY(startPointLeft, startPointLeftToTarget, thisActor->m_definition->m_sightRadius);
-			RaycastResultGame raycastTargetLeft = m_map->RaycastAgainstPlayers(startPointLeft, startPointLeftToTarget, thisActor->m_definition->m_sightRadius, thisActor);
-			RaycastResult3D raycastWallRight = m_map->RaycastAgainstTilesXY(startPointRight, startPointRightToTarget, thisActor->m_definition->m_sightRadius);
-			RaycastResultGame raycastTargetRight = m_map->RaycastAgainstPlayers(startPointRight, startPointRightToTarget, thisActor->m_definition->m_sightRadius, thisActor);
+		//follow the target's shared flow field around walls until it's within a tile, then chase it directly
+		Vec3 moveDirection = thisActor->GetModelMatrixYawOnly().GetIBasis3D();
+		Vec3 turnDirection = (targetActor->m_position - thisActor->m_position).GetNormalized();
 
-			if (DotProduct3D(targetFacingDirection, targetToSelf) > 0.0f && 
-				((raycastWallLeft.m_impactDist > raycastTargetLeft.m_raycastResult.m_impactDist && raycastTargetLeft.m_actorHit == targetActor) 
-					|| (raycastWallRight.m_impactDist > raycastTargetRight.m_raycastResult.m_impactDist && raycastTargetRight.m_actorHit == targetActor)))
+		FlowField const* flowField = m_map->GetFlowFieldToActor(targetActor);
+		if (flowField != nullptr)
+		{
+			float costToTarget = flowField->GetCostToGoalAtPosition(thisActor->m_position);
+			if (costToTarget > k_directChaseFlowCost && costToTarget != FLT_MAX)
 			{
-				thisActor->m_velocity = Vec3(0.0f, 0.0f, 0.0f);
-				thisActor->m_acceleration = Vec3(0.0f, 0.0f, 0.0f);
-				return;
+				Vec3 flowDirection = flowField->GetFlowDirectionAtPosition(thisActor->m_position);
+				if (flowDirection != Vec3())
+				{
+					moveDirection = flowDirection;
+					turnDirection = flowDirection;
+				}
 			}
 		}
 
 		float distToTarget = GetDistance3D(thisActor->m_position, targetActor->m_position);
 		if (distToTarget > thisActor->m_physicsRadius + targetActor->m_physicsRadius + 0.01f)
 		{
-			thisActor->MoveInDirection(thisActor->GetModelMatrixYawOnly().GetIBasis3D(), thisActor->m_definition->m_runSpeed);
+			thisActor->MoveInDirection(moveDirection, thisActor->m_definition->m_runSpeed);
 		}
-		thisActor->TurnInDirection((targetActor->m_position - thisActor->m_position).GetNormalized(), thisActor->m_definition->m_turnSpeed * deltaSeconds);
+		thisActor->TurnInDirection(turnDirection, thisActor->m_definition->m_turnSpeed * deltaSeconds);
 
 		if (thisActor->m_currentWeapon != nullptr && thisActor->m_currentWeapon->m_definition->m_meleeCount > 0 && distToTarget < thisActor->m_currentWeapon->m_definition->m_meleeRange)
 		{
@@ -8,6 +8,7 @@
 #include "Game/AI.hpp"
 #include "Game/Player.hpp"
 #include "Game/GameCommon.hpp"
+#include "Game/PerfCounters.hpp"
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Core/VertexUtils.hpp"
 #include "Engine/Renderer/Renderer.hpp"
@@ -25,6 +26,7 @@ Actor::Actor(ActorUID uid, ActorDefinition const* definition, Map* map, Vec3 pos
 	, m_definition(definition)
 	, m_map(map)
 	, m_position(position)
+	, m_previousPosition(position)
 	, m_orientation(orientation)
 	, m_physicsHeight(definition->m_physicsHeight)
 	, m_physicsRadius(definition->m_physicsRadius)
@@ -46,6 +48,8 @@ Actor::Actor(ActorUID uid, ActorDefinition const* definition, Map* map, Vec3 pos
 	{
 		m_isStatic = true;
 	}
+
+	m_archetypeMask = m_definition->GetArchetypeMask();
 }
 
 
@@ -104,19 +108,14 @@ void Actor::Startup()
 
 void Actor::Update(float deltaSeconds)
 {
-	if (m_AIController != nullptr && m_currentController == m_AIController)
-	{
-		m_AIController->Update(deltaSeconds);
-	}
-	
+	//ai and physics run as their own passes over the matching archetypes, see Map::UpdateActorAI and Map::UpdateActorPhysics
 	if (m_health <= 0 && m_definition->m_corpseLifetime > 0.0f)
 	{
 		if (m_deathTimer <= 0.0f)
 		{
 			if (m_definition->m_sounds.size() > 1)
 			{
-				SoundPlaybackID soundPlayback = g_theAudio->StartSoundAt(m_definition->m_sounds[1], m_position);
-				AddSoundToSoundPlaybacks(soundPlayback);
+				StartActorSound(m_definition->m_sounds[1]);
 			}
 		}
 		m_deathTimer += deltaSeconds;
@@ -124,14 +123,9 @@ void Actor::Update(float deltaSeconds)
 	}
 	if (m_deathTimer >= m_definition->m_corpseLifetime && m_definition->m_corpseLifetime > 0.0f)
 	{
-		m_isGarbage = true;
+		m_map->m_commandBuffer->QueueDestroy(m_UID);
 	}
 	
-	if (m_definition->m_isSimulated && m_health > 0)
-	{
-		UpdatePhysics(deltaSeconds);
-	}
-
 	/*if (!m_definition->m_isFlying)
 	{
 		m_position.z = 0.0f;
@@ -161,109 +155,102 @@ void Actor::Update(float deltaSeconds)
 		}
 		else
 		{
-			if (m_weaponSoundIndex < m_soundPlaybacks.size())
+			if (m_weaponVoiceID != INVALID_VOICE_ID)
 			{
-				g_theAudio->StopSound(m_soundPlaybacks[m_weaponSoundIndex]);
-				m_weaponSoundIndex = -1;
+				m_map->m_voiceManager->StopVoice(m_weaponVoiceID);
+				m_weaponVoiceID = INVALID_VOICE_ID;
 			}
 			m_currentWeapon->SetAnimationByName("Idle");
 		}
 	}
-
-	//sound updating
-	for (int soundIndex = 0; soundIndex < m_soundPlaybacks.size(); soundIndex++)
-	{
-		if (g_theAudio->IsPlaying(m_soundPlaybacks[soundIndex]))
-		{
-			g_theAudio->SetSoundPosition(m_soundPlaybacks[soundIndex], m_position);
-		}
-	}
 }
 
 
 void Actor::Render(int currentPlayerRendering)
 {
-	if (m_definition->m_isVisible)
+	//only called for visible archetypes, so there is no visibility check here
+	std::vector<Vertex_PNCU> actorVerts;
+
+	//don't render the actor currently controlled by the player
+	if (m_currentController != nullptr && m_map->m_currentPlayerActors[currentPlayerRendering] == this)
 	{
-		std::vector<Vertex_PNCU> actorVerts;
+		return;
+	}
 
-		//don't render the actor currently controlled by the player
-		if (m_currentController != nullptr && m_map->m_currentPlayerActors[currentPlayerRendering] == this)
-		{
-			return;
-		}
+	//don't render if we don't have a current anim group
+	if (m_currentAnimGroup == nullptr)
+	{
+		return;
+	}
 
-		//don't render if we don't have a current anim group
-		if (m_currentAnimGroup == nullptr)
-		{
-			return;
-		}
+	if (m_animClock->GetTotalSeconds() > m_currentAnimGroup->m_secondsPerFrame * m_currentAnimGroup->m_numFrames && m_currentAnimGroup->m_playbackMode == SpriteAnimPlaybackType::ONCE)
+	{
+		SetAnimationByName("Walk");
+	}
 
-		if (m_animClock->GetTotalSeconds() > m_currentAnimGroup->m_secondsPerFrame * m_currentAnimGroup->m_numFrames && m_currentAnimGroup->m_playbackMode == SpriteAnimPlaybackType::ONCE)
-		{
-			SetAnimationByName("Walk");
-		}
+	if (m_currentAnimGroup->m_scaleBySpeed)
+	{
+		m_animClock->SetTimeScale(m_velocity.GetLength() / m_definition->m_runSpeed);
+	}
+	else
+	{
+		m_animClock->SetTimeScale(1.0f);
+	}
 
-		if (m_currentAnimGroup->m_scaleBySpeed)
-		{
-			m_animClock->SetTimeScale(m_velocity.GetLength() / m_definition->m_runSpeed);
-		}
-		else
-		{
-			m_animClock->SetTimeScale(1.0f);
-		}
+	Vec3 renderPosition = GetRenderPosition();
 
-		int direction = 0;
-		float maxDotProduct = -FLT_MAX;
-		for (int directionIndex = 0; directionIndex < m_currentAnimGroup->m_directions.size(); directionIndex++)
-		{
-			Vec3 cameraViewVector = m_position - m_map->m_players[currentPlayerRendering]->m_playerCamera.GetCameraPosition();
-			cameraViewVector.z = 0.0f;
-			cameraViewVector.Normalize();
-			cameraViewVector = GetTrueModelMatrix().GetOrthonormalInverse().TransformVectorQuantity3D(cameraViewVector);
+	int direction = 0;
+	float maxDotProduct = -FLT_MAX;
+	for (int directionIndex = 0; directionIndex < m_currentAnimGroup->m_directions.size(); directionIndex++)
+	{
+		Vec3 cameraViewVector = renderPosition - m_map->m_players[currentPlayerRendering]->m_playerCamera.GetCameraPosition();
+		cameraViewVector.z = 0.0f;
+		cameraViewVector.Normalize();
+		cameraViewVector = GetTrueModelMatrix().GetOrthonormalInverse().TransformVectorQuantity3D(cameraViewVector);
 
-			float dotProduct = DotProduct3D(m_currentAnimGroup->m_directions[directionIndex], cameraViewVector);
+		float dotProduct = DotProduct3D(m_currentAnimGroup->m_directions[directionIndex], cameraViewVector);
 
-			if (dotProduct > maxDotProduct)
-			{
-				maxDotProduct = dotProduct;
-				direction = directionIndex;
-			}
+		if (dotProduct > maxDotProduct)
+		{
+			maxDotProduct = dotProduct;
+			direction = directionIndex;
 		}
+	}
 
-		SpriteDefinition const& spriteDef = m_currentAnimGroup->m_spriteAnimDefs[direction].GetSpriteDefAtTime(m_animClock->GetTotalSeconds());
-		AABB2 spriteUVs = spriteDef.GetUVs();
+	SpriteDefinition const& spriteDef = m_currentAnimGroup->m_spriteAnimDefs[direction].GetSpriteDefAtTime(m_animClock->GetTotalSeconds());
+	AABB2 spriteUVs = spriteDef.GetUVs();
 
-		Vec3 spriteBottomLeft = Vec3();
-		Vec3 spriteBottomRight = spriteBottomLeft + Vec3(0.0f, m_definition->m_spriteSize.x, 0.0f);
-		Vec3 spriteTopLeft = spriteBottomLeft + Vec3(0.0f, 0.0f, m_definition->m_spriteSize.y);
-		Vec3 spriteTopRight = spriteBottomRight + Vec3(0.0f, 0.0f, m_definition->m_spriteSize.y);
-		if (m_definition->m_renderRounded)
-		{
-			AddVertsForRoundedQuad3D(actorVerts, spriteBottomLeft, spriteBottomRight, spriteTopLeft, spriteTopRight, Rgba8(), spriteUVs);
-		}
-		else
-		{
-			AddVertsForQuad3D(actorVerts, spriteBottomLeft, spriteBottomRight, spriteTopLeft, spriteTopRight, Rgba8(), spriteUVs);
-		}
+	Vec3 spriteBottomLeft = Vec3();
+	Vec3 spriteBottomRight = spriteBottomLeft + Vec3(0.0f, m_definition->m_spriteSize.x, 0.0f);
+	Vec3 spriteTopLeft = spriteBottomLeft + Vec3(0.0f, 0.0f, m_definition->m_spriteSize.y);
+	Vec3 spriteTopRight = spriteBottomRight + Vec3(0.0f, 0.0f, m_definition->m_spriteSize.y);
+	if (m_definition->m_renderRounded)
+	{
+		AddVertsForRoundedQuad3D(actorVerts, spriteBottomLeft, spriteBottomRight, spriteTopLeft, spriteTopRight, Rgba8(), spriteUVs);
+	}
+	else
+	{
+		AddVertsForQuad3D(actorVerts, spriteBottomLeft, spriteBottomRight, spriteTopLeft, spriteTopRight, Rgba8(), spriteUVs);
+	}
 
-		Vec3 pivotTranslation = (Vec3() - Vec3(0.0f, m_definition->m_spritePivot.x * m_definition->m_spriteSize.x, m_definition->m_spritePivot.y * m_definition->m_spriteSize.y));
-		Mat44 pivotTranslationMatrix = Mat44::CreateTranslation3D(pivotTranslation);
-		TransformVertexArray3D(actorVerts, pivotTranslationMatrix);
+	Vec3 pivotTranslation = (Vec3() - Vec3(0.0f, m_definition->m_spritePivot.x * m_definition->m_spriteSize.x, m_definition->m_spritePivot.y * m_definition->m_spriteSize.y));
+	Mat44 pivotTranslationMatrix = Mat44::CreateTranslation3D(pivotTranslation);
+	TransformVertexArray3D(actorVerts, pivotTranslationMatrix);
 
-		Mat44 cameraMatrix = m_map->m_players[currentPlayerRendering]->m_playerCamera.GetViewMatrix().GetOrthonormalInverse();
-		m_billboardMatrix = GetBillboardMatrix(m_definition->m_billboardType, cameraMatrix, m_position);
-		TransformVertexArray3D(actorVerts, m_billboardMatrix);
+	Mat44 cameraMatrix = m_map->m_players[currentPlayerRendering]->m_playerCamera.GetViewMatrix().GetOrthonormalInverse();
+	m_billboardMatrix = GetBillboardMatrix(m_definition->m_billboardType, cameraMatrix, renderPosition);
+	TransformVertexArray3D(actorVerts, m_billboardMatrix);
 
-		Mat44 translationMatrix = Mat44::CreateTranslation3D(m_position);
-		TransformVertexArray3D(actorVerts, translationMatrix);
+	Mat44 translationMatrix = Mat44::CreateTranslation3D(renderPosition);
+	TransformVertexArray3D(actorVerts, translationMatrix);
 
-		g_theRenderer->BindShader(m_definition->m_shader);
-		g_theRenderer->BindTexture(&m_definition->m_spriteSheet->GetTexture());
-		g_theRenderer->SetModelConstants();
-		g_theRenderer->SetRasterizerMode(RasterizerMode::SOLID_CULL_BACK);
-		g_theRenderer->DrawVertexArray(static_cast<int>(actorVerts.size()), actorVerts.data());
-	}
+	g_theRenderer->BindShader(m_definition->m_shader);
+	g_theRenderer->BindTexture(&m_definition->m_spriteSheet->GetTexture());
+	g_theRenderer->SetModelConstants();
+	g_theRenderer->SetRasterizerMode(RasterizerMode::SOLID_CULL_BACK);
+	g_theRenderer->DrawVertexArray(static_cast<int>(actorVerts.size()), actorVerts.data());
+	IncrementPerfCounter(PerfCounter::MAP_DRAW_CALLS);
+	IncrementPerfCounter(PerfCounter::MAP_BYTES_UPLOADED, static_cast<int>(actorVerts.size() * sizeof(Vertex_PNCU)));
 }
 
 
@@ -277,28 +264,64 @@ void Actor::UpdatePhysics(float deltaSeconds)
 		m_velocity.z = 0.0f;
 	}
 
+	//drag alone always settles an actor, so only what was pushed on it from outside counts toward staying awake
+	float appliedAccelerationSquared = m_acceleration.GetLengthSquared();
+
 	Vec3 dragForce = (Vec3() - m_velocity) * m_definition->m_drag;
-	AddForce(dragForce);
+	m_acceleration += dragForce;
 	
 	m_velocity += m_acceleration * deltaSeconds;
 	m_position += m_velocity * deltaSeconds;
 
 	m_acceleration = Vec3();
+
+	float sleepSpeed = m_map->m_actorSleepSpeed;
+	float sleepAcceleration = m_map->m_actorSleepAcceleration;
+	if (m_velocity.GetLengthSquared() < sleepSpeed * sleepSpeed && appliedAccelerationSquared < sleepAcceleration * sleepAcceleration)
+	{
+		m_restingTicks++;
+		if (m_restingTicks >= m_map->m_actorSleepTicks)
+		{
+			m_isSleeping = true;
+			m_velocity = Vec3();
+		}
+	}
+	else
+	{
+		m_restingTicks = 0;
+	}
 }
 
 
 void Actor::AddForce(Vec3 const& forceVector)
 {
+	if (m_isSleeping && forceVector != Vec3())
+	{
+		WakeUp();
+	}
+
 	m_acceleration += forceVector;
 }
 
 
 void Actor::AddImpulse(Vec3 const& impulseVector)
 {
+	if (impulseVector != Vec3())
+	{
+		WakeUp();
+	}
+
 	m_velocity += impulseVector;
 }
 
 
+void Actor::WakeUp()
+{
+	m_isSleeping = false;
+	m_restingTicks = 0;
+}
+
+
 //
 //public callback functions
 //
@@ -317,16 +340,16 @@ void Actor::OnCollideWithActor(Actor* otherActor)
 
 	if (otherActor != nullptr)
 	{
-		if (m_projectileOwner != nullptr)
+		if (m_projectileOwnerUID.IsValid())
 		{
-			otherActor->TakeDamage(m_projectileOwner->m_UID, damageAmount);
+			m_map->m_commandBuffer->QueueDamage(otherActor->m_UID, m_projectileOwnerUID, damageAmount);
 		}
 		else
 		{
-			otherActor->TakeDamage(m_UID, damageAmount);
+			m_map->m_commandBuffer->QueueDamage(otherActor->m_UID, m_UID, damageAmount);
 		}
 
-		otherActor->AddImpulse(GetModelMatrixYawOnly().GetIBasis3D() * m_definition->m_impulseOnCollide);
+		m_map->m_commandBuffer->QueueImpulse(otherActor->m_UID, GetModelMatrixYawOnly().GetIBasis3D() * m_definition->m_impulseOnCollide);
 	}
 	
 	OnCollide();
@@ -335,6 +358,7 @@ void Actor::OnCollideWithActor(Actor* otherActor)
 
 void Actor::OnPossessed(Controller* controller)
 {
+	WakeUp();
 	m_currentController = controller;
 }
 
@@ -355,6 +379,7 @@ void Actor::TakeDamage(ActorUID source, int damageAmount)
 {
 	if (m_health > 0 && damageAmount > 0)
 	{
+		WakeUp();
 		m_health -= damageAmount;
 
 		if (m_AIController != nullptr && m_AIController == m_currentController && damageAmount > 0)
@@ -368,25 +393,20 @@ void Actor::TakeDamage(ActorUID source, int damageAmount)
 		{
 			m_health = 0;
 
-			Actor* damageSource = m_map->GetActorByUID(source);
-
-			if (this == m_map->m_currentPlayerActors[0] && damageSource != nullptr && damageSource == m_map->m_currentPlayerActors[1])
-			{
-				m_map->m_players[0]->m_numPlayerDeaths += 1;
-				m_map->m_players[1]->m_numPlayerKills += 1;
-			}
-			else if (this == m_map->m_currentPlayerActors[1] && damageSource != nullptr && damageSource == m_map->m_currentPlayerActors[0])
+			//any player killing another player's actor scores, suicides and monster kills don't
+			int victimPlayerIndex = m_map->GetPlayerIndexForActor(this);
+			int killerPlayerIndex = m_map->GetPlayerIndexForActor(m_map->GetActorByUID(source));
+			if (victimPlayerIndex != -1 && killerPlayerIndex != -1 && victimPlayerIndex != killerPlayerIndex)
 			{
-				m_map->m_players[1]->m_numPlayerDeaths += 1;
-				m_map->m_players[0]->m_numPlayerKills += 1;
+				m_map->m_players[victimPlayerIndex]->m_numPlayerDeaths += 1;
+				m_map->m_players[killerPlayerIndex]->m_numPlayerKills += 1;
 			}
 		}
 
 		//damage sound
 		if (m_definition->m_sounds.size() > 0 && m_health > 0)
 		{
-			SoundPlaybackID soundPlayback = g_theAudio->StartSoundAt(m_definition->m_sounds[0], m_position);
-			AddSoundToSoundPlaybacks(soundPlayback);
+			StartActorSound(m_definition->m_sounds[0]);
 		}
 	}
 }
@@ -426,16 +446,15 @@ void Actor::Attack()
 		{
 			if (m_currentWeapon->m_definition->m_holdToUse)
 			{
-				if (m_weaponSoundIndex == -1)
+				//the looping voice is started right away since the actor has to hold on to its ID to stop it later
+				if (m_weaponVoiceID == INVALID_VOICE_ID)
 				{
-					SoundPlaybackID soundPlayback = g_theAudio->StartSoundAt(m_currentWeapon->m_definition->m_sounds[0], m_position, true, 0.2f);
-					m_weaponSoundIndex = AddSoundToSoundPlaybacks(soundPlayback);
+					m_weaponVoiceID = m_map->m_voiceManager->StartVoice(m_currentWeapon->m_definition->m_sounds[0], m_UID, m_position, true, 0.2f, GetSoundPriority());
 				}
 			}
 			else
 			{
-				SoundPlaybackID soundPlayback = g_theAudio->StartSoundAt(m_currentWeapon->m_definition->m_sounds[0], m_position);
-				AddSoundToSoundPlaybacks(soundPlayback);
+				StartActorSound(m_currentWeapon->m_definition->m_sounds[0]);
 			}
 		}
 	}
@@ -477,19 +496,21 @@ void Actor::SetAnimationByName(std::string animName)
 //
 //sound functions
 //
-int Actor::AddSoundToSoundPlaybacks(SoundPlaybackID soundPlayback)
+void Actor::StartActorSound(SoundID soundID, bool isLooping, float volume)
 {
-	for (int playbackIndex = 0; playbackIndex < m_soundPlaybacks.size(); playbackIndex++)
+	m_map->m_commandBuffer->QueueSound(soundID, m_UID, m_position, isLooping, volume, GetSoundPriority());
+}
+
+
+VoicePriority Actor::GetSoundPriority() const
+{
+	//whatever a player is doing should never get cut off by the crowd
+	if (m_currentController != nullptr && m_currentController != m_AIController)
 	{
-		if (!g_theAudio->IsPlaying(m_soundPlaybacks[playbackIndex]))
-		{
-			m_soundPlaybacks[playbackIndex] = soundPlayback;
-			return playbackIndex;
-		}
+		return VoicePriority::HIGH;
 	}
 
-	m_soundPlaybacks.push_back(soundPlayback);
-	return static_cast<int>(m_soundPlaybacks.size()) - 1;
+	return VoicePriority::NORMAL;
 }
 
 
@@ -508,6 +529,12 @@ Mat44 Actor::GetModelMatrixYawOnly() const
 }
 
 
+Vec3 Actor::GetRenderPosition() const
+{
+	return m_previousPosition + (m_position - m_previousPosition) * m_map->m_renderAlpha;
+}
+
+
 Mat44 Actor::GetTrueModelMatrix() const
 {
 	Mat44 modelMatrix = m_orientation.GetAsMatrix_XFwd_YLeft_ZUp();
@@ -1,5 +1,6 @@
 #pragma once
 #include "Game/ActorUID.hpp"
+#include "Game/VoiceManager.hpp"
 #include "Engine/Math/EulerAngles.hpp"
 #include "Engine/Math/Vec3.hpp"
 #include "Engine/Core/Rgba8.hpp"
@@ -36,6 +37,7 @@ public:
 	void UpdatePhysics(float deltaSeconds);
 	void AddForce(Vec3 const& forceVector);
 	void AddImpulse(Vec3 const& impulseVector);
+	void WakeUp();
 
 	//callback functions
 	void OnCollide();
@@ -54,11 +56,13 @@ public:
 	void SetAnimationByName(std::string animName);
 
 	//sound functions
-	int AddSoundToSoundPlaybacks(SoundPlaybackID soundPlayback);
+	void StartActorSound(SoundID soundID, bool isLooping = false, float volume = 1.0f);
+	VoicePriority GetSoundPriority() const;
 
 	//accessors
 	Mat44 GetModelMatrixYawOnly() const;
 	Mat44 GetTrueModelMatrix() const;
+	Vec3  GetRenderPosition() const;
 
 //public member variables
 public:
@@ -67,20 +71,23 @@ public:
 	ActorDefinition const*  m_definition;
 
 	std::vector<Weapon*>	m_weapons;
-	Weapon*					m_currentWeapon;
+	Weapon*					m_currentWeapon = nullptr;
 
 	Map*   m_map;
-	Actor* m_projectileOwner;
+	ActorUID m_projectileOwnerUID = ActorUID(ActorUID::INVALID, ActorUID::INVALID);	//a handle, the owner can be deleted while its projectile is in flight
 
-	Controller* m_currentController;
-	AI*			m_AIController;
+	Controller* m_currentController = nullptr;
+	AI*			m_AIController = nullptr;
 	
 	Vec3 m_position;
+	Vec3 m_previousPosition;	//position at the start of the current simulation tick, for render interpolation
 	Vec3 m_velocity;
 	Vec3 m_acceleration;
 	EulerAngles m_orientation;
 
 	bool m_isStatic = false;
+	bool m_isSleeping = false;	//skipped by physics and map collision until a force, impulse, hit or collision wakes it
+	int	 m_restingTicks = 0;	//ticks in a row spent under the map's sleep limits
 
 	int   m_health = 100;
 	bool  m_isGarbage = false;
@@ -94,8 +101,12 @@ public:
 	Clock*					  m_animClock = nullptr;
 	SpriteAnimGroupDef const* m_currentAnimGroup = nullptr;
 
-	std::vector<SoundPlaybackID> m_soundPlaybacks;
-	int m_weaponSoundIndex = -1;
+	VoiceID m_weaponVoiceID = INVALID_VOICE_ID;
 
 	Mat44 m_billboardMatrix = Mat44();
+
+	unsigned int m_watchedByPlayerMask = 0;	//one bit per player index, refreshed once per tick by Map::UpdateWatchedActors
+
+	unsigned int m_archetypeMask = 0;		//from the definition flags, which never change after spawn
+	int			 m_archetypeListIndex = -1;	//index into the map's actor list for this archetype, -1 while not live
 };
@@ -211,6 +211,23 @@ ActorDefinition::ActorDefinition(XmlElement const& element)
 }
 
 
+//
+//public accessors
+//
+unsigned int ActorDefinition::GetArchetypeMask() const
+{
+	unsigned int archetypeMask = 0;
+	archetypeMask |= m_isSimulated ? ACTOR_ARCHETYPE_SIMULATED : 0;
+	archetypeMask |= m_collideWithWorld ? ACTOR_ARCHETYPE_COLLIDE_WITH_WORLD : 0;
+	archetypeMask |= m_collideWithActors ? ACTOR_ARCHETYPE_COLLIDE_WITH_ACTORS : 0;
+	archetypeMask |= m_isVisible ? ACTOR_ARCHETYPE_VISIBLE : 0;
+	archetypeMask |= m_isAIEnabled ? ACTOR_ARCHETYPE_AI_ENABLED : 0;
+	archetypeMask |= m_isPushable ? ACTOR_ARCHETYPE_PUSHABLE : 0;
+	archetypeMask |= m_isProjectile ? ACTOR_ARCHETYPE_PROJECTILE : 0;
+	return archetypeMask;
+}
+
+
 //
 //static functions
 //
@@ -252,13 +269,14 @@ void ActorDefinition::InitializeProjectileActorDefs()
 		std::string elementName = projectileActorDefElement->Name();
 		GUARANTEE_OR_DIE(elementName == "ActorDefinition", "Child element names in projectile actor definitions xml file must be <ActorDefinition>!");
 		ActorDefinition newProjectileActorDef = ActorDefinition(*projectileActorDefElement);
+		newProjectileActorDef.m_isProjectile = true;
 		s_projectileActorDefinitions.push_back(newProjectileActorDef);
 		projectileActorDefElement = projectileActorDefElement->NextSiblingElement();
 	}
 }
 
 
-ActorDefinition const* ActorDefinition::GetActorDefinition(std::string name)
+ActorDefinition const* ActorDefinition::GetActorDefinition(std::string const& name)
 {
 	for (int defIndex = 0; defIndex < s_actorDefinitions.size(); defIndex++)
 	{
@@ -273,7 +291,7 @@ ActorDefinition const* ActorDefinition::GetActorDefinition(std::string name)
 }
 
 
-ActorDefinition const* ActorDefinition::GetProjectileActorDefinition(std::string name)
+ActorDefinition const* ActorDefinition::GetProjectileActorDefinition(std::string const& name)
 {
 	for (int defIndex = 0; defIndex < s_projectileActorDefinitions.size(); defIndex++)
 	{
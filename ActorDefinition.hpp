@@ -13,6 +13,17 @@ class SpriteSheet;
 class Shader;
 
 
+//definition flags actors are grouped by, every combination is an archetype with its own packed actor list on the map
+constexpr unsigned int ACTOR_ARCHETYPE_SIMULATED = 1 << 0;
+constexpr unsigned int ACTOR_ARCHETYPE_COLLIDE_WITH_WORLD = 1 << 1;
+constexpr unsigned int ACTOR_ARCHETYPE_COLLIDE_WITH_ACTORS = 1 << 2;
+constexpr unsigned int ACTOR_ARCHETYPE_VISIBLE = 1 << 3;
+constexpr unsigned int ACTOR_ARCHETYPE_AI_ENABLED = 1 << 4;
+constexpr unsigned int ACTOR_ARCHETYPE_PUSHABLE = 1 << 5;
+constexpr unsigned int ACTOR_ARCHETYPE_PROJECTILE = 1 << 6;
+constexpr int		   ACTOR_ARCHETYPE_COUNT = 1 << 7;
+
+
 enum class ActorFaction
 {
 	NEUTRAL,
@@ -37,6 +48,7 @@ public:
 	bool		 m_canBePossessed = false;
 	bool		 m_dieOnSpawn = false;
 	bool		 m_immuneToLight = false;
+	bool		 m_isProjectile = false;	//set for everything loaded from the projectile definitions, moved by the projectile system
 
 	//collision parameters
 	float	   m_physicsHeight = 0.0f;
@@ -92,9 +104,12 @@ public:
 	//constructor
 	explicit ActorDefinition(XmlElement const& element);
 
+	//accessors
+	unsigned int GetArchetypeMask() const;
+
 	//static functions
 	static void InitializeActorDefs();
 	static void InitializeProjectileActorDefs();
-	static ActorDefinition const* GetActorDefinition(std::string name);
-	static ActorDefinition const* GetProjectileActorDefinition(std::string name);
+	static ActorDefinition const* GetActorDefinition(std::string const& name);
+	static ActorDefinition const* GetProjectileActorDefinition(std::string const& name);
 };
@@ -3,19 +3,17 @@
 
 //static variable initialization
 unsigned int ActorUID::INVALID = 0xffffffff;
+unsigned long long ActorUID::INVALID_DATA = 0xffffffffffffffffull;
 
 
 //
 //constructor
 //
-ActorUID::ActorUID(unsigned int index, unsigned int salt)
+ActorUID::ActorUID(unsigned int index, unsigned int generation)
 {
-	unsigned int maskedSalt = salt & 65535;
-	unsigned int maskedIndex = index & 65535;
+	unsigned long long shiftedGeneration = static_cast<unsigned long long>(generation) << 32;
 
-	unsigned int shiftedSalt = maskedSalt << 16;
-
-	m_data = shiftedSalt | maskedIndex;
+	m_data = shiftedGeneration | index;
 }
 
 
@@ -24,11 +22,17 @@ ActorUID::ActorUID(unsigned int index, unsigned int salt)
 //
 bool ActorUID::IsValid() const
 {
-	return m_data != INVALID;
+	return m_data != INVALID_DATA;
 }
 
 
 unsigned int ActorUID::GetIndex() const
 {
-	return m_data & 65535;
+	return static_cast<unsigned int>(m_data & 0xffffffff);
+}
+
+
+unsigned int ActorUID::GetGeneration() const
+{
+	return static_cast<unsigned int>(m_data >> 32);
 }
@@ -1,20 +1,23 @@
 #pragma once
 
 
+//index in the low 32 bits, the slot's generation when the actor was spawned in the high 32 bits
 class ActorUID
 {
 //public member functions
 public:
 	//constructor
-	ActorUID(unsigned int index, unsigned int salt);
+	ActorUID(unsigned int index, unsigned int generation);
 
 	//accessors
 	bool IsValid() const;
 	unsigned int GetIndex() const;
+	unsigned int GetGeneration() const;
 
 //public member variables
 public:
-	unsigned int m_data = INVALID;
+	unsigned long long m_data = INVALID_DATA;
 
 	static unsigned int INVALID;
+	static unsigned long long INVALID_DATA;
 };
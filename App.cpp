@@ -1,6 +1,11 @@
 #include "Game/App.hpp"
 #include "Game/Game.hpp"
 #include "Game/GameCommon.hpp"
+#include "Game/Profiler.hpp"
+#include "Game/PerfCounters.hpp"
+#include "Game/InputRecording.hpp"
+#include "Game/JobSystem.hpp"
+#include "Game/Map.hpp"
 #include "Engine/Renderer/Renderer.hpp"
 #include "Engine/Input/InputSystem.hpp"
 #include "Engine/Audio/AudioSystem.hpp"
@@ -11,6 +16,8 @@
 #include "Engine/Renderer/DebugRenderSystem.hpp"
 #include "Engine/Core/XmlUtils.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include <fstream>
 
 
 App* g_theApp = nullptr;
@@ -68,10 +75,23 @@ void App::Startup()
 	debugRenderConfig.m_renderer = g_theRenderer;
 	DebugRenderSystemStartup(debugRenderConfig);
 
+	JobSystemStartup();
+
 	m_theGame = new Game();
 	m_theGame->Startup();
 
+	ProfilerStartup();
+	PerfCountersStartup();
+	InputRecordingStartup();
+
 	SubscribeEventCallbackFunction("quit", Event_Quit);
+	SubscribeEventCallbackFunction("savesnapshot", Event_SaveSnapshot);
+	SubscribeEventCallbackFunction("loadsnapshot", Event_LoadSnapshot);
+	SubscribeEventCallbackFunction("netserver", Event_NetServer);
+	SubscribeEventCallbackFunction("netconnect", Event_NetConnect);
+	SubscribeEventCallbackFunction("netloopback", Event_NetLoopback);
+	SubscribeEventCallbackFunction("netstats", Event_NetStats);
+	SubscribeEventCallbackFunction("netstop", Event_NetStop);
 
 	m_devConsoleCamera.SetOrthoView(Vec2(0.f, 0.f), Vec2(SCREEN_CAMERA_SIZE_X, SCREEN_CAMERA_SIZE_Y));
 
@@ -87,7 +107,20 @@ void App::Startup()
 	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " F: Toggle Camera Mode");
 	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " N: Debug Possess Next Actor");
 	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " P: Pause");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " F10: Spawn Benchmark Horde");
 	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " ~: Open Dev Console");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " profile: Start/Stop Profiling (file=ProfileTrace.json)");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " perfcounters: Print Performance Counters");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " perfoverlay: Toggle Performance Counters Overlay");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " recordinput: Start/Stop Recording Gameplay Input (file=InputRecording.dfr)");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " replayinput: Replay Recorded Gameplay Input (file=InputRecording.dfr headless=false)");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " savesnapshot: Save Map State (file= to also write it to disk)");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " loadsnapshot: Restore Map State (file= to read it from disk)");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " netserver: Host The Current Game (port=27015 headless=false)");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " netconnect: Join A Hosted Game (host=localhost port=27015 controller=false)");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " netloopback: Host The Current Game For In-Process Bots (bots=8)");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " netstats: Print Network Bandwidth And Tick Cost");
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " netstop: Stop Hosting Or Disconnect");
 	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " Escape: Exit Game");
 	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, " Space: Start Game");
 }
@@ -108,6 +141,12 @@ void App::Shutdown()
 	delete m_theGame;
 	m_theGame = nullptr;
 
+	JobSystemShutdown();
+
+	ProfilerShutdown();
+	PerfCountersShutdown();
+	InputRecordingShutdown();
+
 	DebugRenderSystemShutdown();
 
 	g_theAudio->Shutdown();
@@ -141,11 +180,25 @@ void App::RunFrame()
 	//tick the system clock
 	Clock::TickSystemClock();
 
+	PROFILE_SCOPE("App::RunFrame");
+
 	//run through the four parts of the frame
-	BeginFrame();
-	Update();
-	Render();
-	EndFrame();
+	{
+		PROFILE_SCOPE("App::BeginFrame");
+		BeginFrame();
+	}
+	{
+		PROFILE_SCOPE("App::Update");
+		Update();
+	}
+	{
+		PROFILE_SCOPE("App::Render");
+		Render();
+	}
+	{
+		PROFILE_SCOPE("App::EndFrame");
+		EndFrame();
+	}
 }
 
 
@@ -175,6 +228,127 @@ bool App::Event_Quit(EventArgs& args)
 }
 
 
+bool App::Event_SaveSnapshot(EventArgs& args)
+{
+	if (g_theApp == nullptr || m_theGame->m_currentState != GameState::PLAYING)
+	{
+		g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, "Snapshots can only be saved during gameplay");
+		return false;
+	}
+
+	double startSeconds = GetCurrentTimeSeconds();
+	m_theGame->m_currentMap->WriteSnapshot(g_theApp->m_snapshotBuffer);
+	double snapshotMilliseconds = (GetCurrentTimeSeconds() - startSeconds) * 1000.0;
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, Stringf("Saved %d byte snapshot in %.3fms", static_cast<int>(g_theApp->m_snapshotBuffer.size()), snapshotMilliseconds));
+
+	std::string filePath = args.GetValue("file", "");
+	if (!filePath.empty())
+	{
+		std::ofstream snapshotFile(filePath, std::ios::binary);
+		snapshotFile.write(reinterpret_cast<char const*>(g_theApp->m_snapshotBuffer.data()), g_theApp->m_snapshotBuffer.size());
+		if (!snapshotFile.good())
+		{
+			g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, Stringf("Failed to write snapshot to %s", filePath.c_str()));
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+bool App::Event_LoadSnapshot(EventArgs& args)
+{
+	if (g_theApp == nullptr || m_theGame->m_currentState != GameState::PLAYING)
+	{
+		g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, "Snapshots can only be restored during gameplay");
+		return false;
+	}
+
+	std::string filePath = args.GetValue("file", "");
+	if (!filePath.empty() && FileReadToBuffer(g_theApp->m_snapshotBuffer, filePath) <= 0)
+	{
+		g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, Stringf("Failed to read snapshot from %s", filePath.c_str()));
+		return false;
+	}
+
+	double startSeconds = GetCurrentTimeSeconds();
+	if (!m_theGame->m_currentMap->RestoreSnapshot(g_theApp->m_snapshotBuffer))
+	{
+		g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, "Snapshot doesn't match this map or build");
+		return false;
+	}
+
+	double restoreMilliseconds = (GetCurrentTimeSeconds() - startSeconds) * 1000.0;
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, Stringf("Restored snapshot in %.3fms", restoreMilliseconds));
+	return true;
+}
+
+
+bool App::Event_NetServer(EventArgs& args)
+{
+	int port = args.GetValue("port", 27015);
+	bool isHeadless = args.GetValue("headless", false);
+	if (!m_theGame->StartNetServer(static_cast<unsigned short>(port), isHeadless))
+	{
+		g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, Stringf("Couldn't host on port %d, servers have to be started during a local game", port));
+		return false;
+	}
+
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, Stringf("Hosting on port %d", port));
+	return true;
+}
+
+
+bool App::Event_NetConnect(EventArgs& args)
+{
+	std::string hostAddress = args.GetValue("host", "localhost");
+	int port = args.GetValue("port", 27015);
+	int xboxID = args.GetValue("controller", false) ? 0 : -1;
+	if (!m_theGame->ConnectToNetServer(hostAddress, static_cast<unsigned short>(port), xboxID))
+	{
+		g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, Stringf("Couldn't resolve %s", hostAddress.c_str()));
+		return false;
+	}
+
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, Stringf("Connecting to %s:%d", hostAddress.c_str(), port));
+	return true;
+}
+
+
+bool App::Event_NetLoopback(EventArgs& args)
+{
+	int numBots = args.GetValue("bots", 8);
+	if (!m_theGame->StartNetLoopbackTest(numBots))
+	{
+		g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, "Loopback tests have to be started during a local game");
+		return false;
+	}
+
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, Stringf("Hosting %d loopback bots", numBots));
+	return true;
+}
+
+
+bool App::Event_NetStats(EventArgs& args)
+{
+	UNUSED(args);
+
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, m_theGame->GetNetStatsReport());
+	return true;
+}
+
+
+bool App::Event_NetStop(EventArgs& args)
+{
+	UNUSED(args);
+
+	m_theGame->StopNetworking();
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, "Networking stopped");
+	return true;
+}
+
+
 //
 //private game flow functions
 //
@@ -233,6 +407,7 @@ void App::Render() const
 
 	//render dev console separately from and after rest of game
 	g_theRenderer->BeginCamera(m_devConsoleCamera);
+	RenderPerfCountersOverlay(m_theGame->m_menuFont);
 	g_theDevConsole->Render(AABB2(0.0f, 0.0f, SCREEN_CAMERA_SIZE_X * 0.9f, SCREEN_CAMERA_SIZE_Y * 0.9f));
 	g_theRenderer->EndCamera(m_devConsoleCamera);
 }
@@ -248,6 +423,9 @@ void App::EndFrame()
 	g_theAudio->EndFrame();
 
 	DebugRenderEndFrame();
+
+	Map const* currentMap = m_theGame->m_currentState == GameState::PLAYING ? m_theGame->m_currentMap : nullptr;
+	g_perfCounters.EndFrame(Clock::GetSystemClock().GetDeltaSeconds(), currentMap);
 }
 
 
@@ -22,6 +22,13 @@ public:
 
 	//static app utilites
 	static bool Event_Quit(EventArgs& args);
+	static bool Event_SaveSnapshot(EventArgs& args);
+	static bool Event_LoadSnapshot(EventArgs& args);
+	static bool Event_NetServer(EventArgs& args);
+	static bool Event_NetConnect(EventArgs& args);
+	static bool Event_NetLoopback(EventArgs& args);
+	static bool Event_NetStats(EventArgs& args);
+	static bool Event_NetStop(EventArgs& args);
 
 //private member variables
 private:
@@ -35,4 +42,6 @@ private:
 private:
 	bool m_isQuitting = false;
 	Camera m_devConsoleCamera;
+
+	std::vector<unsigned char> m_snapshotBuffer;	//last saved map snapshot, reused between saves
 };
@@ -19,7 +19,7 @@ Controller::Controller(Map* map)
 void Controller::Possess(ActorUID uidToPossess)
 {
 	//unpossess previous actor
-	if (m_actorUID.m_data != ActorUID::INVALID)
+	if (m_actorUID.IsValid())
 	{
 		Actor* previousActor = m_map->GetActorByUID(m_actorUID);
 		if (previousActor != nullptr)
@@ -29,7 +29,7 @@ void Controller::Possess(ActorUID uidToPossess)
 	}
 
 	//possess new actor
-	if (uidToPossess.m_data != ActorUID::INVALID)
+	if (uidToPossess.IsValid())
 	{
 		Actor* newActor = m_map->GetActorByUID(uidToPossess);
 		if (newActor != nullptr && newActor->m_definition->m_canBePossessed)
@@ -50,7 +50,7 @@ void Controller::Possess(ActorUID uidToPossess)
 //
 Actor* Controller::GetActor()
 {
-	if (m_actorUID.m_data == ActorUID::INVALID)
+	if (!m_actorUID.IsValid())
 	{
 		return nullptr;
 	}
@@ -0,0 +1,112 @@
+#include "Game/EffectDefinition.hpp"
+#include "Game/ActorDefinition.hpp"
+#include "Game/SpriteAnimGroupDef.hpp"
+
+
+//static variable declaration
+std::vector<EffectDefinition> EffectDefinition::s_effectDefinitions;
+
+
+//
+//constructor
+//
+EffectDefinition::EffectDefinition(XmlElement const& element)
+{
+	m_name = ParseXmlAttribute(element, "name", m_name);
+	m_capacity = ParseXmlAttribute(element, "capacity", m_capacity);
+
+	std::string sourceActorName = ParseXmlAttribute(element, "sourceActor", m_name);
+	m_sourceActorDefinition = ActorDefinition::GetActorDefinition(sourceActorName);
+	GUARANTEE_OR_DIE(m_sourceActorDefinition != nullptr, "Effect definition source actor does not exist!");
+	GUARANTEE_OR_DIE(m_capacity > 0, "Effect definition capacity must be positive!");
+
+	m_spriteSize = m_sourceActorDefinition->m_spriteSize;
+	m_spritePivot = m_sourceActorDefinition->m_spritePivot;
+	m_billboardType = m_sourceActorDefinition->m_billboardType;
+	m_renderRounded = m_sourceActorDefinition->m_renderRounded;
+	m_shader = m_sourceActorDefinition->m_shader;
+	m_spriteSheet = m_sourceActorDefinition->m_spriteSheet;
+
+	//use the same animation the actor would have played, which is its death animation for die on spawn actors
+	std::string animationName = ParseXmlAttribute(element, "animation", "Death");
+	SpriteAnimGroupDef const* animGroup = nullptr;
+	for (int groupIndex = 0; groupIndex < m_sourceActorDefinition->m_animGroupDefs.size(); groupIndex++)
+	{
+		if (m_sourceActorDefinition->m_animGroupDefs[groupIndex].m_name == animationName)
+		{
+			animGroup = &m_sourceActorDefinition->m_animGroupDefs[groupIndex];
+			break;
+		}
+	}
+	if (animGroup == nullptr && m_sourceActorDefinition->m_animGroupDefs.size() > 0)
+	{
+		animGroup = &m_sourceActorDefinition->m_animGroupDefs[0];
+	}
+	if (animGroup != nullptr && animGroup->m_spriteAnimDefs.size() > 0)
+	{
+		m_spriteAnimDef = &animGroup->m_spriteAnimDefs[0];
+	}
+
+	float defaultLifetime = m_sourceActorDefinition->m_corpseLifetime;
+	if (defaultLifetime <= 0.0f && animGroup != nullptr)
+	{
+		defaultLifetime = animGroup->m_secondsPerFrame * static_cast<float>(animGroup->m_numFrames);
+	}
+	m_lifetime = ParseXmlAttribute(element, "lifetime", defaultLifetime);
+}
+
+
+//
+//static functions
+//
+void EffectDefinition::InitializeEffectDefs()
+{
+	//effects are optional, anything not listed here still spawns as a regular actor
+	XmlDocument effectDefsXml;
+	char const* filePath = "Data/Definitions/EffectDefinitions.xml";
+	XmlError result = effectDefsXml.LoadFile(filePath);
+	if (result != tinyxml2::XML_SUCCESS)
+	{
+		return;
+	}
+
+	XmlElement* rootElement = effectDefsXml.RootElement();
+	GUARANTEE_OR_DIE(rootElement != nullptr, "Failed to read effect definitions root element!");
+
+	XmlElement* effectDefElement = rootElement->FirstChildElement();
+	while (effectDefElement != nullptr)
+	{
+		std::string elementName = effectDefElement->Name();
+		GUARANTEE_OR_DIE(elementName == "EffectDefinition", "Child element names in effect definitions xml file must be <EffectDefinition>!");
+		EffectDefinition newEffectDef = EffectDefinition(*effectDefElement);
+		s_effectDefinitions.push_back(newEffectDef);
+		effectDefElement = effectDefElement->NextSiblingElement();
+	}
+}
+
+
+EffectDefinition const* EffectDefinition::GetEffectDefinition(std::string const& name)
+{
+	int defIndex = GetEffectDefinitionIndex(name);
+	if (defIndex == -1)
+	{
+		return nullptr;
+	}
+
+	return &s_effectDefinitions[defIndex];
+}
+
+
+int EffectDefinition::GetEffectDefinitionIndex(std::string const& name)
+{
+	for (int defIndex = 0; defIndex < s_effectDefinitions.size(); defIndex++)
+	{
+		if (s_effectDefinitions[defIndex].m_name == name)
+		{
+			return defIndex;
+		}
+	}
+
+	//return -1 if it wasn't found
+	return -1;
+}
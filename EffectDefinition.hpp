@@ -0,0 +1,44 @@
+#pragma once
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/MathUtils.hpp"
+
+
+//forward declarations
+class ActorDefinition;
+class SpriteAnimDefinition;
+class SpriteSheet;
+class Shader;
+
+
+class EffectDefinition
+{
+//public member variables
+public:
+	static std::vector<EffectDefinition> s_effectDefinitions;
+
+	//base parameters
+	std::string m_name = "invalid effect";
+	int			m_capacity = 256;		//oldest effects get overwritten once this many are alive
+	float		m_lifetime = 0.0f;
+
+	//visuals parameters, borrowed from an actor definition so existing content can move over as is
+	ActorDefinition const*		m_sourceActorDefinition = nullptr;
+	SpriteAnimDefinition const* m_spriteAnimDef = nullptr;
+	Vec2						m_spriteSize = Vec2(1.0f, 1.0f);
+	Vec2						m_spritePivot = Vec2(0.5f, 0.5f);
+	BillboardType				m_billboardType = BillboardType::NONE;
+	bool						m_renderRounded = false;
+	Shader*						m_shader = nullptr;
+	SpriteSheet*				m_spriteSheet = nullptr;
+
+//public member functions
+public:
+	//constructor
+	explicit EffectDefinition(XmlElement const& element);
+
+	//static functions
+	static void InitializeEffectDefs();
+	static EffectDefinition const* GetEffectDefinition(std::string const& name);
+	static int GetEffectDefinitionIndex(std::string const& name);
+};
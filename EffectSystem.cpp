@@ -0,0 +1,183 @@
+#include "Game/EffectSystem.hpp"
+#include "Game/EffectDefinition.hpp"
+#include "Game/Map.hpp"
+#include "Game/Player.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/PerfCounters.hpp"
+#include "Engine/Renderer/Renderer.hpp"
+#include "Engine/Renderer/SpriteSheet.hpp"
+#include "Engine/Renderer/SpriteAnimDefinition.hpp"
+#include "Engine/Core/VertexUtils.hpp"
+
+
+//
+//constructor
+//
+EffectSystem::EffectSystem(Map const* map)
+	: m_map(map)
+{
+	for (int defIndex = 0; defIndex < EffectDefinition::s_effectDefinitions.size(); defIndex++)
+	{
+		EffectDefinition const& definition = EffectDefinition::s_effectDefinitions[defIndex];
+
+		EffectRing ring;
+		ring.m_definition = &definition;
+		ring.m_positions.resize(definition.m_capacity);
+		ring.m_ages.resize(definition.m_capacity, definition.m_lifetime);
+		m_rings.push_back(ring);
+	}
+}
+
+
+//
+//public game flow functions
+//
+void EffectSystem::Update(float deltaSeconds)
+{
+	for (int ringIndex = 0; ringIndex < m_rings.size(); ringIndex++)
+	{
+		EffectRing& ring = m_rings[ringIndex];
+		if (ring.m_numAlive == 0)
+		{
+			continue;
+		}
+
+		float lifetime = ring.m_definition->m_lifetime;
+		int numAlive = 0;
+		for (int effectIndex = 0; effectIndex < ring.m_ages.size(); effectIndex++)
+		{
+			if (ring.m_ages[effectIndex] < lifetime)
+			{
+				ring.m_ages[effectIndex] += deltaSeconds;
+				if (ring.m_ages[effectIndex] < lifetime)
+				{
+					numAlive++;
+				}
+			}
+		}
+
+		ring.m_numAlive = numAlive;
+	}
+}
+
+
+void EffectSystem::Render(int currentPlayerRendering)
+{
+	Mat44 cameraMatrix = m_map->m_players[currentPlayerRendering]->m_playerCamera.GetViewMatrix().GetOrthonormalInverse();
+
+	for (int ringIndex = 0; ringIndex < m_rings.size(); ringIndex++)
+	{
+		EffectRing const& ring = m_rings[ringIndex];
+		EffectDefinition const* definition = ring.m_definition;
+		if (ring.m_numAlive == 0 || definition->m_spriteAnimDef == nullptr || definition->m_spriteSheet == nullptr)
+		{
+			continue;
+		}
+
+		//same local quad as an actor sprite: sprite width along y, height along z, shifted by the pivot
+		Vec3 pivotOffset = Vec3(0.0f, definition->m_spritePivot.x * definition->m_spriteSize.x, definition->m_spritePivot.y * definition->m_spriteSize.y);
+		Vec3 localBottomLeft = Vec3() - pivotOffset;
+		Vec3 localBottomRight = localBottomLeft + Vec3(0.0f, definition->m_spriteSize.x, 0.0f);
+		Vec3 localTopLeft = localBottomLeft + Vec3(0.0f, 0.0f, definition->m_spriteSize.y);
+		Vec3 localTopRight = localBottomRight + Vec3(0.0f, 0.0f, definition->m_spriteSize.y);
+
+		m_effectVerts.clear();
+		for (int effectIndex = 0; effectIndex < ring.m_ages.size(); effectIndex++)
+		{
+			float age = ring.m_ages[effectIndex];
+			if (age >= definition->m_lifetime)
+			{
+				continue;
+			}
+
+			Vec3 const& position = ring.m_positions[effectIndex];
+			Mat44 billboardMatrix = GetBillboardMatrix(definition->m_billboardType, cameraMatrix, position);
+			billboardMatrix.SetTranslation3D(position);
+
+			Vec3 bottomLeft = billboardMatrix.TransformPosition3D(localBottomLeft);
+			Vec3 bottomRight = billboardMatrix.TransformPosition3D(localBottomRight);
+			Vec3 topLeft = billboardMatrix.TransformPosition3D(localTopLeft);
+			Vec3 topRight = billboardMatrix.TransformPosition3D(localTopRight);
+
+			AABB2 spriteUVs = definition->m_spriteAnimDef->GetSpriteDefAtTime(age).GetUVs();
+			if (definition->m_renderRounded)
+			{
+				AddVertsForRoundedQuad3D(m_effectVerts, bottomLeft, bottomRight, topLeft, topRight, Rgba8(), spriteUVs);
+			}
+			else
+			{
+				AddVertsForQuad3D(m_effectVerts, bottomLeft, bottomRight, topLeft, topRight, Rgba8(), spriteUVs);
+			}
+		}
+
+		g_theRenderer->BindShader(definition->m_shader);
+		g_theRenderer->BindTexture(&definition->m_spriteSheet->GetTexture());
+		g_theRenderer->SetModelConstants();
+		g_theRenderer->SetRasterizerMode(RasterizerMode::SOLID_CULL_BACK);
+		g_theRenderer->DrawVertexArray(static_cast<int>(m_effectVerts.size()), m_effectVerts.data());
+		IncrementPerfCounter(PerfCounter::MAP_DRAW_CALLS);
+		IncrementPerfCounter(PerfCounter::MAP_BYTES_UPLOADED, static_cast<int>(m_effectVerts.size() * sizeof(Vertex_PNCU)));
+	}
+}
+
+
+//
+//public effect utilities
+//
+bool EffectSystem::SpawnEffect(std::string const& effectDefName, Vec3 const& position)
+{
+	return SpawnEffect(EffectDefinition::GetEffectDefinitionIndex(effectDefName), position);
+}
+
+
+bool EffectSystem::SpawnEffect(int effectDefIndex, Vec3 const& position)
+{
+	if (effectDefIndex == -1 || effectDefIndex >= m_rings.size())
+	{
+		return false;
+	}
+
+	//a full ring just overwrites its oldest effect
+	EffectRing& ring = m_rings[effectDefIndex];
+	if (ring.m_ages[ring.m_nextIndex] >= ring.m_definition->m_lifetime)
+	{
+		ring.m_numAlive++;
+	}
+
+	ring.m_positions[ring.m_nextIndex] = position;
+	ring.m_ages[ring.m_nextIndex] = 0.0f;
+	ring.m_nextIndex = (ring.m_nextIndex + 1) % static_cast<int>(ring.m_ages.size());
+
+	return true;
+}
+
+
+void EffectSystem::ClearEffects()
+{
+	for (int ringIndex = 0; ringIndex < m_rings.size(); ringIndex++)
+	{
+		EffectRing& ring = m_rings[ringIndex];
+		for (int effectIndex = 0; effectIndex < ring.m_ages.size(); effectIndex++)
+		{
+			ring.m_ages[effectIndex] = ring.m_definition->m_lifetime;
+		}
+
+		ring.m_nextIndex = 0;
+		ring.m_numAlive = 0;
+	}
+}
+
+
+//
+//public accessors
+//
+int EffectSystem::GetNumAliveEffects() const
+{
+	int numAlive = 0;
+	for (int ringIndex = 0; ringIndex < m_rings.size(); ringIndex++)
+	{
+		numAlive += m_rings[ringIndex].m_numAlive;
+	}
+
+	return numAlive;
+}
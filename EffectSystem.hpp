@@ -0,0 +1,48 @@
+#pragma once
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Vertex_PNCU.hpp"
+#include "Engine/Math/Vec3.hpp"
+
+
+//forward declarations
+class Map;
+class EffectDefinition;
+
+
+//one fixed-size ring per effect definition, stored as parallel arrays so updates only touch ages
+struct EffectRing
+{
+	EffectDefinition const* m_definition = nullptr;
+	std::vector<Vec3>		m_positions;
+	std::vector<float>		m_ages;				//an effect is alive while its age is below the definition lifetime
+	int						m_nextIndex = 0;
+	int						m_numAlive = 0;
+};
+
+
+class EffectSystem
+{
+//public member functions
+public:
+	//constructor
+	explicit EffectSystem(Map const* map);
+
+	//game flow functions
+	void Update(float deltaSeconds);
+	void Render(int currentPlayerRendering);
+
+	//effect utilities
+	bool SpawnEffect(std::string const& effectDefName, Vec3 const& position);
+	bool SpawnEffect(int effectDefIndex, Vec3 const& position);
+	void ClearEffects();
+
+	//accessors
+	int GetNumAliveEffects() const;
+
+//public member variables
+public:
+	Map const* m_map = nullptr;
+
+	std::vector<EffectRing>  m_rings;		//indexes match EffectDefinition::s_effectDefinitions
+	std::vector<Vertex_PNCU> m_effectVerts;	//reused every draw
+};
@@ -0,0 +1,148 @@
+#include "Game/FlowField.hpp"
+#include "Game/Map.hpp"
+#include <queue>
+
+
+//neighbor offsets, orthogonal first so ties prefer straight steps
+static const int k_numNeighbors = 8;
+static const int k_neighborOffsetsX[k_numNeighbors] = { 1, -1, 0, 0, 1, -1, 1, -1 };
+static const int k_neighborOffsetsY[k_numNeighbors] = { 0, 0, 1, -1, 1, 1, -1, -1 };
+static const float k_neighborCosts[k_numNeighbors] = { 1.0f, 1.0f, 1.0f, 1.0f, 1.41421356f, 1.41421356f, 1.41421356f, 1.41421356f };
+
+
+//
+//constructor
+//
+FlowField::FlowField(Map const* map)
+	: m_map(map)
+{
+}
+
+
+//
+//public flow field utilities
+//
+void FlowField::SetGoalCoords(IntVec2 const& goalCoords)
+{
+	//only redo the search when the goal actually moves to a different tile
+	if (goalCoords == m_goalCoords)
+	{
+		return;
+	}
+
+	m_goalCoords = goalCoords;
+	Rebuild();
+}
+
+
+void FlowField::Rebuild()
+{
+	int numTiles = m_map->m_dimensions.x * m_map->m_dimensions.y;
+
+	m_costsToGoal.assign(numTiles, FLT_MAX);
+	m_nextTileIDs.assign(numTiles, -1);
+
+	if (!m_map->AreCoordsInBounds(m_goalCoords.x, m_goalCoords.y) || m_map->IsTileSolid(m_goalCoords.x, m_goalCoords.y))
+	{
+		return;
+	}
+
+	m_numRebuilds++;
+
+	//dijkstra outward from the goal tile
+	typedef std::pair<float, int> OpenEntry;
+	std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>> openList;
+
+	int goalTileID = m_map->GetTileIDFromCoords(m_goalCoords.x, m_goalCoords.y);
+	m_costsToGoal[goalTileID] = 0.0f;
+	openList.push(OpenEntry(0.0f, goalTileID));
+
+	while (!openList.empty())
+	{
+		OpenEntry current = openList.top();
+		openList.pop();
+
+		int currentTileID = current.second;
+		if (current.first > m_costsToGoal[currentTileID])
+		{
+			continue;
+		}
+
+		int currentX = currentTileID % m_map->m_dimensions.x;
+		int currentY = currentTileID / m_map->m_dimensions.x;
+
+		for (int neighborIndex = 0; neighborIndex < k_numNeighbors; neighborIndex++)
+		{
+			int offsetX = k_neighborOffsetsX[neighborIndex];
+			int offsetY = k_neighborOffsetsY[neighborIndex];
+			int neighborX = currentX + offsetX;
+			int neighborY = currentY + offsetY;
+
+			if (m_map->IsTileSolid(neighborX, neighborY))
+			{
+				continue;
+			}
+
+			//don't cut corners around walls on diagonal steps
+			if (offsetX != 0 && offsetY != 0 && (m_map->IsTileSolid(currentX + offsetX, currentY) || m_map->IsTileSolid(currentX, currentY + offsetY)))
+			{
+				continue;
+			}
+
+			int neighborTileID = m_map->GetTileIDFromCoords(neighborX, neighborY);
+			float neighborCost = current.first + k_neighborCosts[neighborIndex];
+			if (neighborCost < m_costsToGoal[neighborTileID])
+			{
+				m_costsToGoal[neighborTileID] = neighborCost;
+				m_nextTileIDs[neighborTileID] = currentTileID;
+				openList.push(OpenEntry(neighborCost, neighborTileID));
+			}
+		}
+	}
+}
+
+
+//
+//public accessors
+//
+bool FlowField::HasGoal() const
+{
+	return m_goalCoords != IntVec2(-1, -1);
+}
+
+
+float FlowField::GetCostToGoalAtPosition(Vec3 const& position) const
+{
+	int tileX = static_cast<int>(position.x);
+	int tileY = static_cast<int>(position.y);
+	if (!m_map->AreCoordsInBounds(tileX, tileY) || m_costsToGoal.empty())
+	{
+		return FLT_MAX;
+	}
+
+	return m_costsToGoal[m_map->GetTileIDFromCoords(tileX, tileY)];
+}
+
+
+Vec3 FlowField::GetFlowDirectionAtPosition(Vec3 const& position) const
+{
+	int tileX = static_cast<int>(position.x);
+	int tileY = static_cast<int>(position.y);
+	if (!m_map->AreCoordsInBounds(tileX, tileY) || m_nextTileIDs.empty())
+	{
+		return Vec3();
+	}
+
+	int nextTileID = m_nextTileIDs[m_map->GetTileIDFromCoords(tileX, tileY)];
+	if (nextTileID == -1)
+	{
+		return Vec3();
+	}
+
+	//steer toward the center of the next tile rather than along a fixed per-tile arrow so actors don't graze corners
+	float nextTileCenterX = static_cast<float>(nextTileID % m_map->m_dimensions.x) + 0.5f;
+	float nextTileCenterY = static_cast<float>(nextTileID / m_map->m_dimensions.x) + 0.5f;
+	Vec3 flowDirection = Vec3(nextTileCenterX - position.x, nextTileCenterY - position.y, 0.0f);
+
+	return flowDirection.GetNormalized();
+}
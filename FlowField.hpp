@@ -0,0 +1,36 @@
+#pragma once
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Math/Vec3.hpp"
+
+
+//forward declarations
+class Map;
+
+
+class FlowField
+{
+//public member functions
+public:
+	//constructor
+	explicit FlowField(Map const* map);
+
+	//flow field utilities
+	void SetGoalCoords(IntVec2 const& goalCoords);
+	void Rebuild();
+
+	//accessors
+	bool  HasGoal() const;
+	float GetCostToGoalAtPosition(Vec3 const& position) const;
+	Vec3  GetFlowDirectionAtPosition(Vec3 const& position) const;
+
+//public member variables
+public:
+	Map const* m_map = nullptr;
+	IntVec2	   m_goalCoords = IntVec2(-1, -1);
+
+	std::vector<float> m_costsToGoal;		//FLT_MAX for solid or unreachable tiles
+	std::vector<int>   m_nextTileIDs;		//neighbor to step into from each tile, -1 if none
+
+	int m_numRebuilds = 0;
+};
@@ -5,7 +5,13 @@
 #include "Game/MapDefinition.hpp"
 #include "Game/ActorDefinition.hpp"
 #include "Game/WeaponDefinition.hpp"
+#include "Game/EffectDefinition.hpp"
 #include "Game/Map.hpp"
+#include "Game/Profiler.hpp"
+#include "Game/PerfCounters.hpp"
+#include "Game/NetServer.hpp"
+#include "Game/NetClient.hpp"
+#include "Game/NetTransport.hpp"
 #include "Engine/Math/RandomNumberGenerator.hpp"
 #include "Engine/Math/AABB2.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
@@ -22,6 +28,27 @@
 #include "Engine/Renderer/SpriteAnimDefinition.hpp"
 #include "Engine/Core/FileUtils.hpp"
 #include "Engine/Renderer/DebugRenderSystem.hpp"
+#include "Engine/Core/DevConsole.hpp"
+
+
+//lobby devices are the keyboard (-1) plus this many controllers
+static const int k_numXboxControllers = 4;
+
+
+//
+//static helper functions
+//
+static FrameInput GetLoopbackBotInput(int botIndex, float deltaSeconds)
+{
+	//bots run in circles of different sizes and every other one keeps firing, which keeps snapshots busy
+	FrameInput botInput;
+	botInput.m_deltaSeconds = deltaSeconds;
+	botInput.SetButton(InputButton::KEYBOARD_FORWARD, true, false);
+	botInput.SetButton(InputButton::KEYBOARD_SPEED_UP, botIndex % 3 == 0, false);
+	botInput.SetButton(InputButton::KEYBOARD_ATTACK, botIndex % 2 == 1, false);
+	botInput.m_cursorDelta = IntVec2(2 + botIndex % 5, 0);
+	return botInput;
+}
 
 
 //game flow functions
@@ -42,6 +69,56 @@ void Game::Startup()
 
 void Game::Update()
 {
+	PROFILE_SCOPE("Game::Update");
+
+	//recording and replaying both need a fresh map to start from
+	if (g_inputRecording.m_isMapRestartRequested)
+	{
+		g_inputRecording.m_isMapRestartRequested = false;
+		if (m_currentState == GameState::PLAYING)
+		{
+			g_theAudio->StopSound(m_gameMusicPlayback);
+			EnterState(GameState::PLAYING);
+		}
+		else if (g_inputRecording.m_state == InputRecordingState::REPLAY_LOADED)
+		{
+			m_desiredState = GameState::PLAYING;
+		}
+	}
+
+	//clients start playing once the server welcomes them and leave when it goes away
+	if (m_netClient != nullptr)
+	{
+		if (m_currentState != GameState::PLAYING)
+		{
+			m_netClient->Update(FrameInput());
+		}
+
+		if (m_netClient->m_state == NetClientState::DISCONNECTED)
+		{
+			g_theDevConsole->AddLine(DevConsole::COLOR_WARNING, "Disconnected from server");
+			StopNetworking();
+			m_desiredState = GameState::ATTRACT;
+		}
+		else if (m_netClient->IsConnected() && m_netClient->m_map == nullptr)
+		{
+			m_isLightsOutMode = m_netClient->m_isLightsOutMode;
+			if (m_currentState == GameState::PLAYING)
+			{
+				g_theAudio->StopSound(m_gameMusicPlayback);
+				EnterState(GameState::PLAYING);
+			}
+			else
+			{
+				m_desiredState = GameState::PLAYING;
+			}
+		}
+	}
+	else if (m_currentState == GameState::PLAYING && m_currentMap->m_isNetClient)
+	{
+		m_desiredState = GameState::ATTRACT;
+	}
+
 	if (m_desiredState != m_currentState)
 	{
 		EnterState(m_desiredState);
@@ -59,6 +136,8 @@ void Game::Update()
 
 void Game::Render() const
 {
+	PROFILE_SCOPE("Game::Render");
+
 	switch (m_currentState)
 	{
 		case GameState::ATTRACT:	 RenderAttract();	 break;
@@ -71,13 +150,17 @@ void Game::Render() const
 
 void Game::Shutdown()
 {
+	StopNetworking();
+
 	//delete all allocated pointers here
 	if (m_currentMap != nullptr)
 	{
+		g_inputRecording.EndSession();
 		m_currentMap->Shutdown();
 
 		delete m_currentMap;
 		m_currentMap = nullptr;
+		g_perfCounters.m_currentMap = nullptr;
 	}
 
 	//stop any currently playing game music
@@ -86,6 +169,113 @@ void Game::Shutdown()
 }
 
 
+//
+//networking functions
+//
+bool Game::StartNetServer(unsigned short port, bool isHeadless)
+{
+	if (m_currentState != GameState::PLAYING || m_netClient != nullptr)
+	{
+		return false;
+	}
+
+	StopNetworking();
+
+	UdpTransport* transport = new UdpTransport();
+	if (!transport->Bind(port))
+	{
+		delete transport;
+		return false;
+	}
+
+	m_netServer = new NetServer(m_currentMap, transport, isHeadless);
+	return true;
+}
+
+
+bool Game::StartNetLoopbackTest(int numBots)
+{
+	if (m_currentState != GameState::PLAYING || m_netClient != nullptr || numBots <= 0)
+	{
+		return false;
+	}
+
+	StopNetworking();
+
+	//endpoint 0 is the server, every bot talks to it as connection 0
+	m_loopbackNetwork = new LoopbackNetwork(numBots + 1);
+	m_netServer = new NetServer(m_currentMap, new LoopbackTransport(m_loopbackNetwork, 0), false);
+	for (int botIndex = 0; botIndex < numBots; botIndex++)
+	{
+		m_loopbackBots.push_back(new NetClient(new LoopbackTransport(m_loopbackNetwork, botIndex + 1), 0, -1));
+	}
+
+	return true;
+}
+
+
+bool Game::ConnectToNetServer(std::string const& hostAddress, unsigned short port, int xboxID)
+{
+	StopNetworking();
+
+	UdpTransport* transport = new UdpTransport();
+	int serverConnectionID = transport->Connect(hostAddress, port);
+	if (serverConnectionID == NET_INVALID_CONNECTION)
+	{
+		delete transport;
+		return false;
+	}
+
+	m_netClient = new NetClient(transport, serverConnectionID, xboxID);
+	return true;
+}
+
+
+void Game::StopNetworking()
+{
+	if (m_netServer != nullptr)
+	{
+		delete m_netServer;
+		m_netServer = nullptr;
+	}
+
+	for (int botIndex = 0; botIndex < m_loopbackBots.size(); botIndex++)
+	{
+		delete m_loopbackBots[botIndex];
+	}
+	m_loopbackBots.clear();
+
+	if (m_loopbackNetwork != nullptr)
+	{
+		delete m_loopbackNetwork;
+		m_loopbackNetwork = nullptr;
+	}
+
+	if (m_netClient != nullptr)
+	{
+		delete m_netClient;
+		m_netClient = nullptr;
+	}
+}
+
+
+std::string Game::GetNetStatsReport()
+{
+	if (m_netServer != nullptr)
+	{
+		return m_netServer->GetStatsReport();
+	}
+
+	if (m_netClient != nullptr)
+	{
+		return Stringf("Client: player %d, snapshot tick %u, %lld bytes down, %lld bytes up\n", m_netClient->m_playerIndex, m_netClient->m_newestTick,
+			m_netClient->m_transport->m_totalBytesReceived, m_netClient->m_transport->m_totalBytesSent);
+	}
+
+	return "Networking is not running\n";
+}
+
+
 //
 //game flow sub-functions
 //
@@ -102,7 +292,6 @@ void Game::UpdateAttract()
 	{
 		g_theAudio->StartSound(m_buttonClickSound);
 		m_desiredState = GameState::MODE_SELECT;
-		m_keyboardPlayer = 0;
 	}
 }
 
@@ -144,36 +333,16 @@ void Game::UpdateModeSelect()
 		m_desiredState = GameState::ATTRACT;
 	}
 
-	if (m_isLightsOutMode)
+	//whichever device picks the mode joins as player 1, lights out skips the lobby since it is single player
+	GameState nextState = m_isLightsOutMode ? GameState::PLAYING : GameState::LOBBY;
+	for (int xboxID = -1; xboxID < k_numXboxControllers; xboxID++)
 	{
-		if (g_theInput->WasKeyJustPressed(' '))
+		bool wasJoinPressed = xboxID == -1 ? g_theInput->WasKeyJustPressed(' ') : g_theInput->GetController(xboxID).WasButtonJustPressed(XBOX_BUTTON_START);
+		if (wasJoinPressed && m_desiredState == GameState::MODE_SELECT)
 		{
 			g_theAudio->StartSound(m_buttonClickSound);
-			m_desiredState = GameState::PLAYING;
-			m_keyboardPlayer = 0;
-		}
-
-		if (controller.WasButtonJustPressed(XBOX_BUTTON_START))
-		{
-			g_theAudio->StartSound(m_buttonClickSound);
-			m_desiredState = GameState::PLAYING;
-			m_controllerPlayer = 0;
-		}
-	}
-	else
-	{
-		if (g_theInput->WasKeyJustPressed(' '))
-		{
-			g_theAudio->StartSound(m_buttonClickSound);
-			m_desiredState = GameState::LOBBY;
-			m_keyboardPlayer = 0;
-		}
-
-		if (controller.WasButtonJustPressed(XBOX_BUTTON_START))
-		{
-			g_theAudio->StartSound(m_buttonClickSound);
-			m_desiredState = GameState::LOBBY;
-			m_controllerPlayer = 0;
+			JoinPlayer(xboxID);
+			m_desiredState = nextState;
 		}
 	}
 }
@@ -198,7 +367,7 @@ void Game::RenderModeSelect() const
 		m_menuFont->AddVertsForTextInBox2D(textVerts, AABB2(SCREEN_CAMERA_CENTER_X - 1.0f, SCREEN_CAMERA_CENTER_Y - 1.0f, SCREEN_CAMERA_CENTER_X + 1.0f, SCREEN_CAMERA_CENTER_Y + 1.0f),
 			80.0f, "Mode: Standard", Rgba8(), 1.0f, Vec2(0.5f, 0.5f), TextBoxMode::OVERRUN);
 		m_menuFont->AddVertsForTextInBox2D(textVerts, AABB2(SCREEN_CAMERA_CENTER_X - 1.0f, SCREEN_CAMERA_CENTER_Y - 101.0f, SCREEN_CAMERA_CENTER_X + 1.0f, SCREEN_CAMERA_CENTER_Y - 100.0f),
-			60.0f, "1-2 players", Rgba8(), 1.0f, Vec2(0.5f, 0.5f), TextBoxMode::OVERRUN);
+			60.0f, Stringf("1-%d players", g_gameConfigBlackboard.GetValue("maxLocalPlayers", 4)), Rgba8(), 1.0f, Vec2(0.5f, 0.5f), TextBoxMode::OVERRUN);
 	}
 	
 	m_menuFont->AddVertsForTextInBox2D(textVerts, AABB2(SCREEN_CAMERA_CENTER_X - 1.0f, 0.0f, SCREEN_CAMERA_CENTER_X + 1.0f, 1.0f), 25.0f,
@@ -216,85 +385,51 @@ void Game::RenderModeSelect() const
 
 void Game::UpdateLobby()
 {
-	XboxController const& controller = g_theInput->GetController(0);
-
-	if (g_theInput->WasKeyJustPressed(KEYCODE_ESC))
+	//every device can join, leave, or start the game once it has joined
+	for (int xboxID = -1; xboxID < k_numXboxControllers; xboxID++)
 	{
-		g_theAudio->StartSound(m_buttonClickSound);
-		
-		if (m_keyboardPlayer != -1 && m_controllerPlayer != -1)
+		bool wasJoinPressed = false;
+		bool wasLeavePressed = false;
+		if (xboxID == -1)
 		{
-			m_keyboardPlayer = -1;
+			wasJoinPressed = g_theInput->WasKeyJustPressed(' ');
+			wasLeavePressed = g_theInput->WasKeyJustPressed(KEYCODE_ESC);
 		}
 		else
 		{
-			m_desiredState = GameState::ATTRACT;
+			XboxController const& controller = g_theInput->GetController(xboxID);
+			wasJoinPressed = controller.WasButtonJustPressed(XBOX_BUTTON_START);
+			wasLeavePressed = controller.WasButtonJustPressed(XBOX_BUTTON_SELECT);
 		}
-	}
-
-	if (controller.WasButtonJustPressed(XBOX_BUTTON_SELECT))
-	{
-		g_theAudio->StartSound(m_buttonClickSound);
 
-		if (m_controllerPlayer != -1 && m_keyboardPlayer != -1)
-		{
-			m_controllerPlayer = -1;
-		}
-		else
+		int playerIndex = GetJoinedPlayerIndex(xboxID);
+		if (wasLeavePressed)
 		{
-			m_desiredState = GameState::ATTRACT;
-		}
-	}
-
-	if (g_theInput->WasKeyJustPressed(' '))
-	{
-		g_theAudio->StartSound(m_buttonClickSound);
+			g_theAudio->StartSound(m_buttonClickSound);
 
-		if (m_keyboardPlayer == -1)
-		{
-			if (m_controllerPlayer == 0)
+			if (playerIndex != -1 && m_joinedXboxIDs.size() > 1)
 			{
-				m_keyboardPlayer = 1;
+				m_joinedXboxIDs.erase(m_joinedXboxIDs.begin() + playerIndex);
 			}
 			else
 			{
-				m_keyboardPlayer = 0;
+				m_desiredState = GameState::ATTRACT;
 			}
 		}
-		else
-		{
-			m_desiredState = GameState::PLAYING;
-		}
-	}
 
-	if (controller.WasButtonJustPressed(XBOX_BUTTON_START))
-	{
-		g_theAudio->StartSound(m_buttonClickSound);
-		
-		if (m_controllerPlayer == -1)
+		if (wasJoinPressed)
 		{
-			if (m_keyboardPlayer == 0)
+			g_theAudio->StartSound(m_buttonClickSound);
+
+			if (playerIndex == -1)
 			{
-				m_controllerPlayer = 1;
+				JoinPlayer(xboxID);
 			}
 			else
 			{
-				m_controllerPlayer = 0;
+				m_desiredState = GameState::PLAYING;
 			}
 		}
-		else
-		{
-			m_desiredState = GameState::PLAYING;
-		}
-	}
-
-	if (m_keyboardPlayer == -1 && m_controllerPlayer == 1)
-	{
-		m_controllerPlayer = 0;
-	}
-	else if (m_keyboardPlayer == 1 && m_controllerPlayer == -1)
-	{
-		m_keyboardPlayer = 0;
 	}
 }
 
@@ -312,47 +447,29 @@ void Game::RenderLobby() const
 	
 	std::vector<Vertex_PCU> textVerts;
 
-	if (m_keyboardPlayer == 0)
+	//each joined player gets a band of the screen, top to bottom in join order, text shrinking once more than two share it
+	int numPlayers = static_cast<int>(m_joinedXboxIDs.size());
+	float bandHeight = SCREEN_CAMERA_SIZE_Y / static_cast<float>(numPlayers > 0 ? numPlayers : 1);
+	float textScale = numPlayers > 2 ? 2.0f / static_cast<float>(numPlayers) : 1.0f;
+	for (int playerIndex = 0; playerIndex < numPlayers; playerIndex++)
 	{
-		if (m_controllerPlayer == -1)
-		{
-			m_menuFont->AddVertsForTextInBox2D(textVerts, AABB2(SCREEN_CAMERA_CENTER_X - 1.0f, SCREEN_CAMERA_CENTER_Y - 1.0f, SCREEN_CAMERA_CENTER_X + 1.0f, SCREEN_CAMERA_CENTER_Y + 1.0f),
-				45.0f, "Player 1\nMouse And Keyboard\n", Rgba8(), 0.8f, Vec2(0.5f, 0.5f), TextBoxMode::OVERRUN);
-			m_menuFont->AddVertsForTextInBox2D(textVerts, AABB2(SCREEN_CAMERA_CENTER_X - 1.0f, SCREEN_CAMERA_CENTER_Y * 0.85f - 1.0f, SCREEN_CAMERA_CENTER_X + 1.0f, SCREEN_CAMERA_CENTER_Y * 0.85f + 1.0f),
-				20.0f, "SPACE to start game\nSTART to join player\nESC to leave game", Rgba8(), 0.8f, Vec2(0.5f, 0.5f), TextBoxMode::OVERRUN);
-		}
-		else
-		{
-			m_menuFont->AddVertsForTextInBox2D(textVerts, AABB2(SCREEN_CAMERA_CENTER_X - 1.0f, SCREEN_CAMERA_CENTER_Y * 1.5f - 1.0f, SCREEN_CAMERA_CENTER_X + 1.0f, SCREEN_CAMERA_CENTER_Y * 1.5f + 1.0f),
-				45.0f, "Player 1\nMouse And Keyboard\n", Rgba8(), 0.8f, Vec2(0.5f, 0.5f), TextBoxMode::OVERRUN);
-			m_menuFont->AddVertsForTextInBox2D(textVerts, AABB2(SCREEN_CAMERA_CENTER_X - 1.0f, SCREEN_CAMERA_CENTER_Y * 1.35f - 1.0f, SCREEN_CAMERA_CENTER_X + 1.0f, SCREEN_CAMERA_CENTER_Y * 1.35f + 1.0f),
-				20.0f, "SPACE to start game\nESC to leave game", Rgba8(), 0.8f, Vec2(0.5f, 0.5f), TextBoxMode::OVERRUN);
-			m_menuFont->AddVertsForTextInBox2D(textVerts, AABB2(SCREEN_CAMERA_CENTER_X - 1.0f, SCREEN_CAMERA_CENTER_Y * 0.5f - 1.0f, SCREEN_CAMERA_CENTER_X + 1.0f, SCREEN_CAMERA_CENTER_Y * 0.5f + 1.0f),
-				45.0f, "Player 2\nController\n", Rgba8(), 0.8f, Vec2(0.5f, 0.5f), TextBoxMode::OVERRUN);
-			m_menuFont->AddVertsForTextInBox2D(textVerts, AABB2(SCREEN_CAMERA_CENTER_X - 1.0f, SCREEN_CAMERA_CENTER_Y * 0.35f - 1.0f, SCREEN_CAMERA_CENTER_X + 1.0f, SCREEN_CAMERA_CENTER_Y * 0.35f + 1.0f),
-				20.0f, "START to start game\nBACK to leave game", Rgba8(), 0.8f, Vec2(0.5f, 0.5f), TextBoxMode::OVERRUN);
-		}
+		bool isKeyboard = m_joinedXboxIDs[playerIndex] == -1;
+		std::string playerText = Stringf("Player %d\n%s\n", playerIndex + 1, isKeyboard ? "Mouse And Keyboard" : Stringf("Controller %d", m_joinedXboxIDs[playerIndex] + 1).c_str());
+		char const* instructionText = isKeyboard ? "SPACE to start game\nESC to leave game" : "START to start game\nBACK to leave game";
+
+		float bandCenterY = SCREEN_CAMERA_SIZE_Y - (static_cast<float>(playerIndex) + 0.5f) * bandHeight;
+		float instructionY = bandCenterY - 60.0f * textScale;
+		m_menuFont->AddVertsForTextInBox2D(textVerts, AABB2(SCREEN_CAMERA_CENTER_X - 1.0f, bandCenterY - 1.0f, SCREEN_CAMERA_CENTER_X + 1.0f, bandCenterY + 1.0f),
+			45.0f * textScale, playerText, Rgba8(), 0.8f, Vec2(0.5f, 0.5f), TextBoxMode::OVERRUN);
+		m_menuFont->AddVertsForTextInBox2D(textVerts, AABB2(SCREEN_CAMERA_CENTER_X - 1.0f, instructionY - 1.0f, SCREEN_CAMERA_CENTER_X + 1.0f, instructionY + 1.0f),
+			20.0f * textScale, instructionText, Rgba8(), 0.8f, Vec2(0.5f, 0.5f), TextBoxMode::OVERRUN);
 	}
-	else if (m_controllerPlayer == 0)
+
+	int maxPlayers = g_gameConfigBlackboard.GetValue("maxLocalPlayers", 4);
+	if (numPlayers < maxPlayers)
 	{
-		if (m_keyboardPlayer == -1)
-		{
-			m_menuFont->AddVertsForTextInBox2D(textVerts, AABB2(SCREEN_CAMERA_CENTER_X - 1.0f, SCREEN_CAMERA_CENTER_Y - 1.0f, SCREEN_CAMERA_CENTER_X + 1.0f, SCREEN_CAMERA_CENTER_Y + 1.0f),
-				45.0f, "Player 1\nController\n", Rgba8(), 0.8f, Vec2(0.5f, 0.5f), TextBoxMode::OVERRUN);
-			m_menuFont->AddVertsForTextInBox2D(textVerts, AABB2(SCREEN_CAMERA_CENTER_X - 1.0f, SCREEN_CAMERA_CENTER_Y * 0.85f - 1.0f, SCREEN_CAMERA_CENTER_X + 1.0f, SCREEN_CAMERA_CENTER_Y * 0.85f + 1.0f),
-				20.0f, "START to start game\nSPACE to join player\nBACK to leave game", Rgba8(), 0.8f, Vec2(0.5f, 0.5f), TextBoxMode::OVERRUN);
-		}
-		else
-		{
-			m_menuFont->AddVertsForTextInBox2D(textVerts, AABB2(SCREEN_CAMERA_CENTER_X - 1.0f, SCREEN_CAMERA_CENTER_Y * 1.5f - 1.0f, SCREEN_CAMERA_CENTER_X + 1.0f, SCREEN_CAMERA_CENTER_Y * 1.5f + 1.0f),
-				45.0f, "Player 1\nController\n", Rgba8(), 0.8f, Vec2(0.5f, 0.5f), TextBoxMode::OVERRUN);
-			m_menuFont->AddVertsForTextInBox2D(textVerts, AABB2(SCREEN_CAMERA_CENTER_X - 1.0f, SCREEN_CAMERA_CENTER_Y * 1.35f - 1.0f, SCREEN_CAMERA_CENTER_X + 1.0f, SCREEN_CAMERA_CENTER_Y * 1.35f + 1.0f),
-				20.0f, "START to start game\nBACK to leave game", Rgba8(), 0.8f, Vec2(0.5f, 0.5f), TextBoxMode::OVERRUN);
-			m_menuFont->AddVertsForTextInBox2D(textVerts, AABB2(SCREEN_CAMERA_CENTER_X - 1.0f, SCREEN_CAMERA_CENTER_Y * 0.5f - 1.0f, SCREEN_CAMERA_CENTER_X + 1.0f, SCREEN_CAMERA_CENTER_Y * 0.5f + 1.0f),
-				45.0f, "Player 2\nKeyboard\n", Rgba8(), 0.8f, Vec2(0.5f, 0.5f), TextBoxMode::OVERRUN);
-			m_menuFont->AddVertsForTextInBox2D(textVerts, AABB2(SCREEN_CAMERA_CENTER_X - 1.0f, SCREEN_CAMERA_CENTER_Y * 0.35f - 1.0f, SCREEN_CAMERA_CENTER_X + 1.0f, SCREEN_CAMERA_CENTER_Y * 0.35f + 1.0f),
-				20.0f, "SPACE to start game\nESC to leave game", Rgba8(), 0.8f, Vec2(0.5f, 0.5f), TextBoxMode::OVERRUN);
-		}
+		m_menuFont->AddVertsForTextInBox2D(textVerts, AABB2(SCREEN_CAMERA_CENTER_X - 1.0f, 0.0f, SCREEN_CAMERA_CENTER_X + 1.0f, 1.0f), 15.0f,
+			Stringf("SPACE or START on another device to join (%d/%d)", numPlayers, maxPlayers), Rgba8(), 0.8f, Vec2(0.5f, 0.0f), TextBoxMode::OVERRUN);
 	}
 
 	g_theRenderer->BindShader(nullptr);
@@ -363,6 +480,32 @@ void Game::RenderLobby() const
 }
 
 
+bool Game::JoinPlayer(int xboxID)
+{
+	if (GetJoinedPlayerIndex(xboxID) != -1 || m_joinedXboxIDs.size() >= g_gameConfigBlackboard.GetValue("maxLocalPlayers", 4))
+	{
+		return false;
+	}
+
+	m_joinedXboxIDs.push_back(xboxID);
+	return true;
+}
+
+
+int Game::GetJoinedPlayerIndex(int xboxID) const
+{
+	for (int playerIndex = 0; playerIndex < m_joinedXboxIDs.size(); playerIndex++)
+	{
+		if (m_joinedXboxIDs[playerIndex] == xboxID)
+		{
+			return playerIndex;
+		}
+	}
+
+	return -1;
+}
+
+
 void Game::UpdateGameplay()
 {
 	XboxController const& controller = g_theInput->GetController(0);
@@ -389,10 +532,76 @@ void Game::UpdateGameplay()
 		m_gameClock.StepSingleFrame();
 	}
 
-	//update player
+	//input and looking run every frame, the simulation runs in fixed steps to catch up to the game clock
 	float deltaSeconds = m_gameClock.GetDeltaSeconds();
+	if (g_inputRecording.IsReplaying())
+	{
+		//replays also play back the recorded frame times so the same ticks run on the same frames
+		if (!g_inputRecording.ReadNextFrame(m_playerFrameInputs))
+		{
+			m_desiredState = GameState::ATTRACT;
+			return;
+		}
+		deltaSeconds = m_playerFrameInputs[0].m_deltaSeconds;
+	}
+	else
+	{
+		for (int playerIndex = 0; playerIndex < m_playerFrameInputs.size(); playerIndex++)
+		{
+			m_playerFrameInputs[playerIndex] = CaptureFrameInput(deltaSeconds, m_currentMap->m_players[playerIndex]->m_xboxControllerID);
+		}
+		if (g_inputRecording.IsRecording())
+		{
+			g_inputRecording.RecordFrame(m_playerFrameInputs);
+		}
+	}
+
+	if (m_netClient != nullptr)
+	{
+		//clients only look around locally, everything else on the map is whatever the server last sent
+		m_currentMap->UpdateInput(deltaSeconds);
+		m_netClient->Update(m_playerFrameInputs[0]);
+		m_netClient->ApplyToMap();
+		m_currentMap->UpdateCameras(m_netClient->GetRenderAlpha());
+	}
+	else
+	{
+		//remote inputs have to be merged in before players read them
+		for (int botIndex = 0; botIndex < m_loopbackBots.size(); botIndex++)
+		{
+			m_loopbackBots[botIndex]->Update(GetLoopbackBotInput(botIndex, deltaSeconds));
+		}
+		if (m_netServer != nullptr)
+		{
+			m_netServer->ReceivePackets();
+		}
 
-	m_currentMap->Update(deltaSeconds);
+		m_currentMap->UpdateInput(deltaSeconds);
+
+		float tickSeconds = m_simulationTickSeconds;
+		m_simulationAccumulator += deltaSeconds;
+		int numSteps = 0;
+		while (m_simulationAccumulator >= tickSeconds && numSteps < m_maxSimulationStepsPerFrame)
+		{
+			PROFILE_SCOPE("Game::SimulationTick");
+			double tickStartSeconds = GetCurrentTimeSeconds();
+			m_currentMap->Update(tickSeconds);
+			if (m_netServer != nullptr)
+			{
+				m_netServer->EndTick(GetCurrentTimeSeconds() - tickStartSeconds);
+			}
+			m_simulationAccumulator -= tickSeconds;
+			numSteps++;
+		}
+
+		//drop whatever is left over after a long hitch instead of spiraling further behind
+		if (m_simulationAccumulator >= tickSeconds)
+		{
+			m_simulationAccumulator = 0.0f;
+		}
+
+		m_currentMap->UpdateCameras(m_simulationAccumulator / tickSeconds);
+	}
 
 	if (g_theInput->WasKeyJustPressed(KEYCODE_ESC) || controller.WasButtonJustPressed(XBOX_BUTTON_SELECT))
 	{
@@ -405,43 +614,30 @@ void Game::RenderGameplay() const
 {
 	g_theRenderer->ClearScreen(Rgba8(50, 50, 50));	//clear screen to dark gray
 
-	g_theRenderer->BeginCamera(m_currentMap->m_players[0]->m_playerCamera);	//render game world with the world camera
-
-	//game renderering here
-	m_currentMap->Render(0);
-
-	g_theRenderer->EndCamera(m_currentMap->m_players[0]->m_playerCamera);
-
-	if (m_currentMap->m_players[1] != nullptr)
+	//headless replays and servers only simulate
+	if ((g_inputRecording.IsReplaying() && g_inputRecording.m_isHeadless) || (m_netServer != nullptr && m_netServer->m_isHeadless))
 	{
-		g_theRenderer->BeginCamera(m_currentMap->m_players[1]->m_playerCamera);	//render game world with the world camera
-
-		//game renderering here
-		m_currentMap->Render(1);
-
-		g_theRenderer->EndCamera(m_currentMap->m_players[1]->m_playerCamera);
+		return;
 	}
 
-	//debug world rendering
-	DebugRenderWorld(m_currentMap->m_players[0]->m_playerCamera);
-	if (m_currentMap->m_players[1] != nullptr)
+	//each local player renders the whole world into its own viewport, so every extra view costs a full map render
+	for (int playerIndex = 0; playerIndex < m_currentMap->m_numPlayers; playerIndex++)
 	{
-		DebugRenderWorld(m_currentMap->m_players[1]->m_playerCamera);
-	}
+		PROFILE_SCOPE("Game::RenderPlayerView");
+		Player const* player = m_currentMap->m_players[playerIndex];
 
-	//g_theRenderer->BeginCamera(m_gameScreenCamera);	//render UI with the screen camera
+		g_theRenderer->BeginCamera(player->m_playerCamera);	//render game world with the world camera
+		m_currentMap->Render(playerIndex);
+		g_theRenderer->EndCamera(player->m_playerCamera);
 
-	//screen camera rendering here
-	if (m_currentMap->m_players[0] != nullptr)
-	{
-		m_currentMap->m_players[0]->RenderHUD();
-	}
-	if (m_currentMap->m_players[1] != nullptr)
-	{
-		m_currentMap->m_players[1]->RenderHUD();
-	}
+		//debug world rendering
+		DebugRenderWorld(player->m_playerCamera);
+
+		//screen camera rendering here
+		player->RenderHUD();
 
-	//g_theRenderer->EndCamera(m_gameScreenCamera);
+		IncrementPerfCounter(PerfCounter::PLAYER_VIEWS_RENDERED);
+	}
 
 	//debug screen rendering
 	DebugRenderScreen(m_gameScreenCamera);
@@ -476,8 +672,7 @@ void Game::EnterState(GameState state)
 void Game::EnterAttract()
 {
 	//reset players
-	m_keyboardPlayer = -1;
-	m_controllerPlayer = -1;
+	m_joinedXboxIDs.clear();
 	
 	//start music
 	if (!g_theAudio->IsPlaying(m_mainMenuMusicPlayback))
@@ -514,6 +709,16 @@ void Game::ExitLobby()
 
 void Game::EnterGameplay()
 {
+	m_simulationAccumulator = 0.0f;
+	m_simulationTickSeconds = 1.0f / g_gameConfigBlackboard.GetValue("simulationTickRate", 60.0f);
+	m_maxSimulationStepsPerFrame = g_gameConfigBlackboard.GetValue("maxSimulationStepsPerFrame", 4);
+
+	//the lighting mode picks both the music and the map, so replays have to set it first
+	if (g_inputRecording.m_state == InputRecordingState::REPLAY_LOADED)
+	{
+		m_isLightsOutMode = g_inputRecording.m_isLightsOutMode;
+	}
+
 	//change music
 	g_theAudio->StopSound(m_mainMenuMusicPlayback);
 	std::string mapType = "defaultMap";
@@ -527,48 +732,67 @@ void Game::EnterGameplay()
 		mapType = "lightsOutMap";
 	}
 
-	//create map
-	if (m_keyboardPlayer == -1)
+	//work out who is playing on which device, in join order
+	std::string mapName = g_gameConfigBlackboard.GetValue(mapType, "testMap");
+	std::vector<int> playerXboxIDs = m_joinedXboxIDs;
+	if (playerXboxIDs.empty())
 	{
-		std::string mapName = g_gameConfigBlackboard.GetValue(mapType, "testMap");
-		m_currentMap = new Map(this, MapDefinition::GetMapDefinition(mapName), 1, 0, -1);
-		m_currentMap->Startup();
-		g_theAudio->SetNumListeners(1);
+		playerXboxIDs.push_back(-1);
 	}
-	else if (m_controllerPlayer == -1)
+
+	//replays rebuild the recorded session instead, rng included, before anything in the map rolls
+	if (g_inputRecording.m_state == InputRecordingState::REPLAY_LOADED)
 	{
-		std::string mapName = g_gameConfigBlackboard.GetValue(mapType, "testMap");
-		m_currentMap = new Map(this, MapDefinition::GetMapDefinition(mapName), 1, -1, -1);
-		m_currentMap->Startup();
-		g_theAudio->SetNumListeners(1);
+		mapName = g_inputRecording.m_mapName;
+		playerXboxIDs = g_inputRecording.m_playerXboxIDs;
+		g_inputRecording.BeginReplay();
 	}
-	else if (m_keyboardPlayer == 0 && m_controllerPlayer == 1)
+	else if (g_inputRecording.m_state == InputRecordingState::RECORD_ARMED)
 	{
-		std::string mapName = g_gameConfigBlackboard.GetValue(mapType, "testMap");
-		m_currentMap = new Map(this, MapDefinition::GetMapDefinition(mapName), 2, -1, 0);
-		m_currentMap->Startup();
-		g_theAudio->SetNumListeners(2);
+		g_inputRecording.BeginRecording(mapName, playerXboxIDs, m_isLightsOutMode);
+	}
 
+	//network clients play whatever map the server is running, on a single local player
+	if (m_netClient != nullptr)
+	{
+		mapName = m_netClient->m_mapName;
+		playerXboxIDs.assign(1, m_netClient->m_xboxID);
 	}
-	else if (m_controllerPlayer == 0 && m_keyboardPlayer == 1)
+
+	//create map
+	m_playerFrameInputs.assign(playerXboxIDs.size(), FrameInput());
+	m_currentMap = new Map(this, MapDefinition::GetMapDefinition(mapName), playerXboxIDs);
+	m_currentMap->Startup();
+	g_theAudio->SetNumListeners(static_cast<int>(playerXboxIDs.size()));
+
+	if (m_netClient != nullptr)
 	{
-		std::string mapName = g_gameConfigBlackboard.GetValue(mapType, "testMap");
-		m_currentMap = new Map(this, MapDefinition::GetMapDefinition(mapName), 2, 0, -1);
-		m_currentMap->Startup();
-		g_theAudio->SetNumListeners(2);
+		m_netClient->AttachMap(m_currentMap);
 	}
 }
 
 
 void Game::ExitGameplay()
 {
+	//servers live on the map, clients just need a new map to mirror onto
+	if (m_netServer != nullptr)
+	{
+		StopNetworking();
+	}
+	else if (m_netClient != nullptr)
+	{
+		m_netClient->m_map = nullptr;
+	}
+
 	//destroy map
 	if (m_currentMap != nullptr)
 	{
+		g_inputRecording.EndSession();
 		m_currentMap->Shutdown();
 
 		delete m_currentMap;
 		m_currentMap = nullptr;
+		g_perfCounters.m_currentMap = nullptr;
 	}
 }
 
@@ -616,6 +840,11 @@ void Game::LoadDefinitions()
 	{
 		ActorDefinition::InitializeProjectileActorDefs();
 	}
+	//weapons look up their hit effects by index, so effects have to load first
+	if (EffectDefinition::s_effectDefinitions.size() == 0)
+	{
+		EffectDefinition::InitializeEffectDefs();
+	}
 	if (WeaponDefinition::s_weaponDefinitions.size() == 0)
 	{
 		WeaponDefinition::InitializeWeaponDefs();
@@ -1,5 +1,6 @@
 #pragma once
 #include "Game/GameCommon.hpp"
+#include "Game/InputRecording.hpp"
 #include "Engine/Renderer/Camera.hpp"
 #include "Engine/Audio/AudioSystem.hpp"
 #include "Engine/Core/Clock.hpp"
@@ -9,6 +10,9 @@
 class Player;
 class Map;
 class BitmapFont;
+class NetServer;
+class NetClient;
+class LoopbackNetwork;
 
 
 //game state enum
@@ -33,14 +37,20 @@ public:
 	void Render() const;
 	void Shutdown();
 
+	//networking functions
+	bool		StartNetServer(unsigned short port, bool isHeadless);
+	bool		StartNetLoopbackTest(int numBots);
+	bool		ConnectToNetServer(std::string const& hostAddress, unsigned short port, int xboxID);
+	void		StopNetworking();
+	std::string GetNetStatsReport();
+
 //public member variables
 public:
 	//game state vars
 	bool		m_isFinished = false;
 	GameState	m_currentState = GameState::ATTRACT;
 	GameState	m_desiredState = GameState::ATTRACT;
-	int			m_keyboardPlayer = -1;
-	int			m_controllerPlayer = -1;
+	std::vector<int> m_joinedXboxIDs;		//lobby join order, -1 for keyboard and mouse
 	bool		m_isLightsOutMode = false;
 
 	//sounds
@@ -53,10 +63,22 @@ public:
 
 	//game clock
 	Clock m_gameClock = Clock();
+	float m_simulationAccumulator = 0.0f;	//game time not yet simulated, always less than one tick
+	float m_simulationTickSeconds = 1.0f / 60.0f;	//read from the config when gameplay starts
+	int	  m_maxSimulationStepsPerFrame = 4;
+
+	//gameplay input for each local player, captured live or read back from a replay once per frame
+	std::vector<FrameInput> m_playerFrameInputs;
 
 	//maps
 	Map* m_currentMap;
 
+	//networking, a game is either a server (optionally feeding loopback bots) or a client
+	NetServer*				m_netServer = nullptr;
+	NetClient*				m_netClient = nullptr;
+	LoopbackNetwork*		m_loopbackNetwork = nullptr;
+	std::vector<NetClient*> m_loopbackBots;
+
 	//fonts
 	BitmapFont* m_menuFont;
 
@@ -71,6 +93,8 @@ private:
 
 	void UpdateLobby();
 	void RenderLobby() const;
+	bool JoinPlayer(int xboxID);
+	int	 GetJoinedPlayerIndex(int xboxID) const;
 
 	void UpdateGameplay();
 	void RenderGameplay() const;
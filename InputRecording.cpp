@@ -0,0 +1,412 @@
+#include "Game/InputRecording.hpp"
+#include "Game/GameCommon.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Input/InputSystem.hpp"
+#include "Engine/Math/RandomNumberGenerator.hpp"
+#include <fstream>
+#include <cstring>
+
+
+InputRecording g_inputRecording;
+
+
+//file layout constants
+static const unsigned int k_recordingMagic = 0x52494644;	//"DFIR"
+static const unsigned int k_recordingVersion = 2;
+
+//the engine rng keeps its seed and position private, so the whole object is saved as raw bytes
+static_assert(sizeof(RandomNumberGenerator) <= sizeof(InputRecording::m_rngState), "rng state no longer fits in an input recording");
+
+
+//
+//static helper functions
+//
+template <typename T>
+static void AppendToBuffer(std::vector<unsigned char>& buffer, T const& value)
+{
+	unsigned char const* valueBytes = reinterpret_cast<unsigned char const*>(&value);
+	buffer.insert(buffer.end(), valueBytes, valueBytes + sizeof(T));
+}
+
+
+template <typename T>
+static bool ReadFromBuffer(std::vector<uint8_t> const& buffer, size_t& readOffset, T& out_value)
+{
+	if (readOffset + sizeof(T) > buffer.size())
+	{
+		return false;
+	}
+
+	memcpy(&out_value, buffer.data() + readOffset, sizeof(T));
+	readOffset += sizeof(T);
+	return true;
+}
+
+
+static bool Event_RecordInput(EventArgs& args)
+{
+	if (g_inputRecording.m_state == InputRecordingState::RECORDING)
+	{
+		g_inputRecording.EndSession();
+		return true;
+	}
+
+	if (g_inputRecording.m_state != InputRecordingState::IDLE)
+	{
+		g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, "Can't record input while a replay is loaded or running");
+		return false;
+	}
+
+	g_inputRecording.ArmRecording(args.GetValue("file", "InputRecording.dfr"));
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, "Input recording starts with a fresh map, run recordinput again to stop and write the file");
+	return true;
+}
+
+
+static bool Event_ReplayInput(EventArgs& args)
+{
+	if (g_inputRecording.m_state != InputRecordingState::IDLE)
+	{
+		g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, "Can't start a replay while recording or replaying");
+		return false;
+	}
+
+	std::string filePath = args.GetValue("file", "InputRecording.dfr");
+	bool isHeadless = args.GetValue("headless", false);
+	return g_inputRecording.LoadReplay(filePath, isHeadless);
+}
+
+
+//
+//public frame input functions
+//
+bool FrameInput::IsButtonDown(InputButton button) const
+{
+	return (m_buttonsDown & (1u << (int)button)) != 0;
+}
+
+
+bool FrameInput::WasButtonJustPressed(InputButton button) const
+{
+	return (m_buttonsJustPressed & (1u << (int)button)) != 0;
+}
+
+
+void FrameInput::SetButton(InputButton button, bool isDown, bool wasJustPressed)
+{
+	if (isDown)
+	{
+		m_buttonsDown |= 1u << (int)button;
+	}
+	if (wasJustPressed)
+	{
+		m_buttonsJustPressed |= 1u << (int)button;
+	}
+}
+
+
+//
+//public recording functions
+//
+void InputRecording::ArmRecording(std::string const& filePath)
+{
+	m_state = InputRecordingState::RECORD_ARMED;
+	m_filePath = filePath;
+	m_frames.clear();
+	m_isMapRestartRequested = true;
+}
+
+
+void InputRecording::BeginRecording(std::string const& mapName, std::vector<int> const& playerXboxIDs, bool isLightsOutMode)
+{
+	m_mapName = mapName;
+	m_playerXboxIDs = playerXboxIDs;
+	m_isLightsOutMode = isLightsOutMode;
+	memcpy(m_rngState, &g_rng, sizeof(RandomNumberGenerator));
+
+	m_frames.clear();
+	m_state = InputRecordingState::RECORDING;
+}
+
+
+void InputRecording::RecordFrame(std::vector<FrameInput> const& playerFrameInputs)
+{
+	m_frames.insert(m_frames.end(), playerFrameInputs.begin(), playerFrameInputs.end());
+}
+
+
+bool InputRecording::WriteRecording() const
+{
+	std::vector<unsigned char> buffer;
+	buffer.reserve(64 + m_mapName.size() + m_frames.size() * sizeof(FrameInput));
+
+	AppendToBuffer(buffer, k_recordingMagic);
+	AppendToBuffer(buffer, k_recordingVersion);
+	AppendToBuffer(buffer, static_cast<unsigned int>(sizeof(RandomNumberGenerator)));
+	buffer.insert(buffer.end(), m_rngState, m_rngState + sizeof(RandomNumberGenerator));
+	AppendToBuffer(buffer, static_cast<unsigned int>(m_mapName.size()));
+	buffer.insert(buffer.end(), m_mapName.begin(), m_mapName.end());
+	AppendToBuffer(buffer, static_cast<char>(m_playerXboxIDs.size()));
+	for (int playerIndex = 0; playerIndex < m_playerXboxIDs.size(); playerIndex++)
+	{
+		AppendToBuffer(buffer, static_cast<char>(m_playerXboxIDs[playerIndex]));
+	}
+	AppendToBuffer(buffer, static_cast<char>(m_isLightsOutMode));
+	AppendToBuffer(buffer, static_cast<unsigned int>(m_frames.size()));
+
+	//floats are written raw so the replay sees exactly the same bits
+	for (int frameIndex = 0; frameIndex < m_frames.size(); frameIndex++)
+	{
+		FrameInput const& frame = m_frames[frameIndex];
+		AppendToBuffer(buffer, frame.m_deltaSeconds);
+		AppendToBuffer(buffer, frame.m_buttonsDown);
+		AppendToBuffer(buffer, frame.m_buttonsJustPressed);
+		AppendToBuffer(buffer, frame.m_cursorDelta.x);
+		AppendToBuffer(buffer, frame.m_cursorDelta.y);
+		AppendToBuffer(buffer, frame.m_leftStick.x);
+		AppendToBuffer(buffer, frame.m_leftStick.y);
+		AppendToBuffer(buffer, frame.m_rightStick.x);
+		AppendToBuffer(buffer, frame.m_rightStick.y);
+		AppendToBuffer(buffer, frame.m_rightTrigger);
+	}
+
+	std::ofstream recordingFile(m_filePath, std::ios::binary);
+	if (!recordingFile.is_open())
+	{
+		return false;
+	}
+
+	recordingFile.write(reinterpret_cast<char const*>(buffer.data()), buffer.size());
+	return recordingFile.good();
+}
+
+
+//
+//public replay functions
+//
+bool InputRecording::LoadReplay(std::string const& filePath, bool isHeadless)
+{
+	std::vector<uint8_t> buffer;
+	if (FileReadToBuffer(buffer, filePath) <= 0)
+	{
+		g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, Stringf("Failed to read input recording %s", filePath.c_str()));
+		return false;
+	}
+
+	size_t readOffset = 0;
+	unsigned int magic = 0;
+	unsigned int version = 0;
+	unsigned int rngStateSize = 0;
+	bool isValid = ReadFromBuffer(buffer, readOffset, magic) && ReadFromBuffer(buffer, readOffset, version) && ReadFromBuffer(buffer, readOffset, rngStateSize);
+	if (!isValid || magic != k_recordingMagic || version != k_recordingVersion || rngStateSize != sizeof(RandomNumberGenerator) || readOffset + rngStateSize > buffer.size())
+	{
+		g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, Stringf("%s is not an input recording from this build", filePath.c_str()));
+		return false;
+	}
+
+	memcpy(m_rngState, buffer.data() + readOffset, rngStateSize);
+	readOffset += rngStateSize;
+
+	unsigned int mapNameLength = 0;
+	isValid = ReadFromBuffer(buffer, readOffset, mapNameLength) && readOffset + mapNameLength <= buffer.size();
+	if (isValid)
+	{
+		m_mapName.assign(reinterpret_cast<char const*>(buffer.data() + readOffset), mapNameLength);
+		readOffset += mapNameLength;
+	}
+
+	char numPlayers = 0;
+	std::vector<int> playerXboxIDs;
+	isValid = isValid && ReadFromBuffer(buffer, readOffset, numPlayers) && numPlayers > 0;
+	for (int playerIndex = 0; isValid && playerIndex < numPlayers; playerIndex++)
+	{
+		char xboxID = 0;
+		isValid = ReadFromBuffer(buffer, readOffset, xboxID);
+		playerXboxIDs.push_back(xboxID);
+	}
+
+	char isLightsOutMode = 0;
+	unsigned int numFrames = 0;
+	isValid = isValid && ReadFromBuffer(buffer, readOffset, isLightsOutMode) && ReadFromBuffer(buffer, readOffset, numFrames) && numFrames % numPlayers == 0;
+
+	m_frames.clear();
+	for (unsigned int frameIndex = 0; isValid && frameIndex < numFrames; frameIndex++)
+	{
+		FrameInput frame;
+		isValid = ReadFromBuffer(buffer, readOffset, frame.m_deltaSeconds) && ReadFromBuffer(buffer, readOffset, frame.m_buttonsDown) && ReadFromBuffer(buffer, readOffset, frame.m_buttonsJustPressed)
+			&& ReadFromBuffer(buffer, readOffset, frame.m_cursorDelta.x) && ReadFromBuffer(buffer, readOffset, frame.m_cursorDelta.y)
+			&& ReadFromBuffer(buffer, readOffset, frame.m_leftStick.x) && ReadFromBuffer(buffer, readOffset, frame.m_leftStick.y)
+			&& ReadFromBuffer(buffer, readOffset, frame.m_rightStick.x) && ReadFromBuffer(buffer, readOffset, frame.m_rightStick.y)
+			&& ReadFromBuffer(buffer, readOffset, frame.m_rightTrigger);
+		m_frames.push_back(frame);
+	}
+
+	if (!isValid)
+	{
+		m_frames.clear();
+		g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, Stringf("Input recording %s is truncated", filePath.c_str()));
+		return false;
+	}
+
+	m_playerXboxIDs = playerXboxIDs;
+	m_isLightsOutMode = isLightsOutMode != 0;
+	m_filePath = filePath;
+	m_isHeadless = isHeadless;
+	m_state = InputRecordingState::REPLAY_LOADED;
+	m_isMapRestartRequested = true;
+
+	g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, Stringf("Loaded %d recorded frames for %d players on %s, replay starts with a fresh map", GetNumFrames(), static_cast<int>(numPlayers),
+		m_mapName.c_str()));
+	return true;
+}
+
+
+void InputRecording::BeginReplay()
+{
+	memcpy(&g_rng, m_rngState, sizeof(RandomNumberGenerator));
+
+	m_replayFrameIndex = 0;
+	m_replayStartSeconds = GetCurrentTimeSeconds();
+	m_state = InputRecordingState::REPLAYING;
+}
+
+
+bool InputRecording::ReadNextFrame(std::vector<FrameInput>& out_playerFrameInputs)
+{
+	if (m_replayFrameIndex >= GetNumFrames())
+	{
+		return false;
+	}
+
+	int numPlayers = static_cast<int>(m_playerXboxIDs.size());
+	auto frameBegin = m_frames.begin() + m_replayFrameIndex * numPlayers;
+	out_playerFrameInputs.assign(frameBegin, frameBegin + numPlayers);
+	m_replayFrameIndex++;
+	return true;
+}
+
+
+//
+//public session functions
+//
+void InputRecording::EndSession()
+{
+	if (m_state == InputRecordingState::RECORDING)
+	{
+		if (WriteRecording())
+		{
+			g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, Stringf("Recorded %d frames to %s", GetNumFrames(), m_filePath.c_str()));
+		}
+		else
+		{
+			g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, Stringf("Failed to write input recording %s", m_filePath.c_str()));
+		}
+	}
+	else if (m_state == InputRecordingState::REPLAYING)
+	{
+		double replaySeconds = GetCurrentTimeSeconds() - m_replayStartSeconds;
+		double averageMilliseconds = m_replayFrameIndex > 0 ? (replaySeconds * 1000.0) / m_replayFrameIndex : 0.0;
+		g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, Stringf("Replayed %d of %d frames in %.2fs (%.3fms per frame)", m_replayFrameIndex, GetNumFrames(),
+			replaySeconds, averageMilliseconds));
+	}
+	else
+	{
+		return;
+	}
+
+	m_frames.clear();
+	m_isHeadless = false;
+	m_state = InputRecordingState::IDLE;
+}
+
+
+//
+//public accessors
+//
+bool InputRecording::IsRecording() const
+{
+	return m_state == InputRecordingState::RECORDING;
+}
+
+
+bool InputRecording::IsReplaying() const
+{
+	return m_state == InputRecordingState::REPLAYING;
+}
+
+
+int InputRecording::GetNumFrames() const
+{
+	if (m_playerXboxIDs.empty())
+	{
+		return 0;
+	}
+
+	return static_cast<int>(m_frames.size() / m_playerXboxIDs.size());
+}
+
+
+//
+//public input functions
+//
+FrameInput CaptureFrameInput(float deltaSeconds, int xboxID)
+{
+	FrameInput frameInput;
+	frameInput.m_deltaSeconds = deltaSeconds;
+
+	frameInput.SetButton(InputButton::KEYBOARD_FORWARD, g_theInput->IsKeyDown('W'), false);
+	frameInput.SetButton(InputButton::KEYBOARD_BACK, g_theInput->IsKeyDown('S'), false);
+	frameInput.SetButton(InputButton::KEYBOARD_LEFT, g_theInput->IsKeyDown('A'), false);
+	frameInput.SetButton(InputButton::KEYBOARD_RIGHT, g_theInput->IsKeyDown('D'), false);
+	frameInput.SetButton(InputButton::KEYBOARD_UP, g_theInput->IsKeyDown('Z'), false);
+	frameInput.SetButton(InputButton::KEYBOARD_DOWN, g_theInput->IsKeyDown('C'), false);
+	frameInput.SetButton(InputButton::KEYBOARD_SPEED_UP, g_theInput->IsKeyDown(KEYCODE_SHIFT), false);
+	frameInput.SetButton(InputButton::KEYBOARD_ATTACK, g_theInput->IsKeyDown(KEYCODE_LMB), false);
+	frameInput.SetButton(InputButton::KEYBOARD_WEAPON_1, false, g_theInput->WasKeyJustPressed('1'));
+	frameInput.SetButton(InputButton::KEYBOARD_WEAPON_2, false, g_theInput->WasKeyJustPressed('2'));
+	frameInput.SetButton(InputButton::KEYBOARD_PREVIOUS_WEAPON, false, g_theInput->WasKeyJustPressed(KEYCODE_LEFT));
+	frameInput.SetButton(InputButton::KEYBOARD_NEXT_WEAPON, false, g_theInput->WasKeyJustPressed(KEYCODE_RIGHT));
+	frameInput.SetButton(InputButton::TOGGLE_FREE_FLY, false, g_theInput->WasKeyJustPressed('F'));
+	frameInput.SetButton(InputButton::DEBUG_POSSESS, false, g_theInput->WasKeyJustPressed('N'));
+	frameInput.SetButton(InputButton::DEBUG_BENCHMARK_HORDE, false, g_theInput->WasKeyJustPressed(KEYCODE_F10));
+	frameInput.m_cursorDelta = g_theInput->GetCursorClientDelta();
+
+	//the keyboard half is captured for everyone since the debug keys live there, keyboard players leave the controller half empty
+	if (xboxID < 0)
+	{
+		return frameInput;
+	}
+
+	XboxController const& controller = g_theInput->GetController(xboxID);
+	frameInput.SetButton(InputButton::CONTROLLER_SPEED_UP, controller.IsButtonDown(XBOX_BUTTON_A), false);
+	frameInput.SetButton(InputButton::CONTROLLER_WEAPON_1, false, controller.WasButtonJustPressed(XBOX_BUTTON_X));
+	frameInput.SetButton(InputButton::CONTROLLER_WEAPON_2, false, controller.WasButtonJustPressed(XBOX_BUTTON_Y));
+	frameInput.SetButton(InputButton::CONTROLLER_SWAP_WEAPON, false, controller.WasButtonJustPressed(XBOX_BUTTON_DOWN));
+	if (controller.GetLeftStick().GetMagnitude() > 0.0f)
+	{
+		frameInput.m_leftStick = controller.GetLeftStick().GetPosition();
+	}
+	if (controller.GetRightStick().GetMagnitude() > 0.0f)
+	{
+		frameInput.m_rightStick = controller.GetRightStick().GetPosition();
+	}
+	frameInput.m_rightTrigger = controller.GetRightTrigger();
+
+	return frameInput;
+}
+
+
+void InputRecordingStartup()
+{
+	SubscribeEventCallbackFunction("recordinput", Event_RecordInput);
+	SubscribeEventCallbackFunction("replayinput", Event_ReplayInput);
+}
+
+
+void InputRecordingShutdown()
+{
+	UnsubscribeEventCallbackFunction("recordinput", Event_RecordInput);
+	UnsubscribeEventCallbackFunction("replayinput", Event_ReplayInput);
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Math/Vec2.hpp"
+
+
+//every input that can change the simulation, keyboard and controller kept apart so split screen replays correctly
+enum class InputButton
+{
+	KEYBOARD_FORWARD,
+	KEYBOARD_BACK,
+	KEYBOARD_LEFT,
+	KEYBOARD_RIGHT,
+	KEYBOARD_UP,
+	KEYBOARD_DOWN,
+	KEYBOARD_SPEED_UP,
+	KEYBOARD_ATTACK,
+	KEYBOARD_WEAPON_1,
+	KEYBOARD_WEAPON_2,
+	KEYBOARD_PREVIOUS_WEAPON,
+	KEYBOARD_NEXT_WEAPON,
+	CONTROLLER_SPEED_UP,
+	CONTROLLER_WEAPON_1,
+	CONTROLLER_WEAPON_2,
+	CONTROLLER_SWAP_WEAPON,
+	TOGGLE_FREE_FLY,
+	DEBUG_POSSESS,
+	DEBUG_BENCHMARK_HORDE,
+	COUNT
+};
+
+
+struct FrameInput
+{
+	float		 m_deltaSeconds = 0.0f;		//game clock delta, already paused or slowed down
+	unsigned int m_buttonsDown = 0;
+	unsigned int m_buttonsJustPressed = 0;
+	IntVec2		 m_cursorDelta;
+	Vec2		 m_leftStick;				//zero inside the dead zone
+	Vec2		 m_rightStick;
+	float		 m_rightTrigger = 0.0f;
+
+	bool IsButtonDown(InputButton button) const;
+	bool WasButtonJustPressed(InputButton button) const;
+	void SetButton(InputButton button, bool isDown, bool wasJustPressed);
+};
+
+
+enum class InputRecordingState
+{
+	IDLE,
+	RECORD_ARMED,		//recording starts with the next map
+	RECORDING,
+	REPLAY_LOADED,		//replay starts with the next map
+	REPLAYING,
+};
+
+
+class InputRecording
+{
+//public member functions
+public:
+	//recording functions
+	void ArmRecording(std::string const& filePath);
+	void BeginRecording(std::string const& mapName, std::vector<int> const& playerXboxIDs, bool isLightsOutMode);
+	void RecordFrame(std::vector<FrameInput> const& playerFrameInputs);
+	bool WriteRecording() const;
+
+	//replay functions
+	bool LoadReplay(std::string const& filePath, bool isHeadless);
+	void BeginReplay();
+	bool ReadNextFrame(std::vector<FrameInput>& out_playerFrameInputs);
+
+	//session functions
+	void EndSession();
+
+	//accessors
+	bool IsRecording() const;
+	bool IsReplaying() const;
+	int	 GetNumFrames() const;
+
+//public member variables
+public:
+	InputRecordingState m_state = InputRecordingState::IDLE;
+	std::string			m_filePath;
+	bool				m_isMapRestartRequested = false;
+	bool				m_isHeadless = false;
+
+	//session header, everything needed to rebuild the same map before the first frame
+	std::string		 m_mapName;
+	std::vector<int> m_playerXboxIDs;
+	bool			 m_isLightsOutMode = false;
+	unsigned char m_rngState[64] = {};
+
+	std::vector<FrameInput> m_frames;				//one input per local player per frame, players in order
+	int						m_replayFrameIndex = 0;
+	double					m_replayStartSeconds = 0.0;
+};
+
+
+extern InputRecording g_inputRecording;
+
+
+//input functions
+FrameInput CaptureFrameInput(float deltaSeconds, int xboxID);
+
+void InputRecordingStartup();
+void InputRecordingShutdown();
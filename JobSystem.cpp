@@ -0,0 +1,154 @@
+#include "Game/JobSystem.hpp"
+#include "Game/GameCommon.hpp"
+
+
+JobSystem g_jobSystem;
+
+
+//
+//public startup and shutdown functions
+//
+void JobSystem::Startup(int numWorkerThreads)
+{
+	m_isQuitting = false;
+	for (int threadIndex = 0; threadIndex < numWorkerThreads; threadIndex++)
+	{
+		m_workerThreads.emplace_back(&JobSystem::WorkerThreadMain, this);
+	}
+}
+
+
+void JobSystem::Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isQuitting = true;
+	}
+	m_batchReadyCondition.notify_all();
+
+	for (int threadIndex = 0; threadIndex < m_workerThreads.size(); threadIndex++)
+	{
+		m_workerThreads[threadIndex].join();
+	}
+	m_workerThreads.clear();
+}
+
+
+//
+//public job functions
+//
+void JobSystem::ParallelFor(int numJobs, std::function<void(int)> const& jobFunction)
+{
+	if (numJobs <= 0)
+	{
+		return;
+	}
+
+	//nothing to hand off, skip the wake up and sync
+	if (m_workerThreads.empty() || numJobs == 1)
+	{
+		for (int jobIndex = 0; jobIndex < numJobs; jobIndex++)
+		{
+			jobFunction(jobIndex);
+		}
+		return;
+	}
+
+	{
+		//a worker that woke up late for the last batch may still be checking it, wait it out before swapping the batch
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_workerIdleCondition.wait(lock, [this]() { return m_numBusyWorkers == 0; });
+
+		m_jobFunction = &jobFunction;
+		m_numJobs = numJobs;
+		m_nextJobIndex = 0;
+		m_batchGeneration++;
+	}
+	m_batchReadyCondition.notify_all();
+
+	RunJobs();
+
+	//every job index has been handed out, the batch is done once the workers holding the last ones finish
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_workerIdleCondition.wait(lock, [this]() { return m_numBusyWorkers == 0; });
+	m_jobFunction = nullptr;
+	m_numJobs = 0;
+}
+
+
+//
+//public accessors
+//
+int JobSystem::GetNumThreads() const
+{
+	return static_cast<int>(m_workerThreads.size()) + 1;
+}
+
+
+//
+//private functions
+//
+void JobSystem::WorkerThreadMain()
+{
+	unsigned int lastBatchGeneration = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_batchReadyCondition.wait(lock, [this, lastBatchGeneration]() { return m_isQuitting || m_batchGeneration != lastBatchGeneration; });
+			if (m_isQuitting)
+			{
+				return;
+			}
+
+			lastBatchGeneration = m_batchGeneration;
+			m_numBusyWorkers++;
+		}
+
+		RunJobs();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_numBusyWorkers--;
+		}
+		m_workerIdleCondition.notify_all();
+	}
+}
+
+
+void JobSystem::RunJobs()
+{
+	while (true)
+	{
+		int jobIndex = m_nextJobIndex.fetch_add(1);
+		if (jobIndex >= m_numJobs)
+		{
+			return;
+		}
+
+		(*m_jobFunction)(jobIndex);
+	}
+}
+
+
+//
+//job system functions
+//
+void JobSystemStartup()
+{
+	//the main thread runs jobs too, so by default leave it one core and give the workers the rest
+	int numWorkerThreads = static_cast<int>(std::thread::hardware_concurrency()) - 1;
+	numWorkerThreads = g_gameConfigBlackboard.GetValue("numJobWorkerThreads", numWorkerThreads);
+	if (numWorkerThreads < 0)
+	{
+		numWorkerThreads = 0;
+	}
+
+	g_jobSystem.Startup(numWorkerThreads);
+}
+
+
+void JobSystemShutdown()
+{
+	g_jobSystem.Shutdown();
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "Engine/Core/EngineCommon.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+
+//a fixed pool of worker threads for splitting one batch of independent jobs, the calling thread works through the batch too
+//and only returns once every job has finished, so callers never see a half done batch
+class JobSystem
+{
+//public member functions
+public:
+	//startup and shutdown functions
+	void Startup(int numWorkerThreads);
+	void Shutdown();
+
+	//job functions
+	void ParallelFor(int numJobs, std::function<void(int)> const& jobFunction);
+
+	//accessors
+	int GetNumThreads() const;		//workers plus the calling thread
+
+//public member variables
+public:
+	std::vector<std::thread> m_workerThreads;
+
+//private member functions
+private:
+	void WorkerThreadMain();
+	void RunJobs();
+
+//private member variables
+private:
+	std::mutex				m_mutex;
+	std::condition_variable m_batchReadyCondition;
+	std::condition_variable m_workerIdleCondition;
+
+	//current batch, only changed under the lock while no worker is busy
+	std::function<void(int)> const* m_jobFunction = nullptr;
+	int								m_numJobs = 0;
+	std::atomic<int>				m_nextJobIndex = 0;
+	unsigned int					m_batchGeneration = 0;
+	int								m_numBusyWorkers = 0;
+	bool							m_isQuitting = false;
+};
+
+
+extern JobSystem g_jobSystem;
+
+
+void JobSystemStartup();
+void JobSystemShutdown();
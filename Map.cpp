@@ -9,6 +9,9 @@
 #include "Game/Weapon.hpp"
 #include "Game/WeaponDefinition.hpp"
 #include "Game/GameCommon.hpp"
+#include "Game/Profiler.hpp"
+#include "Game/PerfCounters.hpp"
+#include "Game/JobSystem.hpp"
 #include "Engine/Renderer/SpriteSheet.hpp"
 #include "Engine/Renderer/Renderer.hpp"
 #include "Engine/Renderer/VertexBuffer.hpp"
@@ -19,6 +22,8 @@
 #include "Engine/Renderer/DebugRenderSystem.hpp"
 #include "Engine/Math/RandomNumberGenerator.hpp"
 #include "Engine/Window/Window.hpp"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
 
 
 //special flashlight constants for lights out mode
@@ -31,18 +36,97 @@ struct FlashlightConstants
 };
 static const int k_lightConstantsSlot = 4;
 
+//actors keep moving after the buckets are built each tick, so radius queries look this much farther out
+static const float k_actorBucketMargin = 1.0f;
+
+//tile type for pixels that match no tile definition, which are kept as walls so they can't leak actors out of the map
+static const unsigned char k_unknownTileType = 0xff;
+
+//extra reach on each side of the clipped ray for the raycast actor search, covers actor radius and bucket drift
+static const float k_raycastActorMargin = 1.5f;
+
+//the eight neighbors an actor is pushed out of, in push order, bit N of a neighbor solid mask is entry N
+static const IntVec2 k_neighborTileOffsets[8] = { IntVec2(0, 1), IntVec2(1, 0), IntVec2(0, -1), IntVec2(-1, 0), IntVec2(1, 1), IntVec2(1, -1), IntVec2(-1, -1), IntVec2(-1, 1) };
+
+//actor collision cells are never smaller than this, so tiny actors don't blow up the cell count
+static const float k_minActorCollisionCellSize = 2.0f;
+
+//the neighbors a collision cell checks its actors against, the other four check this cell from their side
+static const IntVec2 k_forwardCollisionCellOffsets[4] = { IntVec2(1, 0), IntVec2(-1, 1), IntVec2(0, 1), IntVec2(1, 1) };
+
+//actors per map collision job
+static const int k_mapCollisionChunkSize = 64;
+
+//snapshots copy the engine rng as raw bytes
+static_assert(sizeof(RandomNumberGenerator) <= MAP_SNAPSHOT_RNG_BYTES, "rng state no longer fits in a map snapshot");
+
+
+//
+//raycast filter functions
+//
+void RaycastFilter::IgnoreActor(Actor const* actor)
+{
+	if (actor == nullptr)
+	{
+		return;
+	}
+
+	GUARANTEE_OR_DIE(m_numIgnoredActors < RAYCAST_MAX_IGNORED_ACTORS, "Raycast filter is ignoring too many actors");
+	m_ignoredActors[m_numIgnoredActors] = actor;
+	m_numIgnoredActors++;
+}
+
+
+
+//
+//static helper functions
+//
+static unsigned int SpreadBitsForMortonCode(unsigned int value)
+{
+	//puts a zero bit between each of the low 16 bits
+	value &= 0x0000ffff;
+	value = (value | (value << 8)) & 0x00ff00ff;
+	value = (value | (value << 4)) & 0x0f0f0f0f;
+	value = (value | (value << 2)) & 0x33333333;
+	value = (value | (value << 1)) & 0x55555555;
+	return value;
+}
+
+
+static unsigned int GetMortonCodeFromCoords(IntVec2 const& coords)
+{
+	return SpreadBitsForMortonCode(static_cast<unsigned int>(coords.x)) | (SpreadBitsForMortonCode(static_cast<unsigned int>(coords.y)) << 1);
+}
+
 
 //
 //constructor
 //
-Map::Map(Game* owner, MapDefinition const* definition, int numPlayers, int player1XboxID, int player2XboxID)
+Map::Map(Game* owner, MapDefinition const* definition, std::vector<int> const& playerXboxIDs)
 	: m_owner(owner)
 	, m_definition(definition)
-	, m_numPlayers(numPlayers)
+	, m_numPlayers(static_cast<int>(playerXboxIDs.size()))
 {
 	m_tileVertBuffer = g_theRenderer->CreateVertexBuffer(sizeof(Vertex_PNCU), sizeof(Vertex_PNCU));
 	m_tileIndexBuffer = g_theRenderer->CreateIndexBuffer(sizeof(unsigned int));
 	m_flashlightConstants = g_theRenderer->CreateConstantBuffer(sizeof(FlashlightConstants));
+	m_voiceManager = new VoiceManager(this);
+	m_effectSystem = new EffectSystem(this);
+	m_commandBuffer = new MapCommandBuffer(this);
+	m_projectileSystem = new ProjectileSystem(this);
+
+	m_actorSleepSpeed = g_gameConfigBlackboard.GetValue("actorSleepSpeed", m_actorSleepSpeed);
+	m_actorSleepAcceleration = g_gameConfigBlackboard.GetValue("actorSleepAcceleration", m_actorSleepAcceleration);
+	m_actorSleepTicks = g_gameConfigBlackboard.GetValue("actorSleepTicks", m_actorSleepTicks);
+	m_actorSortIntervalTicks = g_gameConfigBlackboard.GetValue("actorSortIntervalTicks", m_actorSortIntervalTicks);
+	m_maxFlowFieldRebuildsPerTick = g_gameConfigBlackboard.GetValue("maxFlowFieldRebuildsPerTick", m_maxFlowFieldRebuildsPerTick);
+	m_maxPlayers = g_gameConfigBlackboard.GetValue("netMaxPlayers", m_maxPlayers);
+	if (m_maxPlayers > 32)
+	{
+		m_maxPlayers = 32;	//watched masks have one bit per player
+	}
+
+	BuildSystemArchetypeMasks();
 
 	m_tileSpriteSheet = new SpriteSheet(*m_definition->m_spriteSheetTexture, m_definition->m_spriteSheetCellCount);
 
@@ -59,6 +143,10 @@ Map::Map(Game* owner, MapDefinition const* definition, int numPlayers, int playe
 	unsigned char const* imageData = (unsigned char*)m_definition->m_image.GetRawData();
 	m_dimensions = m_definition->m_image.GetImageDimensions();
 
+	//full tiles only live long enough to build the mesh, the map keeps the compact grid built from them
+	std::vector<Tile> tiles;
+	tiles.reserve(m_dimensions.x * m_dimensions.y);
+
 	int tileXCounter = 0;
 	int tileYCounter = 0;
 
@@ -71,39 +159,39 @@ Map::Map(Game* owner, MapDefinition const* definition, int numPlayers, int playe
 		//yes, I know this is a dumb way to do it
 		if (pixelColor == stoneFloor->m_mapImagePixelColor)
 		{
-			m_tiles.push_back(Tile(tileCoords, stoneFloor));
+			tiles.push_back(Tile(tileCoords, stoneFloor));
 		}
 		else if (pixelColor == woodFloor->m_mapImagePixelColor)
 		{
-			m_tiles.push_back(Tile(tileCoords, woodFloor));
+			tiles.push_back(Tile(tileCoords, woodFloor));
 		}
 		else if (pixelColor == dirtFloor->m_mapImagePixelColor)
 		{
-			m_tiles.push_back(Tile(tileCoords, dirtFloor));
+			tiles.push_back(Tile(tileCoords, dirtFloor));
 		}
 		else if (pixelColor == grassFloor->m_mapImagePixelColor)
 		{
-			m_tiles.push_back(Tile(tileCoords, grassFloor));
+			tiles.push_back(Tile(tileCoords, grassFloor));
 		}
 		else if (pixelColor == brickWall->m_mapImagePixelColor)
 		{
-			m_tiles.push_back(Tile(tileCoords, brickWall));
+			tiles.push_back(Tile(tileCoords, brickWall));
 		}
 		else if (pixelColor == woodWall->m_mapImagePixelColor)
 		{
-			m_tiles.push_back(Tile(tileCoords, woodWall));
+			tiles.push_back(Tile(tileCoords, woodWall));
 		}
 		else if (pixelColor == stoneWall->m_mapImagePixelColor)
 		{
-			m_tiles.push_back(Tile(tileCoords, stoneWall));
+			tiles.push_back(Tile(tileCoords, stoneWall));
 		}
 		else if (pixelColor == stoneFloor2->m_mapImagePixelColor)
 		{
-			m_tiles.push_back(Tile(tileCoords, stoneFloor2));
+			tiles.push_back(Tile(tileCoords, stoneFloor2));
 		}
 		else if (pixelColor == crackedStoneWall->m_mapImagePixelColor)
 		{
-			m_tiles.push_back(Tile(tileCoords, crackedStoneWall));
+			tiles.push_back(Tile(tileCoords, crackedStoneWall));
 		}
 
 		tileXCounter++;
@@ -114,61 +202,40 @@ Map::Map(Game* owner, MapDefinition const* definition, int numPlayers, int playe
 		}
 	}
 
-	for (int tileIndex = 0; tileIndex < m_tiles.size(); tileIndex++)
+	for (int tileIndex = 0; tileIndex < tiles.size(); tileIndex++)
 	{
-		m_tiles[tileIndex].AddVertsForTile(m_tileVerts, m_tileVertIndexes, m_tileSpriteSheet, m_definition->m_spriteSheetCellCount);
+		tiles[tileIndex].AddVertsForTile(m_tileVerts, m_tileVertIndexes, m_tileSpriteSheet, m_definition->m_spriteSheetCellCount);
 	}
 
+	BuildCompactTileGrid(tiles);
+	BuildTileNeighborSolidMasks();
+	BuildRegions();
+
 	for (int actorIndex = 0; actorIndex < m_definition->m_spawnInfos.size(); actorIndex++)
 	{
 		SpawnInfo const& spawnInfo = m_definition->m_spawnInfos[actorIndex];
 		SpawnActor(spawnInfo.m_actorName, spawnInfo.m_position, spawnInfo.m_orientation, spawnInfo.m_velocity);
 	}
 
-	//create players
-	m_players.resize(2);
-	m_currentPlayerActors.resize(2);
+	//create players, one view each, spawned in order so the rng rolls the same way for the same player count
+	m_players.resize(m_numPlayers);
+	m_currentPlayerActors.resize(m_numPlayers);
 
-	if (m_numPlayers == 2)
+	for (int playerIndex = 0; playerIndex < m_numPlayers; playerIndex++)
 	{
-		m_players[0] = new Player(m_owner, this, 0, player1XboxID);
-
-		m_players[0]->m_playerCamera.SetOrthoView(Vec2(WORLD_CAMERA_MIN_X, WORLD_CAMERA_MIN_Y), Vec2(WORLD_CAMERA_MAX_X, WORLD_CAMERA_MAX_Y));
-		m_players[0]->m_playerCamera.SetPerspectiveView(4.0f, 60.0f, 0.1f, 100.0f);
-		IntVec2 clientDimensions = g_theWindow->GetClientDimensions();
-		float screenWidth = static_cast<float>(clientDimensions.x);
-		float screenHeight = static_cast<float>(clientDimensions.y) * 0.5f;
-		m_players[0]->m_playerCamera.SetViewport(Vec2(0.0f, 0.0f), Vec2(screenWidth, screenHeight));
-		m_players[0]->m_playerCamera.SetRenderBasis(Vec3(0.0f, 0.0f, 1.0f), Vec3(-1.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f));
-
-		m_players[0]->m_playerScreenCamera.SetOrthoView(Vec2(0.0f, 0.0f), Vec2(SCREEN_CAMERA_SIZE_X, SCREEN_CAMERA_SIZE_Y));
-		m_players[0]->m_playerScreenCamera.SetViewport(Vec2(0.0f, 0.0f), Vec2(screenWidth, screenHeight));
-
-		SpawnPlayer(0);
+		m_players[playerIndex] = new Player(m_owner, this, playerIndex, playerXboxIDs[playerIndex]);
+		m_players[playerIndex]->m_playerCamera.SetOrthoView(Vec2(WORLD_CAMERA_MIN_X, WORLD_CAMERA_MIN_Y), Vec2(WORLD_CAMERA_MAX_X, WORLD_CAMERA_MAX_Y));
+		m_players[playerIndex]->m_playerCamera.SetRenderBasis(Vec3(0.0f, 0.0f, 1.0f), Vec3(-1.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f));
+		m_players[playerIndex]->m_playerScreenCamera.SetOrthoView(Vec2(0.0f, 0.0f), Vec2(SCREEN_CAMERA_SIZE_X, SCREEN_CAMERA_SIZE_Y));
 
-		m_players[1] = new Player(m_owner, this, 1, player2XboxID);
-
-		m_players[1]->m_playerCamera.SetOrthoView(Vec2(WORLD_CAMERA_MIN_X, WORLD_CAMERA_MIN_Y), Vec2(WORLD_CAMERA_MAX_X, WORLD_CAMERA_MAX_Y));
-		m_players[1]->m_playerCamera.SetPerspectiveView(4.0f, 60.0f, 0.1f, 100.0f);
-		m_players[1]->m_playerCamera.SetViewport(Vec2(0.0f, screenHeight), Vec2(screenWidth, screenHeight));
-		m_players[1]->m_playerCamera.SetRenderBasis(Vec3(0.0f, 0.0f, 1.0f), Vec3(-1.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f));
-
-		m_players[1]->m_playerScreenCamera.SetOrthoView(Vec2(0.0f, 0.0f), Vec2(SCREEN_CAMERA_SIZE_X, SCREEN_CAMERA_SIZE_Y));
-		m_players[1]->m_playerScreenCamera.SetViewport(Vec2(0.0f, screenHeight), Vec2(screenWidth, screenHeight));
-
-		SpawnPlayer(1);
+		SpawnPlayer(playerIndex);
 	}
-	else
-	{
-		m_players[0] = new Player(m_owner, this, 0, player1XboxID);
-
-		m_players[0]->m_playerCamera.SetOrthoView(Vec2(WORLD_CAMERA_MIN_X, WORLD_CAMERA_MIN_Y), Vec2(WORLD_CAMERA_MAX_X, WORLD_CAMERA_MAX_Y));
-		m_players[0]->m_playerCamera.SetPerspectiveView(2.0f, 60.0f, 0.1f, 100.0f);
-		m_players[0]->m_playerCamera.SetRenderBasis(Vec3(0.0f, 0.0f, 1.0f), Vec3(-1.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f));
 
-		m_players[0]->m_playerScreenCamera.SetOrthoView(Vec2(0.0f, 0.0f), Vec2(SCREEN_CAMERA_SIZE_X, SCREEN_CAMERA_SIZE_Y));
+	ArrangePlayerViews();
 
-		SpawnPlayer(0);
+	for (int playerIndex = 0; playerIndex < m_players.size(); playerIndex++)
+	{
+		m_playerFlowFields.push_back(FlowField(this));
 	}
 
 	/*for (int actorIndex = 0; actorIndex < m_allActors.size(); actorIndex++)
@@ -191,8 +258,10 @@ void Map::Startup()
 }
 
 
-void Map::Update(float deltaSeconds)
+void Map::UpdateInput(float deltaSeconds)
 {
+	PROFILE_SCOPE("Map::UpdateInput");
+
 	//debug lighting controls
 	if (g_theInput->WasKeyJustPressed(KEYCODE_F1))
 	{
@@ -263,47 +332,195 @@ void Map::Update(float deltaSeconds)
 		std::string ambientText = Stringf("New ambient intensity: %.2f", m_ambientIntensity);
 		DebugAddMessage(ambientText, 4.0f);
 	}
-	
-	if (m_currentPlayerActors[0] == nullptr)
+
+	if (m_owner->m_playerFrameInputs[0].WasButtonJustPressed(InputButton::DEBUG_BENCHMARK_HORDE) && !m_isNetClient)
 	{
-		SpawnPlayer(0);
+		DebugSpawnBenchmarkHorde();
 	}
-	if (m_currentPlayerActors[1] == nullptr && m_numPlayers == 2)
+
+	for (int playerIndex = 0; playerIndex < m_players.size(); playerIndex++)
 	{
-		SpawnPlayer(1);
+		Player* player = m_players[playerIndex];
+		if (player == nullptr)
+		{
+			continue;
+		}
+
+		//local players each get this frame's input from their own device, remote players use whatever the server has merged in since last frame
+		if (!player->m_isRemote)
+		{
+			player->m_frameInput = m_owner->m_playerFrameInputs[playerIndex];
+		}
+
+		player->UpdateInput(deltaSeconds);
+
+		if (player->m_isRemote)
+		{
+			player->m_frameInput.m_buttonsJustPressed = 0;
+			player->m_frameInput.m_cursorDelta = IntVec2();
+		}
 	}
-	
-	m_players[0]->Update(deltaSeconds);
-	if (m_numPlayers == 2)
+}
+
+
+void Map::Update(float deltaSeconds)
+{
+	PROFILE_SCOPE("Map::Update");
+
+	//remember where everything was at the start of the tick so rendering can blend toward where it ends up
+	for (int actorIndex = 0; actorIndex < m_liveActors.size(); actorIndex++)
+	{
+		Actor* actor = m_liveActors[actorIndex];
+		actor->m_previousPosition = actor->m_position;
+	}
+
+	for (int playerIndex = 0; playerIndex < m_players.size(); playerIndex++)
+	{
+		if (m_players[playerIndex] != nullptr && m_currentPlayerActors[playerIndex] == nullptr)
+		{
+			SpawnPlayer(playerIndex);
+		}
+	}
+
+	//every so often put live actors back in spatial order, before the buckets are built so buckets and collision cells inherit it
+	if (m_actorSortIntervalTicks > 0)
+	{
+		m_ticksSinceActorSort++;
+		if (m_ticksSinceActorSort >= m_actorSortIntervalTicks)
+		{
+			SortLiveActors(!m_isBenchmarkingSlotOrder);
+			m_ticksSinceActorSort = 0;
+		}
+	}
+
+	RebuildActorBuckets();
+
+	for (int playerIndex = 0; playerIndex < m_players.size(); playerIndex++)
 	{
-		m_players[1]->Update(deltaSeconds);
+		if (m_players[playerIndex] != nullptr)
+		{
+			m_players[playerIndex]->Update(deltaSeconds);
+		}
 	}
+
+	UpdateWatchedActors();
+
+	double flowFieldStartTime = GetCurrentTimeSeconds();
+	UpdateFlowFields();
+	double actorUpdateStartTime = GetCurrentTimeSeconds();
 	
-	for (int actorIndex = 0; actorIndex < m_allActors.size(); actorIndex++)
 	{
-		Actor*& actor = m_allActors[actorIndex];
+		PROFILE_SCOPE("Map::UpdateActors");
+		UpdateActorAI(deltaSeconds);
 
-		if (actor != nullptr)
+		//spawns are queued until the command buffer runs after this, so the loop only sees actors that were alive when the tick started
+		for (int actorIndex = 0; actorIndex < m_liveActors.size(); actorIndex++)
 		{
-			actor->Update(deltaSeconds);
+			m_liveActors[actorIndex]->Update(deltaSeconds);
 		}
+
+		UpdateActorPhysics(deltaSeconds);
 	}
 
+	double actorUpdateEndTime = GetCurrentTimeSeconds();
+
+	m_projectileSystem->Update(deltaSeconds);
+
+	double collisionStartTime = GetCurrentTimeSeconds();
 	CollideAllActorsWithEachOther();
 	CollideAllActorsWithMap();
 
-	g_theAudio->UpdateListener(0, m_players[0]->m_position, m_players[0]->GetModelMatrix().GetIBasis3D(), m_players[0]->GetModelMatrix().GetKBasis3D());
-	if (m_numPlayers == 2)
+	if (m_isBenchmarkingHorde)
+	{
+		double collisionEndTime = GetCurrentTimeSeconds();
+		DebugUpdateBenchmarkStats(actorUpdateStartTime - flowFieldStartTime, actorUpdateEndTime - actorUpdateStartTime, collisionEndTime - collisionStartTime);
+	}
+
+	//damage, impulses, spawns and sounds queued by this tick's updates and collisions all land here
+	m_commandBuffer->Execute();
+
+	m_effectSystem->Update(deltaSeconds);
+
+	//one listener per local player, remote players hear nothing here
+	for (int playerIndex = 0; playerIndex < m_numPlayers; playerIndex++)
 	{
-		g_theAudio->UpdateListener(1, m_players[1]->m_position, m_players[1]->GetModelMatrix().GetIBasis3D(), m_players[1]->GetModelMatrix().GetKBasis3D());
+		Player const* player = m_players[playerIndex];
+		g_theAudio->UpdateListener(playerIndex, player->m_position, player->GetModelMatrix().GetIBasis3D(), player->GetModelMatrix().GetKBasis3D());
 	}
 
+	m_voiceManager->Update();
+
 	DeleteDestroyedActors();
 }
 
 
+void Map::UpdateCameras(float renderAlpha)
+{
+	m_renderAlpha = renderAlpha;
+
+	for (int playerIndex = 0; playerIndex < m_players.size(); playerIndex++)
+	{
+		if (m_players[playerIndex] != nullptr)
+		{
+			m_players[playerIndex]->UpdateCamera();
+		}
+	}
+}
+
+
+//
+//public split screen functions
+//
+void Map::ArrangePlayerViews()
+{
+	//local players tile the window in a grid, stacked top to bottom for two like the original split screen
+	int numColumns = 1;
+	while (m_numPlayers > 2 && numColumns * numColumns < m_numPlayers)
+	{
+		numColumns++;
+	}
+	int numRows = (m_numPlayers + numColumns - 1) / numColumns;
+
+	IntVec2 clientDimensions = g_theWindow->GetClientDimensions();
+	float viewWidth = static_cast<float>(clientDimensions.x) / static_cast<float>(numColumns);
+	float viewHeight = static_cast<float>(clientDimensions.y) / static_cast<float>(numRows);
+
+	for (int playerIndex = 0; playerIndex < m_numPlayers; playerIndex++)
+	{
+		Vec2 viewMins = Vec2(static_cast<float>(playerIndex % numColumns) * viewWidth, static_cast<float>(playerIndex / numColumns) * viewHeight);
+		Vec2 viewDimensions = Vec2(viewWidth, viewHeight);
+
+		Player* player = m_players[playerIndex];
+		player->m_playerCamera.SetPerspectiveView(viewWidth / viewHeight, 60.0f, 0.1f, 100.0f);
+		player->m_playerCamera.SetViewport(viewMins, viewDimensions);
+		player->m_playerScreenCamera.SetViewport(viewMins, viewDimensions);
+	}
+}
+
+
+int Map::GetPlayerIndexForActor(Actor const* actor) const
+{
+	if (actor == nullptr)
+	{
+		return -1;
+	}
+
+	for (int playerIndex = 0; playerIndex < m_currentPlayerActors.size(); playerIndex++)
+	{
+		if (m_currentPlayerActors[playerIndex] == actor)
+		{
+			return playerIndex;
+		}
+	}
+
+	return -1;
+}
+
+
 void Map::Render(int currentPlayerRendering)
 {
+	PROFILE_SCOPE("Map::Render");
+
 	g_theRenderer->BindShader(m_definition->m_shader);
 	g_theRenderer->BindTexture(&m_tileSpriteSheet->GetTexture());
 	g_theRenderer->SetRasterizerMode(RasterizerMode::SOLID_CULL_BACK);
@@ -311,7 +528,8 @@ void Map::Render(int currentPlayerRendering)
 	
 	if (m_owner->m_isLightsOutMode)
 	{
-		Weapon*& flashlight = m_currentPlayerActors[0]->m_currentWeapon;
+		Actor const* playerActor = m_currentPlayerActors[currentPlayerRendering];
+		Weapon const* flashlight = playerActor != nullptr ? playerActor->m_currentWeapon : nullptr;
 		
 		g_theRenderer->SetLightConstants(m_sunDirection, m_lightsOutSunIntensity, m_lightsOutAmbientIntensity);
 		if (flashlight != nullptr)
@@ -332,16 +550,20 @@ void Map::Render(int currentPlayerRendering)
 	g_theRenderer->CopyCPUToGPU(m_tileVerts.data(), static_cast<int>(m_tileVerts.size()) * sizeof(Vertex_PNCU), m_tileVertBuffer);
 	g_theRenderer->CopyCPUToGPU(m_tileVertIndexes.data(), static_cast<int>(m_tileVertIndexes.size()) * sizeof(unsigned int), m_tileIndexBuffer);
 	g_theRenderer->DrawVertexBufferIndexed(m_tileVertBuffer, m_tileIndexBuffer, static_cast<int>(m_tileVertIndexes.size()));
+	IncrementPerfCounter(PerfCounter::MAP_DRAW_CALLS);
+	IncrementPerfCounter(PerfCounter::MAP_BYTES_UPLOADED, static_cast<int>(m_tileVerts.size() * sizeof(Vertex_PNCU) + m_tileVertIndexes.size() * sizeof(unsigned int)));
 
-	for (int actorIndex = 0; actorIndex < m_allActors.size(); actorIndex++)
+	std::vector<int> const& renderArchetypeMasks = m_systemArchetypeMasks[(int)ActorSystem::RENDER];
+	for (int maskIndex = 0; maskIndex < renderArchetypeMasks.size(); maskIndex++)
 	{
-		Actor*& actor = m_allActors[actorIndex];
-
-		if (actor != nullptr)
+		std::vector<Actor*> const& actors = m_archetypeActors[renderArchetypeMasks[maskIndex]];
+		for (int actorIndex = 0; actorIndex < actors.size(); actorIndex++)
 		{
-			actor->Render(currentPlayerRendering);
+			actors[actorIndex]->Render(currentPlayerRendering);
 		}
 	}
+
+	m_effectSystem->Render(currentPlayerRendering);
 }
 
 
@@ -371,16 +593,42 @@ void Map::Shutdown()
 		m_flashlightConstants = nullptr;
 	}
 
-	for (int actorIndex = 0; actorIndex < m_allActors.size(); actorIndex++)
+	if (m_voiceManager != nullptr)
 	{
-		Actor*& actor = m_allActors[actorIndex];
+		m_voiceManager->Shutdown();
+		delete m_voiceManager;
+		m_voiceManager = nullptr;
+	}
 
-		if (actor != nullptr)
-		{
-			delete actor;
-			actor = nullptr;
-		}
+	if (m_effectSystem != nullptr)
+	{
+		delete m_effectSystem;
+		m_effectSystem = nullptr;
+	}
+
+	if (m_commandBuffer != nullptr)
+	{
+		delete m_commandBuffer;
+		m_commandBuffer = nullptr;
+	}
+
+	if (m_projectileSystem != nullptr)
+	{
+		delete m_projectileSystem;
+		m_projectileSystem = nullptr;
+	}
+
+	for (int actorIndex = 0; actorIndex < m_liveActors.size(); actorIndex++)
+	{
+		delete m_liveActors[actorIndex];
+	}
+	m_liveActors.clear();
+	for (int archetypeMask = 0; archetypeMask < ACTOR_ARCHETYPE_COUNT; archetypeMask++)
+	{
+		m_archetypeActors[archetypeMask].clear();
 	}
+	m_allActors.assign(m_allActors.size(), nullptr);
+	m_liveActorIndexes.assign(m_liveActorIndexes.size(), -1);
 
 	for (int playerIndex = 0; playerIndex < m_players.size(); playerIndex++)
 	{
@@ -398,545 +646,2258 @@ void Map::Shutdown()
 //
 void Map::DeleteDestroyedActors()
 {
-	for (int actorIndex = 0; actorIndex < m_allActors.size(); actorIndex++)
+	//walk backward so the actor swapped into a hole has already been checked
+	for (int liveIndex = static_cast<int>(m_liveActors.size()) - 1; liveIndex >= 0; liveIndex--)
 	{
-		Actor*& actor = m_allActors[actorIndex];
-		if (actor != nullptr && actor->m_isGarbage)
+		Actor* actor = m_liveActors[liveIndex];
+		if (!actor->m_isGarbage)
 		{
-			delete actor;
-			if (m_currentPlayerActors[0] == actor)
-			{
-				m_currentPlayerActors[0] = nullptr;
-			}
-			if (m_currentPlayerActors[1] == actor)
+			continue;
+		}
+
+		int actorIndex = static_cast<int>(actor->m_UID.GetIndex());
+		IncrementPerfCounter(PerfCounter::ACTOR_DELETES);
+		RemoveLiveActor(actorIndex);
+		m_allActors[actorIndex] = nullptr;
+		m_actorGenerations[actorIndex]++;	//every handle to the old actor goes stale
+		for (int playerIndex = 0; playerIndex < m_currentPlayerActors.size(); playerIndex++)
+		{
+			if (m_currentPlayerActors[playerIndex] == actor)
 			{
-				m_currentPlayerActors[1] = nullptr;
+				m_currentPlayerActors[playerIndex] = nullptr;
 			}
-			actor = nullptr;
 		}
+		delete actor;
 	}
 }
 
 
-Actor* Map::SpawnPlayer(int playerIndex)
+ActorUID Map::AllocateActorUID()
 {
-	if (playerIndex >= m_players.size())
+	//reuse the first empty slot at its current generation, growing the list only when there isn't one
+	for (int actorIndex = 0; actorIndex < m_allActors.size(); actorIndex++)
 	{
-		return nullptr;
+		if (m_allActors[actorIndex] == nullptr)
+		{
+			return ActorUID(actorIndex, m_actorGenerations[actorIndex]);
+		}
 	}
 
-	int spawnPointIndex;
+	m_allActors.push_back(nullptr);
+	m_actorGenerations.push_back(0);
+	m_liveActorIndexes.push_back(-1);
+	return ActorUID(static_cast<unsigned int>(m_allActors.size()) - 1, 0);
+}
 
-	do 
+
+void Map::SortLiveActors(bool isSpatialOrder)
+{
+	PROFILE_SCOPE("Map::SortLiveActors");
+
+	//only the update order changes, slots and generations stay put so every handle stays valid
+	//the slot index in the low bits keeps keys unique, so the order never depends on the sort itself
+	m_actorSortEntries.resize(m_liveActors.size());
+	for (int liveIndex = 0; liveIndex < m_liveActors.size(); liveIndex++)
 	{
-		spawnPointIndex = g_rng.RollRandomIntInRange(0, static_cast<int>(m_allActors.size() - 1));
-	} while (m_allActors[spawnPointIndex] == nullptr || m_allActors[spawnPointIndex]->m_definition->m_name != "SpawnPoint");
+		Actor* actor = m_liveActors[liveIndex];
+		unsigned long long mortonCode = isSpatialOrder ? GetMortonCodeFromCoords(GetClampedCoordsFromPosition(actor->m_position)) : 0;
+		m_actorSortEntries[liveIndex].m_sortKey = (mortonCode << 32) | actor->m_UID.GetIndex();
+		m_actorSortEntries[liveIndex].m_actor = actor;
+	}
 
-	if (m_owner->m_isLightsOutMode)
+	std::sort(m_actorSortEntries.begin(), m_actorSortEntries.end(), [](ActorSortEntry const& entryA, ActorSortEntry const& entryB)
 	{
-		m_currentPlayerActors[playerIndex] = SpawnActor("FlashlightMarine", m_allActors[spawnPointIndex]->m_position, m_allActors[spawnPointIndex]->m_orientation);
+		return entryA.m_sortKey < entryB.m_sortKey;
+	});
+
+	for (int archetypeMask = 0; archetypeMask < ACTOR_ARCHETYPE_COUNT; archetypeMask++)
+	{
+		m_archetypeActors[archetypeMask].clear();
 	}
-	else
+
+	//archetype lists are rebuilt in the same order, they're what collision and ai actually walk
+	for (int liveIndex = 0; liveIndex < m_actorSortEntries.size(); liveIndex++)
 	{
-		m_currentPlayerActors[playerIndex] = SpawnActor("Marine", m_allActors[spawnPointIndex]->m_position, m_allActors[spawnPointIndex]->m_orientation);
+		Actor* actor = m_actorSortEntries[liveIndex].m_actor;
+		m_liveActors[liveIndex] = actor;
+		m_liveActorIndexes[actor->m_UID.GetIndex()] = liveIndex;
+
+		std::vector<Actor*>& archetypeActors = m_archetypeActors[actor->m_archetypeMask];
+		actor->m_archetypeListIndex = static_cast<int>(archetypeActors.size());
+		archetypeActors.push_back(actor);
 	}
-	m_players[playerIndex]->Possess(m_currentPlayerActors[playerIndex]->m_UID);
-	return m_currentPlayerActors[playerIndex];
 }
 
 
-Actor* Map::SpawnActor(std::string actorDefName, Vec3 const& position, EulerAngles const& orientation, Vec3 const& velocity)
+float Map::GetLiveActorOrderSpread() const
 {
-	ActorDefinition const* definition = ActorDefinition::GetActorDefinition(actorDefName);
+	if (m_liveActors.size() < 2)
+	{
+		return 0.0f;
+	}
 
-	if (definition != nullptr)
+	//how far apart actors that update back to back are, the lower it is the more neighbor data is still in cache
+	float totalDistance = 0.0f;
+	for (int liveIndex = 1; liveIndex < m_liveActors.size(); liveIndex++)
 	{
-		//loop through actor list to find empty slot
-		for (int actorIndex = 0; actorIndex < m_allActors.size(); actorIndex++)
+		Vec3 const& previousPosition = m_liveActors[liveIndex - 1]->m_position;
+		Vec3 const& position = m_liveActors[liveIndex]->m_position;
+		totalDistance += GetDistance2D(Vec2(previousPosition.x, previousPosition.y), Vec2(position.x, position.y));
+	}
+
+	return totalDistance / static_cast<float>(m_liveActors.size() - 1);
+}
+
+
+void Map::AddLiveActor(int actorIndex)
+{
+	Actor* actor = m_allActors[actorIndex];
+	m_liveActorIndexes[actorIndex] = static_cast<int>(m_liveActors.size());
+	m_liveActors.push_back(actor);
+
+	std::vector<Actor*>& archetypeActors = m_archetypeActors[actor->m_archetypeMask];
+	actor->m_archetypeListIndex = static_cast<int>(archetypeActors.size());
+	archetypeActors.push_back(actor);
+}
+
+
+void Map::RemoveLiveActor(int actorIndex)
+{
+	//the last live actor moves into the hole so the list stays packed
+	int liveIndex = m_liveActorIndexes[actorIndex];
+	Actor* lastActor = m_liveActors.back();
+	m_liveActors[liveIndex] = lastActor;
+	m_liveActorIndexes[lastActor->m_UID.GetIndex()] = liveIndex;
+	m_liveActors.pop_back();
+	m_liveActorIndexes[actorIndex] = -1;
+
+	//same for the actor's archetype list
+	Actor* actor = m_allActors[actorIndex];
+	std::vector<Actor*>& archetypeActors = m_archetypeActors[actor->m_archetypeMask];
+	Actor* lastArchetypeActor = archetypeActors.back();
+	archetypeActors[actor->m_archetypeListIndex] = lastArchetypeActor;
+	lastArchetypeActor->m_archetypeListIndex = actor->m_archetypeListIndex;
+	archetypeActors.pop_back();
+	actor->m_archetypeListIndex = -1;
+}
+
+
+void Map::BuildSystemArchetypeMasks()
+{
+	//what each system needs set and needs clear, projectiles are moved and collided by the projectile system instead
+	unsigned int requiredFlags[(int)ActorSystem::COUNT] = {};
+	unsigned int excludedFlags[(int)ActorSystem::COUNT] = {};
+	requiredFlags[(int)ActorSystem::AI] = ACTOR_ARCHETYPE_AI_ENABLED;
+	requiredFlags[(int)ActorSystem::PHYSICS] = ACTOR_ARCHETYPE_SIMULATED;
+	excludedFlags[(int)ActorSystem::PHYSICS] = ACTOR_ARCHETYPE_PROJECTILE;
+	requiredFlags[(int)ActorSystem::MAP_COLLISION] = ACTOR_ARCHETYPE_COLLIDE_WITH_WORLD;
+	excludedFlags[(int)ActorSystem::MAP_COLLISION] = ACTOR_ARCHETYPE_PROJECTILE;
+	requiredFlags[(int)ActorSystem::ACTOR_COLLISION] = ACTOR_ARCHETYPE_COLLIDE_WITH_ACTORS;
+	excludedFlags[(int)ActorSystem::ACTOR_COLLISION] = ACTOR_ARCHETYPE_PROJECTILE;
+	requiredFlags[(int)ActorSystem::RENDER] = ACTOR_ARCHETYPE_VISIBLE;
+
+	for (int systemIndex = 0; systemIndex < (int)ActorSystem::COUNT; systemIndex++)
+	{
+		m_systemArchetypeMasks[systemIndex].clear();
+		for (int archetypeMask = 0; archetypeMask < ACTOR_ARCHETYPE_COUNT; archetypeMask++)
 		{
-			if (m_allActors[actorIndex] == nullptr)
+			if ((archetypeMask & requiredFlags[systemIndex]) == requiredFlags[systemIndex] && (archetypeMask & excludedFlags[systemIndex]) == 0)
 			{
-				ActorUID nextUID = ActorUID(actorIndex, m_actorSalt);
-				Actor* newActor = new Actor(nextUID, definition, this, position, orientation, velocity);
-				m_allActors[actorIndex] = newActor;
-				newActor->Startup();
-				m_actorSalt++;
-				return newActor;
+				m_systemArchetypeMasks[systemIndex].push_back(archetypeMask);
 			}
-
 		}
-
-		//only get here if there were no empty spaces
-		ActorUID nextUID = ActorUID(static_cast<int>(m_allActors.size()), m_actorSalt);
-		Actor* newActor = new Actor(nextUID, definition, this, position, orientation, velocity);
-		m_allActors.push_back(newActor);
-		newActor->Startup();
-		m_actorSalt++;
-		return newActor;
 	}
-
-	return nullptr;
 }
 
 
-Actor* Map::SpawnProjectile(std::string projectileDefName, Vec3 const& position, EulerAngles const& orientation, Vec3 const& velocity, Actor* projectileOwner)
+void Map::UpdateActorAI(float deltaSeconds)
 {
-	ActorDefinition const* definition = ActorDefinition::GetProjectileActorDefinition(projectileDefName);
+	PROFILE_SCOPE("Map::UpdateActorAI");
 
-	if (definition != nullptr)
+	std::vector<int> const& aiArchetypeMasks = m_systemArchetypeMasks[(int)ActorSystem::AI];
+	for (int maskIndex = 0; maskIndex < aiArchetypeMasks.size(); maskIndex++)
 	{
-		//loop through actor list to find empty slot
-		for (int actorIndex = 0; actorIndex < m_allActors.size(); actorIndex++)
+		std::vector<Actor*> const& actors = m_archetypeActors[aiArchetypeMasks[maskIndex]];
+		for (int actorIndex = 0; actorIndex < actors.size(); actorIndex++)
 		{
-			if (m_allActors[actorIndex] == nullptr)
+			//a possessed actor keeps its ai controller but doesn't run it
+			Actor* actor = actors[actorIndex];
+			if (actor->m_currentController == actor->m_AIController)
 			{
-				ActorUID nextUID = ActorUID(actorIndex, m_actorSalt);
-				Actor* newActor = new Actor(nextUID, definition, this, position, orientation, velocity);
-				newActor->m_projectileOwner = projectileOwner;
-				m_allActors.push_back(newActor);
-				newActor->Startup();
-				m_actorSalt++;
-				return newActor;
+				actor->m_AIController->Update(deltaSeconds);
 			}
-
 		}
-
-		//only get here if there were no empty spaces
-		ActorUID nextUID = ActorUID(static_cast<int>(m_allActors.size()), m_actorSalt);
-		Actor* newActor = new Actor(nextUID, definition, this, position, orientation, velocity);
-		newActor->m_projectileOwner = projectileOwner;
-		m_allActors.push_back(newActor);
-		newActor->Startup();
-		m_actorSalt++;
-		return newActor;
 	}
-
-	return nullptr;
 }
 
 
-//
-//public collision functions
-//
-void Map::CollideAllActorsWithEachOther()
+void Map::UpdateActorPhysics(float deltaSeconds)
 {
-	for (int actorIndexA = 0; actorIndexA < m_allActors.size(); actorIndexA++)
+	PROFILE_SCOPE("Map::UpdateActorPhysics");
+
+	std::vector<int> const& physicsArchetypeMasks = m_systemArchetypeMasks[(int)ActorSystem::PHYSICS];
+	for (int maskIndex = 0; maskIndex < physicsArchetypeMasks.size(); maskIndex++)
 	{
-		for (int actorIndexB = actorIndexA + 1; actorIndexB < m_allActors.size(); actorIndexB++)
+		std::vector<Actor*> const& actors = m_archetypeActors[physicsArchetypeMasks[maskIndex]];
+		for (int actorIndex = 0; actorIndex < actors.size(); actorIndex++)
 		{
-			Actor*& actorA = m_allActors[actorIndexA];
-			Actor*& actorB = m_allActors[actorIndexB];
+			Actor* actor = actors[actorIndex];
+
+			//counted here rather than in map collision so sleepers that ignore the walls still show up
+			if (actor->m_isSleeping)
+			{
+				IncrementPerfCounter(PerfCounter::SLEEPING_ACTORS);
+				continue;
+			}
 
-			if (actorA != nullptr && actorA->m_definition->m_collideWithActors && actorA->m_health > 0 && actorB != nullptr && actorB->m_definition->m_collideWithActors && actorB->m_health > 0)
+			if (actor->m_health > 0)
 			{
-				CollideActorsWithEachOther(actorA, actorB);
+				actor->UpdatePhysics(deltaSeconds);
 			}
 		}
 	}
 }
 
 
-void Map::CollideActorsWithEachOther(Actor* actorA, Actor* actorB)
+Actor* Map::SpawnPlayer(int playerIndex)
 {
-	//return if not overlapping on z axis
-	Vec3& posA = actorA->m_position;
-	Vec3& posB = actorB->m_position;
-	float radiusA = actorA->m_physicsRadius;
-	float radiusB = actorB->m_physicsRadius;
-	float heightA = actorA->m_physicsHeight;
-	float heightB = actorB->m_physicsHeight;
-
-	FloatRange actorARange = FloatRange(posA.z, posA.z + heightA);
-	FloatRange actorBRange = FloatRange(posB.z, posB.z + heightB);
-	if (!actorARange.IsOverlappingWith(actorBRange))
+	if (playerIndex >= m_players.size())
 	{
-		return;
+		return nullptr;
 	}
 
-	if (actorA == actorB->m_projectileOwner || actorB == actorA->m_projectileOwner)
+	int spawnPointIndex;
+
+	do 
 	{
-		return;
+		spawnPointIndex = g_rng.RollRandomIntInRange(0, static_cast<int>(m_allActors.size() - 1));
+	} while (m_allActors[spawnPointIndex] == nullptr || m_allActors[spawnPointIndex]->m_definition->m_name != "SpawnPoint");
+
+	if (m_owner->m_isLightsOutMode)
+	{
+		m_currentPlayerActors[playerIndex] = SpawnActor("FlashlightMarine", m_allActors[spawnPointIndex]->m_position, m_allActors[spawnPointIndex]->m_orientation);
 	}
-	
-	if (actorA->m_isStatic && actorB->m_isStatic)
+	else
 	{
-		return;
+		m_currentPlayerActors[playerIndex] = SpawnActor("Marine", m_allActors[spawnPointIndex]->m_position, m_allActors[spawnPointIndex]->m_orientation);
 	}
-	else if (actorA->m_isStatic && !actorB->m_isStatic)
+	m_players[playerIndex]->Possess(m_currentPlayerActors[playerIndex]->m_UID);
+	return m_currentPlayerActors[playerIndex];
+}
+
+
+Actor* Map::SpawnActor(std::string const& actorDefName, Vec3 const& position, EulerAngles const& orientation, Vec3 const& velocity)
+{
+	ActorDefinition const* definition = ActorDefinition::GetActorDefinition(actorDefName);
+
+	if (definition != nullptr)
+	{
+		ActorUID nextUID = AllocateActorUID();
+		Actor* newActor = new Actor(nextUID, definition, this, position, orientation, velocity);
+		m_allActors[nextUID.GetIndex()] = newActor;
+		AddLiveActor(nextUID.GetIndex());
+		m_unbucketedActorIndexes.push_back(nextUID.GetIndex());
+		newActor->Startup();
+		IncrementPerfCounter(PerfCounter::ACTOR_SPAWNS);
+		return newActor;
+	}
+
+	return nullptr;
+}
+
+
+Actor* Map::SpawnProjectile(std::string const& projectileDefName, Vec3 const& position, EulerAngles const& orientation, Vec3 const& velocity, ActorUID projectileOwnerUID)
+{
+	ActorDefinition const* definition = ActorDefinition::GetProjectileActorDefinition(projectileDefName);
+
+	if (definition != nullptr)
 	{
-		bool didCollide = PushDiscOutOfFixedDisc2D(posB, radiusB, posA, radiusA);
-		if (didCollide)
+		ActorUID nextUID = AllocateActorUID();
+		Actor* newActor = new Actor(nextUID, definition, this, position, orientation, velocity);
+		newActor->m_projectileOwnerUID = projectileOwnerUID;
+		m_allActors[nextUID.GetIndex()] = newActor;
+		AddLiveActor(nextUID.GetIndex());
+		m_unbucketedActorIndexes.push_back(nextUID.GetIndex());
+		newActor->Startup();
+		if (newActor->m_health > 0)
 		{
-			actorA->OnCollideWithActor(actorB);
-			actorB->OnCollideWithActor(actorA);
+			m_projectileSystem->AddProjectile(newActor);
 		}
+		IncrementPerfCounter(PerfCounter::ACTOR_SPAWNS);
+		return newActor;
 	}
-	else if (!actorA->m_isStatic && actorB->m_isStatic)
+
+	return nullptr;
+}
+
+
+void Map::SpawnEffect(std::string const& effectDefName, Vec3 const& position)
+{
+	//anything without an effect definition still spawns as a regular actor
+	if (!m_effectSystem->SpawnEffect(effectDefName, position))
+	{
+		SpawnActor(effectDefName, position, EulerAngles());
+	}
+}
+
+
+void Map::SpawnEffect(int effectDefIndex, Vec3 const& position)
+{
+	m_effectSystem->SpawnEffect(effectDefIndex, position);
+}
+
+
+int Map::AddRemotePlayer(int xboxID)
+{
+	//remote players go after the local split screen players, reusing any slot a disconnected player left behind
+	int playerIndex = -1;
+	for (int slotIndex = m_numPlayers; slotIndex < m_players.size(); slotIndex++)
 	{
-		bool didCollide = PushDiscOutOfFixedDisc2D(posA, radiusA, posB, radiusB);
-		if (didCollide)
+		if (m_players[slotIndex] == nullptr)
 		{
-			actorA->OnCollideWithActor(actorB);
-			actorB->OnCollideWithActor(actorA);
+			playerIndex = slotIndex;
+			break;
 		}
 	}
-	else
+
+	if (playerIndex == -1)
 	{
-		bool didCollide = PushDiscsOutOfEachOther2D(posA, radiusA, posB, radiusB);
-		if (didCollide)
+		if (m_players.size() >= m_maxPlayers)
 		{
-			actorA->OnCollideWithActor(actorB);
-			actorB->OnCollideWithActor(actorA);
+			return -1;
 		}
+
+		playerIndex = static_cast<int>(m_players.size());
+		m_players.push_back(nullptr);
+		m_currentPlayerActors.push_back(nullptr);
+		m_playerFlowFields.push_back(FlowField(this));
 	}
+
+	m_players[playerIndex] = new Player(m_owner, this, playerIndex, xboxID);
+	m_players[playerIndex]->m_isRemote = true;
+	SpawnPlayer(playerIndex);
+	return playerIndex;
 }
 
 
-void Map::CollideAllActorsWithMap()
+void Map::RemovePlayer(int playerIndex)
 {
-	for (int actorIndex = 0; actorIndex < m_allActors.size(); actorIndex++)
+	if (playerIndex < 0 || playerIndex >= m_players.size() || m_players[playerIndex] == nullptr)
 	{
-		Actor*& actor = m_allActors[actorIndex];
+		return;
+	}
 
-		if (actor != nullptr && actor->m_definition->m_collideWithWorld && actor->m_health > 0)
-		{
-			CollideActorWithMap(actor);
-		}
+	if (m_currentPlayerActors[playerIndex] != nullptr)
+	{
+		m_currentPlayerActors[playerIndex]->m_isGarbage = true;
+		m_currentPlayerActors[playerIndex]->m_currentController = nullptr;
+		m_currentPlayerActors[playerIndex] = nullptr;
 	}
+
+	m_playerFlowFields[playerIndex].m_goalCoords = IntVec2(-1, -1);
+
+	delete m_players[playerIndex];
+	m_players[playerIndex] = nullptr;
 }
 
 
-void Map::CollideActorWithMap(Actor* actor)
+Actor* Map::SpawnActorAtSlot(ActorUID uid, ActorDefinition const* definition, Vec3 const& position, EulerAngles const& orientation)
 {
-	//push out of all 8 neighboring walls
-	int tileID = GetTileIDFromPosition(actor->m_position);
-
-	CollideActorWithTile(actor, &m_tiles[tileID + m_dimensions.x]);
-	CollideActorWithTile(actor, &m_tiles[tileID + 1]);
-	CollideActorWithTile(actor, &m_tiles[tileID - m_dimensions.x]);
-	CollideActorWithTile(actor, &m_tiles[tileID - 1]);
-	CollideActorWithTile(actor, &m_tiles[tileID + m_dimensions.x + 1]);
-	CollideActorWithTile(actor, &m_tiles[tileID - m_dimensions.x + 1]);
-	CollideActorWithTile(actor, &m_tiles[tileID - m_dimensions.x - 1]);
-	CollideActorWithTile(actor, &m_tiles[tileID + m_dimensions.x - 1]);
+	//replicated actors have to live at the slot their uid names, replacing whatever was there
+	int actorIndex = static_cast<int>(uid.GetIndex());
+	if (actorIndex >= m_allActors.size())
+	{
+		m_allActors.resize(actorIndex + 1, nullptr);
+		m_actorGenerations.resize(actorIndex + 1, 0);
+		m_liveActorIndexes.resize(actorIndex + 1, -1);
+	}
 
-	//push out of floor/ceiling
-	if (actor->m_position.z < 0.0f)
+	Actor*& actor = m_allActors[actorIndex];
+	if (actor != nullptr)
 	{
-		actor->m_position.z = 0.0f;
-		actor->OnCollide();
+		actor->m_isGarbage = true;
+		DeleteDestroyedActors();
 	}
-	if (actor->m_position.z + actor->m_physicsHeight > 1.0f)
+	m_actorGenerations[actorIndex] = uid.GetGeneration();
+
+	actor = new Actor(uid, definition, this, position, orientation);
+	AddLiveActor(actorIndex);
+	m_unbucketedActorIndexes.push_back(actorIndex);
+	actor->Startup();
+	IncrementPerfCounter(PerfCounter::ACTOR_SPAWNS);
+	return actor;
+}
+
+
+void Map::DeleteAllActors()
+{
+	for (int actorIndex = 0; actorIndex < m_liveActors.size(); actorIndex++)
 	{
-		actor->m_position.z = 1.0f - actor->m_physicsHeight;
-		actor->OnCollide();
+		m_liveActors[actorIndex]->m_isGarbage = true;
 	}
+
+	DeleteDestroyedActors();
+	RebuildActorBuckets();
+	m_projectileSystem->ClearProjectiles();
+
+	//queued commands point at the actors that were just deleted
+	m_commandBuffer->Clear();
 }
 
 
-void Map::CollideActorWithTile(Actor* actor, Tile const* tile)
+//
+//public collision functions
+//
+void Map::CollideAllActorsWithEachOther()
 {
-	if (tile != nullptr && tile->m_definition->m_isSolid)
+	PROFILE_SCOPE("Map::CollideAllActorsWithEachOther");
+
+	BuildActorCollisionCells();
+
+	//cells of one color never share an actor, so each color's cells run in parallel and the colors run one after another
+	for (int colorIndex = 0; colorIndex < ACTOR_COLLISION_CELL_COLORS; colorIndex++)
+	{
+		std::vector<int> const& colorCellIDs = m_actorCollisionColorCellIDs[colorIndex];
+		g_jobSystem.ParallelFor(static_cast<int>(colorCellIDs.size()), [this, &colorCellIDs](int jobIndex)
+		{
+			CollideActorsInCell(colorCellIDs[jobIndex]);
+		});
+	}
+
+	//callbacks roll the rng and queue commands, so they're replayed here in a fixed cell order no matter which thread found the contact
+	for (int colorIndex = 0; colorIndex < ACTOR_COLLISION_CELL_COLORS; colorIndex++)
 	{
-		bool didCollide = PushDiscOutOfFixedAABB2D(actor->m_position, actor->m_physicsRadius, tile->GetTileAABB2());
-		if (didCollide)
+		std::vector<int> const& colorCellIDs = m_actorCollisionColorCellIDs[colorIndex];
+		for (int colorCellIndex = 0; colorCellIndex < colorCellIDs.size(); colorCellIndex++)
 		{
-			actor->OnCollide();
+			ActorCollisionCell const& cell = m_actorCollisionCells[colorCellIDs[colorCellIndex]];
+			IncrementPerfCounter(PerfCounter::COLLISION_PAIRS_TESTED, cell.m_numPairsTested);
+
+			for (int contactIndex = 0; contactIndex < cell.m_contacts.size(); contactIndex++)
+			{
+				Actor* actorA = cell.m_contacts[contactIndex].m_actorA;
+				Actor* actorB = cell.m_contacts[contactIndex].m_actorB;
+				IncrementPerfCounter(PerfCounter::COLLISION_PAIRS_COLLIDED);
+				actorA->WakeUp();
+				actorB->WakeUp();
+				actorA->OnCollideWithActor(actorB);
+				actorB->OnCollideWithActor(actorA);
+			}
 		}
 	}
 }
 
 
-//
-//public raycast functions
-//
-RaycastResultGame Map::RaycastAgainstAll(Vec3 const& startPosition, Vec3 const& directionNormal, float distance, Actor* owner)
+void Map::BuildActorCollisionCells()
 {
-	RaycastResultGame raycastResultActors = RaycastAgainstActors(startPosition, directionNormal, distance, owner);
-	RaycastResult3D raycastResultWorldXY = RaycastAgainstTilesXY(startPosition, directionNormal, distance);
-	RaycastResult3D raycastResultWorldZ = RaycastAgainstTilesZ(startPosition, directionNormal, distance);
+	//projectiles sweep against everyone in the projectile system, so they stay out of the cells
+	m_collidingActors.clear();
+	float maxPhysicsRadius = 0.0f;
+	bool isAnyActorAwake = false;
+	std::vector<int> const& collisionArchetypeMasks = m_systemArchetypeMasks[(int)ActorSystem::ACTOR_COLLISION];
+	for (int maskIndex = 0; maskIndex < collisionArchetypeMasks.size(); maskIndex++)
+	{
+		std::vector<Actor*> const& actors = m_archetypeActors[collisionArchetypeMasks[maskIndex]];
+		for (int actorIndex = 0; actorIndex < actors.size(); actorIndex++)
+		{
+			Actor* actor = actors[actorIndex];
+			if (actor->m_health > 0)
+			{
+				m_collidingActors.push_back(actor);
+				maxPhysicsRadius = actor->m_physicsRadius > maxPhysicsRadius ? actor->m_physicsRadius : maxPhysicsRadius;
+				isAnyActorAwake = isAnyActorAwake || !actor->m_isSleeping;
+			}
+		}
+	}
 
-	RaycastResultGame raycastResult;
-	raycastResult.m_raycastResult.m_impactDist = distance + 1.0f;
-	if (raycastResultActors.m_raycastResult.m_didImpact && raycastResultActors.m_raycastResult.m_impactDist < raycastResult.m_raycastResult.m_impactDist && IsPositionInBounds(raycastResultActors.m_raycastResult.m_impactPos))
+	for (int colorIndex = 0; colorIndex < ACTOR_COLLISION_CELL_COLORS; colorIndex++)
 	{
-		raycastResult = raycastResultActors;
+		m_actorCollisionColorCellIDs[colorIndex].clear();
 	}
-	if (raycastResultWorldXY.m_didImpact && raycastResultWorldXY.m_impactDist < raycastResult.m_raycastResult.m_impactDist && IsPositionInBounds(raycastResultWorldXY.m_impactPos))
+
+	//sleepers never collide with each other, so a fully resting map has nothing to do
+	if (!isAnyActorAwake)
 	{
-		raycastResult.m_raycastResult = raycastResultWorldXY;
-		raycastResult.m_actorHit = nullptr;
+		return;
 	}
-	if (raycastResultWorldZ.m_didImpact && raycastResultWorldZ.m_impactDist < raycastResult.m_raycastResult.m_impactDist && IsPositionInBounds(raycastResultWorldZ.m_impactPos))
+
+	//two touching discs are at most two of the widest radius apart, so they always share a cell or are direct neighbors
+	m_actorCollisionCellSize = 2.0f * maxPhysicsRadius > k_minActorCollisionCellSize ? 2.0f * maxPhysicsRadius : k_minActorCollisionCellSize;
+	m_actorCollisionCellDimensions.x = static_cast<int>(ceilf(static_cast<float>(m_dimensions.x) / m_actorCollisionCellSize));
+	m_actorCollisionCellDimensions.y = static_cast<int>(ceilf(static_cast<float>(m_dimensions.y) / m_actorCollisionCellSize));
+	int numCells = m_actorCollisionCellDimensions.x * m_actorCollisionCellDimensions.y;
+	m_actorCollisionCells.resize(numCells);
+
+	//counting sort by cell in live order with each cell's awake actors ahead of its sleepers, which keeps the pair order deterministic
+	m_actorCollisionCellStarts.assign(numCells * 2 + 1, 0);
+	for (int actorIndex = 0; actorIndex < m_collidingActors.size(); actorIndex++)
 	{
-		raycastResult.m_raycastResult = raycastResultWorldZ;
-		raycastResult.m_actorHit = nullptr;
+		Actor const* actor = m_collidingActors[actorIndex];
+		m_actorCollisionCellStarts[GetActorCollisionCellID(actor->m_position) * 2 + (actor->m_isSleeping ? 1 : 0) + 1]++;
 	}
-	
-	/*DebugAddWorldLine(startPosition, startPosition + (directionNormal * distance), 0.01f, 10.0f, Rgba8(), Rgba8(), DebugRenderMode::X_RAY);
 
-	if (raycastResult.m_raycastResult.m_didImpact)
+	for (int startIndex = 0; startIndex < numCells * 2; startIndex++)
 	{
-		DebugAddWorldSphere(raycastResult.m_raycastResult.m_impactPos, 0.06f, 10.0f);
-		DebugAddWorldArrow(raycastResult.m_raycastResult.m_impactPos, raycastResult.m_raycastResult.m_impactPos + (raycastResult.m_raycastResult.m_impactNormal * 0.3f), 0.03f, 10.0f, Rgba8(0, 0, 255), Rgba8(0, 0, 255));
-	}*/
-	
-	return raycastResult;
+		m_actorCollisionCellStarts[startIndex + 1] += m_actorCollisionCellStarts[startIndex];
+	}
+
+	m_actorCollisionCellActors.resize(m_collidingActors.size());
+	m_actorCollisionCellFillIndexes.assign(m_actorCollisionCellStarts.begin(), m_actorCollisionCellStarts.end() - 1);
+	for (int actorIndex = 0; actorIndex < m_collidingActors.size(); actorIndex++)
+	{
+		Actor* actor = m_collidingActors[actorIndex];
+		int startIndex = GetActorCollisionCellID(actor->m_position) * 2 + (actor->m_isSleeping ? 1 : 0);
+		m_actorCollisionCellActors[m_actorCollisionCellFillIndexes[startIndex]] = actor;
+		m_actorCollisionCellFillIndexes[startIndex]++;
+	}
+
+	//a cell only has work if it or a forward neighbor has someone awake in it
+	for (int cellY = 0; cellY < m_actorCollisionCellDimensions.y; cellY++)
+	{
+		for (int cellX = 0; cellX < m_actorCollisionCellDimensions.x; cellX++)
+		{
+			int cellID = cellX + cellY * m_actorCollisionCellDimensions.x;
+			if (m_actorCollisionCellStarts[cellID * 2] == m_actorCollisionCellStarts[cellID * 2 + 2])
+			{
+				continue;
+			}
+
+			bool hasAwakeActors = m_actorCollisionCellStarts[cellID * 2] != m_actorCollisionCellStarts[cellID * 2 + 1];
+			for (int neighborIndex = 0; neighborIndex < 4 && !hasAwakeActors; neighborIndex++)
+			{
+				int neighborX = cellX + k_forwardCollisionCellOffsets[neighborIndex].x;
+				int neighborY = cellY + k_forwardCollisionCellOffsets[neighborIndex].y;
+				if (neighborX >= 0 && neighborX < m_actorCollisionCellDimensions.x && neighborY < m_actorCollisionCellDimensions.y)
+				{
+					int neighborID = neighborX + neighborY * m_actorCollisionCellDimensions.x;
+					hasAwakeActors = m_actorCollisionCellStarts[neighborID * 2] != m_actorCollisionCellStarts[neighborID * 2 + 1];
+				}
+			}
+
+			if (hasAwakeActors)
+			{
+				m_actorCollisionColorCellIDs[(cellX % 3) + (cellY % 2) * 3].push_back(cellID);
+			}
+		}
+	}
 }
 
 
-RaycastResultGame Map::RaycastAgainstActors(Vec3 const& startPosition, Vec3 const& directionNormal, float distance, Actor* owner)
+void Map::CollideActorsInCell(int cellID)
 {
-	RaycastResultGame raycastResult;
-	raycastResult.m_raycastResult.m_impactDist = distance + 1.0f;
-	raycastResult.m_owner = owner;
+	ActorCollisionCell& cell = m_actorCollisionCells[cellID];
+	cell.m_contacts.clear();
+	cell.m_numPairsTested = 0;
 
-	for (int actorIndex = 0; actorIndex < m_allActors.size(); actorIndex++)
+	int cellX = cellID % m_actorCollisionCellDimensions.x;
+	int cellY = cellID / m_actorCollisionCellDimensions.x;
+	int awakeStart = m_actorCollisionCellStarts[cellID * 2];
+	int sleeperStart = m_actorCollisionCellStarts[cellID * 2 + 1];
+	int cellEnd = m_actorCollisionCellStarts[cellID * 2 + 2];
+
+	//awake actors against everyone after them in their own cell
+	for (int actorIndexA = awakeStart; actorIndexA < sleeperStart; actorIndexA++)
 	{
-		Actor* actor = m_allActors[actorIndex];
-		if (actor != nullptr && actor != raycastResult.m_owner && actor->m_health > 0)
+		for (int actorIndexB = actorIndexA + 1; actorIndexB < cellEnd; actorIndexB++)
 		{
-			Vec3 actorPos = actor->m_position;
-			RaycastResult3D raycastResultActor = RaycastVsZCylinder3D(startPosition, directionNormal, distance, actorPos, actorPos.z, actorPos.z + actor->m_physicsHeight, actor->m_physicsRadius);
+			CollideActorPairInCell(cell, m_actorCollisionCellActors[actorIndexA], m_actorCollisionCellActors[actorIndexB]);
+		}
+	}
 
-			//if raycast hit, has shorter distance than previously saved raycast, and is within bounds, save this one instead
-			if (raycastResultActor.m_didImpact && raycastResultActor.m_impactDist < raycastResult.m_raycastResult.m_impactDist && IsPositionInBounds(raycastResultActor.m_impactPos))
+	//then against the forward neighbors, so each pair of neighboring cells is only checked from one side
+	for (int neighborIndex = 0; neighborIndex < 4; neighborIndex++)
+	{
+		int neighborX = cellX + k_forwardCollisionCellOffsets[neighborIndex].x;
+		int neighborY = cellY + k_forwardCollisionCellOffsets[neighborIndex].y;
+		if (neighborX < 0 || neighborX >= m_actorCollisionCellDimensions.x || neighborY >= m_actorCollisionCellDimensions.y)
+		{
+			continue;
+		}
+
+		int neighborID = neighborX + neighborY * m_actorCollisionCellDimensions.x;
+		int neighborAwakeStart = m_actorCollisionCellStarts[neighborID * 2];
+		int neighborSleeperStart = m_actorCollisionCellStarts[neighborID * 2 + 1];
+		int neighborEnd = m_actorCollisionCellStarts[neighborID * 2 + 2];
+
+		for (int actorIndexA = awakeStart; actorIndexA < cellEnd; actorIndexA++)
+		{
+			//sleepers here only need the neighbor's awake actors
+			int actorEndB = actorIndexA < sleeperStart ? neighborEnd : neighborSleeperStart;
+			for (int actorIndexB = neighborAwakeStart; actorIndexB < actorEndB; actorIndexB++)
 			{
-				raycastResult.m_raycastResult = raycastResultActor;
-				raycastResult.m_actorHit = actor;
+				CollideActorPairInCell(cell, m_actorCollisionCellActors[actorIndexA], m_actorCollisionCellActors[actorIndexB]);
 			}
 		}
 	}
+}
 
-	raycastResult.m_raycastResult.m_rayStartPosition = startPosition;
-	raycastResult.m_raycastResult.m_rayDirection = directionNormal;
-	raycastResult.m_raycastResult.m_rayLength = distance;
 
-	return raycastResult;
+void Map::CollideActorPairInCell(ActorCollisionCell& cell, Actor* actorA, Actor* actorB)
+{
+	cell.m_numPairsTested++;
+	if (CollideActorsWithEachOther(actorA, actorB))
+	{
+		ActorCollisionContact contact;
+		contact.m_actorA = actorA;
+		contact.m_actorB = actorB;
+		cell.m_contacts.push_back(contact);
+	}
 }
 
 
-RaycastResultGame Map::RaycastAgainstPlayers(Vec3 const& startPosition, Vec3 const& directionNormal, float distance, Actor* owner /*= nullptr*/)
+int Map::GetActorCollisionCellID(Vec3 const& position) const
 {
-	RaycastResultGame raycastResult;
-	raycastResult.m_raycastResult.m_impactDist = distance + 1.0f;
-	raycastResult.m_owner = owner;
+	int cellX = static_cast<int>(floorf(position.x / m_actorCollisionCellSize));
+	int cellY = static_cast<int>(floorf(position.y / m_actorCollisionCellSize));
+	cellX = GetClamped(cellX, 0, m_actorCollisionCellDimensions.x - 1);
+	cellY = GetClamped(cellY, 0, m_actorCollisionCellDimensions.y - 1);
+	return cellX + cellY * m_actorCollisionCellDimensions.x;
+}
 
-	for (int playerIndex = 0; playerIndex < m_players.size(); playerIndex++)
+
+bool Map::CollideActorsWithEachOther(Actor* actorA, Actor* actorB)
+{
+	//return if not overlapping on z axis
+	Vec3& posA = actorA->m_position;
+	Vec3& posB = actorB->m_position;
+	float radiusA = actorA->m_physicsRadius;
+	float radiusB = actorB->m_physicsRadius;
+	float heightA = actorA->m_physicsHeight;
+	float heightB = actorB->m_physicsHeight;
+
+	FloatRange actorARange = FloatRange(posA.z, posA.z + heightA);
+	FloatRange actorBRange = FloatRange(posB.z, posB.z + heightB);
+	if (!actorARange.IsOverlappingWith(actorBRange))
 	{
-		if (m_players[playerIndex] != nullptr)
+		return false;
+	}
+
+	if (actorA->m_UID.m_data == actorB->m_projectileOwnerUID.m_data || actorB->m_UID.m_data == actorA->m_projectileOwnerUID.m_data)
+	{
+		return false;
+	}
+	
+	if (actorA->m_isStatic && actorB->m_isStatic)
+	{
+		return false;
+	}
+	else if (actorA->m_isStatic && !actorB->m_isStatic)
+	{
+		return PushDiscOutOfFixedDisc2D(posB, radiusB, posA, radiusA);
+	}
+	else if (!actorA->m_isStatic && actorB->m_isStatic)
+	{
+		return PushDiscOutOfFixedDisc2D(posA, radiusA, posB, radiusB);
+	}
+	else
+	{
+		return PushDiscsOutOfEachOther2D(posA, radiusA, posB, radiusB);
+	}
+}
+
+
+void Map::CollideAllActorsWithMap()
+{
+	PROFILE_SCOPE("Map::CollideAllActorsWithMap");
+
+	m_mapCollidingActors.clear();
+	std::vector<int> const& collisionArchetypeMasks = m_systemArchetypeMasks[(int)ActorSystem::MAP_COLLISION];
+	for (int maskIndex = 0; maskIndex < collisionArchetypeMasks.size(); maskIndex++)
+	{
+		std::vector<Actor*> const& actors = m_archetypeActors[collisionArchetypeMasks[maskIndex]];
+		for (int actorIndex = 0; actorIndex < actors.size(); actorIndex++)
 		{
-			Actor* playerActor = m_players[playerIndex]->GetActor();
-			if (playerActor != nullptr && playerActor != raycastResult.m_owner && playerActor->m_health > 0)
+			Actor* actor = actors[actorIndex];
+
+			//sleepers were already pushed clear of the walls before they settled
+			if (actor->m_isSleeping)
 			{
-				Vec3 actorPos = playerActor->m_position;
-				RaycastResult3D raycastResultActor = RaycastVsZCylinder3D(startPosition, directionNormal, distance, actorPos, actorPos.z, actorPos.z + playerActor->m_physicsHeight, playerActor->m_physicsRadius);
+				continue;
+			}
 
-				//if raycast hit, has shorter distance than previously saved raycast, and is within bounds, save this one instead
-				if (raycastResultActor.m_didImpact && raycastResultActor.m_impactDist < raycastResult.m_raycastResult.m_impactDist && IsPositionInBounds(raycastResultActor.m_impactPos))
-				{
-					raycastResult.m_raycastResult = raycastResultActor;
-					raycastResult.m_actorHit = playerActor;
-				}
+			if (actor->m_health > 0)
+			{
+				m_mapCollidingActors.push_back(actor);
 			}
 		}
 	}
 
-	raycastResult.m_raycastResult.m_rayStartPosition = startPosition;
-	raycastResult.m_raycastResult.m_rayDirection = directionNormal;
-	raycastResult.m_raycastResult.m_rayLength = distance;
+	//each actor only touches itself and the read only tile grid, so fixed size chunks can go to any thread
+	int numChunks = (static_cast<int>(m_mapCollidingActors.size()) + k_mapCollisionChunkSize - 1) / k_mapCollisionChunkSize;
+	m_mapCollisionChunkPushoutTests.assign(numChunks, 0);
+	g_jobSystem.ParallelFor(numChunks, [this](int chunkIndex)
+	{
+		int startIndex = chunkIndex * k_mapCollisionChunkSize;
+		int endIndex = startIndex + k_mapCollisionChunkSize < m_mapCollidingActors.size() ? startIndex + k_mapCollisionChunkSize : static_cast<int>(m_mapCollidingActors.size());
+		for (int actorIndex = startIndex; actorIndex < endIndex; actorIndex++)
+		{
+			m_mapCollisionChunkPushoutTests[chunkIndex] += CollideActorWithMap(m_mapCollidingActors[actorIndex]);
+		}
+	});
 
-	return raycastResult;
+	for (int chunkIndex = 0; chunkIndex < numChunks; chunkIndex++)
+	{
+		IncrementPerfCounter(PerfCounter::TILE_PUSHOUT_TESTS, m_mapCollisionChunkPushoutTests[chunkIndex]);
+	}
+}
+
+
+int Map::CollideActorWithMap(Actor* actor)
+{
+	int tileX = static_cast<int>(floorf(actor->m_position.x));
+	int tileY = static_cast<int>(floorf(actor->m_position.y));
+	unsigned char solidMask = AreCoordsInBounds(tileX, tileY) ? m_tileNeighborSolidMasks[GetTileIDFromCoords(tileX, tileY)] : GetTileNeighborSolidMask(tileX, tileY);
+
+	//a disc that doesn't poke out of its own tile toward a solid side can't touch any wall, which is most actors in open rooms
+	float radius = actor->m_physicsRadius;
+	float localX = actor->m_position.x - static_cast<float>(tileX);
+	float localY = actor->m_position.y - static_cast<float>(tileY);
+	bool reachesNorth = localY + radius > 1.0f;
+	bool reachesEast = localX + radius > 1.0f;
+	bool reachesSouth = localY - radius < 0.0f;
+	bool reachesWest = localX - radius < 0.0f;
+	unsigned char reachMask = static_cast<unsigned char>((reachesNorth ? 0x01 : 0) | (reachesEast ? 0x02 : 0) | (reachesSouth ? 0x04 : 0) | (reachesWest ? 0x08 : 0)
+		| (reachesNorth && reachesEast ? 0x10 : 0) | (reachesSouth && reachesEast ? 0x20 : 0) | (reachesSouth && reachesWest ? 0x40 : 0) | (reachesNorth && reachesWest ? 0x80 : 0));
+
+	//push out of the solid neighbors only, the earlier pushes can move the disc so every solid neighbor still gets its exact test
+	int numPushoutTests = 0;
+	if ((solidMask & reachMask) != 0)
+	{
+		for (int neighborIndex = 0; neighborIndex < 8; neighborIndex++)
+		{
+			if ((solidMask & (1 << neighborIndex)) != 0)
+			{
+				float neighborMinX = static_cast<float>(tileX + k_neighborTileOffsets[neighborIndex].x);
+				float neighborMinY = static_cast<float>(tileY + k_neighborTileOffsets[neighborIndex].y);
+				CollideActorWithTile(actor, AABB2(neighborMinX, neighborMinY, neighborMinX + 1.0f, neighborMinY + 1.0f));
+				numPushoutTests++;
+			}
+		}
+	}
+
+	//push out of floor/ceiling
+	if (actor->m_position.z < 0.0f)
+	{
+		actor->m_position.z = 0.0f;
+		actor->OnCollide();
+	}
+	if (actor->m_position.z + actor->m_physicsHeight > 1.0f)
+	{
+		actor->m_position.z = 1.0f - actor->m_physicsHeight;
+		actor->OnCollide();
+	}
+
+	return numPushoutTests;
 }
 
 
-RaycastResult3D Map::RaycastAgainstTilesXY(Vec3 const& startPosition, Vec3 const& directionNormal, float distance) const
-{
-	RaycastResult3D raycastResult;
+void Map::CollideActorWithTile(Actor* actor, AABB2 const& tileBounds)
+{
+	bool didCollide = PushDiscOutOfFixedAABB2D(actor->m_position, actor->m_physicsRadius, tileBounds);
+	if (didCollide)
+	{
+		actor->OnCollide();
+	}
+}
+
+
+void Map::BuildCompactTileGrid(std::vector<Tile> const& tiles)
+{
+	GUARANTEE_OR_DIE(TileDefinition::s_tileDefinitions.size() < k_unknownTileType, "Too many tile definitions for one byte tile types!");
+
+	int numTiles = m_dimensions.x * m_dimensions.y;
+	m_tileTypes.assign(numTiles, k_unknownTileType);
+	m_solidTileBits.assign((numTiles + 31) / 32, 0xffffffff);
+
+	for (int tileIndex = 0; tileIndex < tiles.size(); tileIndex++)
+	{
+		Tile const& tile = tiles[tileIndex];
+		int tileID = GetTileIDFromCoords(tile.m_coords.x, tile.m_coords.y);
+		m_tileTypes[tileID] = static_cast<unsigned char>(tile.m_definition - TileDefinition::s_tileDefinitions.data());
+		if (!tile.m_definition->m_isSolid)
+		{
+			m_solidTileBits[tileID >> 5] &= ~(1u << (tileID & 31));
+		}
+	}
+}
+
+
+void Map::BuildTileNeighborSolidMasks()
+{
+	//tiles never change after load, so which neighbors are walls is worked out once
+	m_tileNeighborSolidMasks.resize(m_tileTypes.size());
+	for (int tileY = 0; tileY < m_dimensions.y; tileY++)
+	{
+		for (int tileX = 0; tileX < m_dimensions.x; tileX++)
+		{
+			m_tileNeighborSolidMasks[GetTileIDFromCoords(tileX, tileY)] = GetTileNeighborSolidMask(tileX, tileY);
+		}
+	}
+}
+
+
+unsigned char Map::GetTileNeighborSolidMask(int x, int y) const
+{
+	unsigned char solidMask = 0;
+	for (int neighborIndex = 0; neighborIndex < 8; neighborIndex++)
+	{
+		if (IsTileSolid(x + k_neighborTileOffsets[neighborIndex].x, y + k_neighborTileOffsets[neighborIndex].y))
+		{
+			solidMask |= static_cast<unsigned char>(1 << neighborIndex);
+		}
+	}
+
+	return solidMask;
+}
+
+
+//
+//public raycast functions
+//
+RaycastResultGame Map::Raycast(Vec3 const& startPosition, Vec3 const& directionNormal, float distance, RaycastFilter const& filter)
+{
+	PROFILE_SCOPE("Map::Raycast");
+
+	RaycastResultGame raycastResult;
+	raycastResult.m_raycastResult.m_impactDist = distance + 1.0f;
+
+	//walls and floors first, whatever they hit is as far as the actor search needs to go
+	float actorSearchDistance = distance;
+	if ((filter.m_layerMask & RAYCAST_LAYER_WALLS) != 0)
+	{
+		RaycastResult3D raycastResultWorldXY = RaycastAgainstTilesXY(startPosition, directionNormal, distance);
+		if (raycastResultWorldXY.m_didImpact && raycastResultWorldXY.m_impactDist < raycastResult.m_raycastResult.m_impactDist && IsPositionInBounds(raycastResultWorldXY.m_impactPos))
+		{
+			raycastResult.m_raycastResult = raycastResultWorldXY;
+			actorSearchDistance = raycastResultWorldXY.m_impactDist;
+		}
+	}
+	if ((filter.m_layerMask & RAYCAST_LAYER_FLOOR_AND_CEILING) != 0)
+	{
+		RaycastResult3D raycastResultWorldZ = RaycastAgainstTilesZ(startPosition, directionNormal, distance);
+		if (raycastResultWorldZ.m_didImpact && raycastResultWorldZ.m_impactDist < raycastResult.m_raycastResult.m_impactDist && IsPositionInBounds(raycastResultWorldZ.m_impactPos))
+		{
+			raycastResult.m_raycastResult = raycastResultWorldZ;
+			actorSearchDistance = raycastResultWorldZ.m_impactDist;
+		}
+	}
+
+	if ((filter.m_layerMask & RAYCAST_LAYER_ACTORS) != 0)
+	{
+		//players are few enough to check directly, everyone else comes from the buckets along the clipped ray
+		m_raycastCandidates.clear();
+		if (filter.m_isPlayersOnly)
+		{
+			for (int playerIndex = 0; playerIndex < m_players.size(); playerIndex++)
+			{
+				if (m_players[playerIndex] != nullptr && m_players[playerIndex]->GetActor() != nullptr)
+				{
+					m_raycastCandidates.push_back(m_players[playerIndex]->GetActor());
+				}
+			}
+		}
+		else
+		{
+			GetActorsAlongRay(startPosition, directionNormal, actorSearchDistance, k_raycastActorMargin, m_raycastCandidates);
+		}
+
+		//an actor touching the wall at the same distance still counts as hit, like it did when actors were cast first
+		float closestActorDistance = actorSearchDistance;
+		for (int candidateIndex = 0; candidateIndex < m_raycastCandidates.size(); candidateIndex++)
+		{
+			Actor* actor = m_raycastCandidates[candidateIndex];
+			if (!DoesActorPassRaycastFilter(actor, filter))
+			{
+				continue;
+			}
+
+			Vec3 actorPos = actor->m_position;
+			RaycastResult3D raycastResultActor = RaycastVsZCylinder3D(startPosition, directionNormal, actorSearchDistance, actorPos, actorPos.z, actorPos.z + actor->m_physicsHeight, actor->m_physicsRadius);
+			bool isCloser = raycastResult.m_actorHit == nullptr ? raycastResultActor.m_impactDist <= closestActorDistance : raycastResultActor.m_impactDist < closestActorDistance;
+			if (raycastResultActor.m_didImpact && isCloser && IsPositionInBounds(raycastResultActor.m_impactPos))
+			{
+				raycastResult.m_raycastResult = raycastResultActor;
+				raycastResult.m_actorHit = actor;
+				closestActorDistance = raycastResultActor.m_impactDist;
+			}
+		}
+	}
+
+	raycastResult.m_raycastResult.m_rayStartPosition = startPosition;
+	raycastResult.m_raycastResult.m_rayDirection = directionNormal;
+	raycastResult.m_raycastResult.m_rayLength = distance;
+
+	return raycastResult;
+}
+
+
+bool Map::DoesActorPassRaycastFilter(Actor const* actor, RaycastFilter const& filter) const
+{
+	if (filter.m_isAliveOnly && actor->m_health <= 0)
+	{
+		return false;
+	}
+
+	if ((filter.m_factionMask & (1u << static_cast<int>(actor->m_definition->m_faction))) == 0)
+	{
+		return false;
+	}
+
+	for (int ignoredIndex = 0; ignoredIndex < filter.m_numIgnoredActors; ignoredIndex++)
+	{
+		if (filter.m_ignoredActors[ignoredIndex] == actor)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+RaycastResultGame Map::RaycastAgainstAll(Vec3 const& startPosition, Vec3 const& directionNormal, float distance, Actor* owner)
+{
+	RaycastFilter filter;
+	filter.IgnoreActor(owner);
+
+	RaycastResultGame raycastResult = Raycast(startPosition, directionNormal, distance, filter);
+	raycastResult.m_owner = owner;
+	return raycastResult;
+}
+
+
+RaycastResultGame Map::RaycastAgainstActors(Vec3 const& startPosition, Vec3 const& directionNormal, float distance, Actor* owner)
+{
+	RaycastFilter filter;
+	filter.m_layerMask = RAYCAST_LAYER_ACTORS;
+	filter.IgnoreActor(owner);
+
+	RaycastResultGame raycastResult = Raycast(startPosition, directionNormal, distance, filter);
+	raycastResult.m_owner = owner;
+	return raycastResult;
+}
+
+
+RaycastResultGame Map::RaycastAgainstPlayers(Vec3 const& startPosition, Vec3 const& directionNormal, float distance, Actor* owner /*= nullptr*/)
+{
+	RaycastFilter filter;
+	filter.m_layerMask = RAYCAST_LAYER_ACTORS;
+	filter.m_isPlayersOnly = true;
+	filter.IgnoreActor(owner);
+
+	RaycastResultGame raycastResult = Raycast(startPosition, directionNormal, distance, filter);
+	raycastResult.m_owner = owner;
+	return raycastResult;
+}
+
+
+RaycastResult3D Map::RaycastAgainstTilesXY(Vec3 const& startPosition, Vec3 const& directionNormal, float distance) const
+{
+	IncrementPerfCounter(PerfCounter::RAYCASTS);
+
+	RaycastResult3D raycastResult;
+
+	Vec3 raycastVector = directionNormal * distance;
+
+	IntVec2 currentTileCoords = IntVec2(static_cast<int>(startPosition.x), static_cast<int>(startPosition.y));
+	if (IsTileSolid(currentTileCoords.x, currentTileCoords.y))
+	{
+		raycastResult.m_didImpact = true;
+		raycastResult.m_impactDist = 0.0f;
+		raycastResult.m_impactPos = startPosition;
+		raycastResult.m_impactNormal = Vec3() - directionNormal;
+	}
+	else
+	{
+		float forwardDistPerX = 1.0f / fabsf(directionNormal.x);
+
+		int tileStepDirectionX;
+		if (directionNormal.x < 0)
+		{
+			tileStepDirectionX = -1;
+		}
+		else
+		{
+			tileStepDirectionX = 1;
+		}
+
+		float xAtFirstXCrossing = static_cast<float>(currentTileCoords.x + (tileStepDirectionX + 1)/2);
+		float xDistToFirstXCrossing = xAtFirstXCrossing - startPosition.x;
+		float totalDistAtNextXCrossing = fabsf(xDistToFirstXCrossing) * forwardDistPerX;
+
+		float forwardDistPerY = 1.0f / fabsf(directionNormal.y);
+
+		int tileStepDirectionY;
+		if (directionNormal.y < 0)
+		{
+			tileStepDirectionY = -1;
+		}
+		else
+		{
+			tileStepDirectionY = 1;
+		}
+
+		float yAtFirstYCrossing = static_cast<float>(currentTileCoords.y + (tileStepDirectionY + 1)/2);
+		float yDistToFirstYCrossing = yAtFirstYCrossing - startPosition.y;
+		float totalDistAtNextYCrossing = fabsf(yDistToFirstYCrossing) * forwardDistPerY;
+
+		while (totalDistAtNextXCrossing < distance || totalDistAtNextYCrossing < distance)
+		{
+			if (totalDistAtNextXCrossing < totalDistAtNextYCrossing)
+			{
+				if (totalDistAtNextXCrossing > distance)
+				{
+					raycastResult.m_rayStartPosition = startPosition;
+					raycastResult.m_rayDirection = directionNormal;
+					raycastResult.m_rayLength = distance;
+
+					return raycastResult;
+				}
+
+				currentTileCoords.x += tileStepDirectionX;
+				IncrementPerfCounter(PerfCounter::RAYCAST_TILES_STEPPED);
+				if (IsTileSolid(currentTileCoords.x, currentTileCoords.y))
+				{
+					raycastResult.m_didImpact = true;
+					raycastResult.m_impactDist = totalDistAtNextXCrossing;
+					raycastResult.m_impactPos = startPosition + (directionNormal * totalDistAtNextXCrossing);
+					if (tileStepDirectionX == -1)
+					{
+						raycastResult.m_impactNormal = Vec3(1.0f, 0.0f, 0.0f);
+					}
+					else
+					{
+						raycastResult.m_impactNormal = Vec3(-1.0f, 0.0f, 0.0f);
+					}
+					raycastResult.m_rayStartPosition = startPosition;
+					raycastResult.m_rayDirection = directionNormal;
+					raycastResult.m_rayLength = distance;
+
+					return raycastResult;
+				}
+
+				totalDistAtNextXCrossing += forwardDistPerX;
+			}
+			else
+			{
+				if (totalDistAtNextYCrossing > distance)
+				{
+					raycastResult.m_rayStartPosition = startPosition;
+					raycastResult.m_rayDirection = directionNormal;
+					raycastResult.m_rayLength = distance;
+
+					return raycastResult;
+				}
+
+				currentTileCoords.y += tileStepDirectionY;
+				IncrementPerfCounter(PerfCounter::RAYCAST_TILES_STEPPED);
+				if (IsTileSolid(currentTileCoords.x, currentTileCoords.y))
+				{
+					raycastResult.m_didImpact = true;
+					raycastResult.m_impactDist = totalDistAtNextYCrossing;
+					raycastResult.m_impactPos = startPosition + (directionNormal * totalDistAtNextYCrossing);
+					if (tileStepDirectionY == -1)
+					{
+						raycastResult.m_impactNormal = Vec3(0.0f, 1.0f, 0.0f);
+					}
+					else
+					{
+						raycastResult.m_impactNormal = Vec3(0.0f, -1.0f, 0.0f);
+					}
+					raycastResult.m_rayStartPosition = startPosition;
+					raycastResult.m_rayDirection = directionNormal;
+					raycastResult.m_rayLength = distance;
+
+					return raycastResult;
+				}
+
+				totalDistAtNextYCrossing += forwardDistPerY;
+			}
+		}
+	}
+
+	raycastResult.m_rayStartPosition = startPosition;
+	raycastResult.m_rayDirection = directionNormal;
+	raycastResult.m_rayLength = distance;
+
+	return raycastResult;
+}
+
+
+RaycastResult3D Map::RaycastAgainstTilesZ(Vec3 const& startPosition, Vec3 const& directionNormal, float distance) const
+{
+	RaycastResult3D raycastResult;
+
+	Vec3 raycastVector = directionNormal * distance;
+
+	if (raycastVector.z > 0.0f)
+	{
+		float t = (1.0f - startPosition.z) / raycastVector.z;
+		Vec3 posAtT = startPosition + (raycastVector * t);
+
+		if (t > 0.0f && t < 1.0f)
+		{
+			raycastResult.m_didImpact = true;
+			raycastResult.m_impactDist = GetDistance3D(posAtT, startPosition);
+			raycastResult.m_impactPos = posAtT;
+			raycastResult.m_impactNormal = Vec3(0.00001f, 0.0f, -1.0f);	//for some reason, the arrow doesn't render when facing purely -z and I don't know why
+		}
+	}
+	else if (raycastVector.z < 0.0f)
+	{
+		float t = (-startPosition.z) / raycastVector.z;
+		Vec3 posAtT = startPosition + (raycastVector * t);
+
+		if (t > 0.0f && t < 1.0f)
+		{
+			raycastResult.m_didImpact = true;
+			raycastResult.m_impactDist = GetDistance3D(posAtT, startPosition);
+			raycastResult.m_impactPos = posAtT;
+			raycastResult.m_impactNormal = Vec3(0.0f, 0.0f, 1.0f);
+		}
+	}
+
+	raycastResult.m_rayStartPosition = startPosition;
+	raycastResult.m_rayDirection = directionNormal;
+	raycastResult.m_rayLength = distance;
+
+	return raycastResult;
+}
+
+
+bool Map::HasLineOfSight(Vec3 const& startPosition, Vec3 const& endPosition) const
+{
+	IncrementPerfCounter(PerfCounter::LINE_OF_SIGHT_QUERIES);
+
+	//the tile walk knows up front how many tiles the segment crosses, so the loop is just a step and a bit test
+	int tileX = static_cast<int>(floorf(startPosition.x));
+	int tileY = static_cast<int>(floorf(startPosition.y));
+	int endTileX = static_cast<int>(floorf(endPosition.x));
+	int endTileY = static_cast<int>(floorf(endPosition.y));
+	if (IsTileSolid(tileX, tileY))
+	{
+		return false;
+	}
+
+	float deltaX = endPosition.x - startPosition.x;
+	float deltaY = endPosition.y - startPosition.y;
+	int stepX = deltaX < 0.0f ? -1 : 1;
+	int stepY = deltaY < 0.0f ? -1 : 1;
+
+	//fractions of the segment between grid line crossings, and to the first crossing on each axis
+	float fractionPerX = deltaX != 0.0f ? fabsf(1.0f / deltaX) : FLT_MAX;
+	float fractionPerY = deltaY != 0.0f ? fabsf(1.0f / deltaY) : FLT_MAX;
+	float nextFractionX = deltaX != 0.0f ? (static_cast<float>(tileX + (stepX + 1) / 2) - startPosition.x) / deltaX : FLT_MAX;
+	float nextFractionY = deltaY != 0.0f ? (static_cast<float>(tileY + (stepY + 1) / 2) - startPosition.y) / deltaY : FLT_MAX;
+
+	int numSteps = abs(endTileX - tileX) + abs(endTileY - tileY);
+	for (int stepIndex = 0; stepIndex < numSteps; stepIndex++)
+	{
+		if (nextFractionX < nextFractionY)
+		{
+			tileX += stepX;
+			nextFractionX += fractionPerX;
+		}
+		else
+		{
+			tileY += stepY;
+			nextFractionY += fractionPerY;
+		}
+
+		if (IsTileSolid(tileX, tileY))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+//
+//public perception functions
+//
+void Map::UpdateWatchedActors()
+{
+	PROFILE_SCOPE("Map::UpdateWatchedActors");
+
+	//resolve which players are looking at each freeze-when-seen actor once per tick, so their AI only has to read a flag
+	for (int actorIndex = 0; actorIndex < m_liveActors.size(); actorIndex++)
+	{
+		Actor* actor = m_liveActors[actorIndex];
+		if (!actor->m_definition->m_freezeWhenSeen)
+		{
+			continue;
+		}
+
+		actor->m_watchedByPlayerMask = 0;
+
+		if (actor->m_health <= 0)
+		{
+			continue;
+		}
+
+		for (int playerIndex = 0; playerIndex < m_players.size(); playerIndex++)
+		{
+			if (m_players[playerIndex] == nullptr)
+			{
+				continue;
+			}
+
+			Actor* watcher = m_players[playerIndex]->GetActor();
+			if (watcher == nullptr || watcher == actor || watcher->m_health <= 0)
+			{
+				continue;
+			}
+
+			if (IsActorInWatcherView(actor, watcher, playerIndex))
+			{
+				actor->m_watchedByPlayerMask |= (1u << playerIndex);
+			}
+		}
+	}
+}
+
+
+bool Map::IsActorInWatcherView(Actor* actor, Actor* watcher, int watcherPlayerIndex)
+{
+	//actor has to be in front of the watcher
+	Vec3 watcherFacingDirection = watcher->GetModelMatrixYawOnly().GetIBasis3D();
+	Vec3 watcherToActor = actor->m_position - watcher->m_position;
+	if (DotProduct3D(watcherFacingDirection, watcherToActor) <= 0.0f)
+	{
+		return false;
+	}
+
+	//neither sight line can reach the watcher if it's farther away than the sight radius plus both radii
+	float sightRadius = actor->m_definition->m_sightRadius;
+	float maxReach = sightRadius + actor->m_physicsRadius + watcher->m_physicsRadius;
+	Vec2 watcherToActorXY = Vec2(watcherToActor.x, watcherToActor.y);
+	if (watcherToActorXY.GetLengthSquared() > maxReach * maxReach)
+	{
+		return false;
+	}
+
+	//check sight lines from the left and right edges of the billboard
+	Vec3 eyeHeightVector = Vec3(0.0f, 0.0f, 1.0f) * watcher->m_definition->m_eyeHeight;
+	Vec3 actorJBasisLeft = actor->m_billboardMatrix.GetJBasis3D() * actor->m_physicsRadius;
+	Vec3 startPointLeft = actor->m_position + actorJBasisLeft + eyeHeightVector;
+	Vec3 startPointRight = actor->m_position - actorJBasisLeft + eyeHeightVector;
+
+	return IsWatcherVisibleFromPoint(startPointLeft, eyeHeightVector, sightRadius, watcher, watcherPlayerIndex) 
+		|| IsWatcherVisibleFromPoint(startPointRight, eyeHeightVector, sightRadius, watcher, watcherPlayerIndex);
+}
+
+
+bool Map::IsWatcherVisibleFromPoint(Vec3 const& startPoint, Vec3 const& eyeHeightVector, float sightRadius, Actor* watcher, int watcherPlayerIndex)
+{
+	Vec3 startPointToWatcher = (watcher->m_position + eyeHeightVector - startPoint).GetNormalized();
+
+	Vec3 watcherPos = watcher->m_position;
+	RaycastResult3D watcherCast = RaycastVsZCylinder3D(startPoint, startPointToWatcher, sightRadius, watcherPos, watcherPos.z, watcherPos.z + watcher->m_physicsHeight, watcher->m_physicsRadius);
+	if (!watcherCast.m_didImpact || !IsPositionInBounds(watcherCast.m_impactPos))
+	{
+		return false;
+	}
+
+	//any other player standing closer along the same line blocks the view
+	for (int playerIndex = 0; playerIndex < m_players.size(); playerIndex++)
+	{
+		if (playerIndex == watcherPlayerIndex || m_players[playerIndex] == nullptr)
+		{
+			continue;
+		}
+
+		Actor* otherPlayerActor = m_players[playerIndex]->GetActor();
+		if (otherPlayerActor == nullptr || otherPlayerActor == watcher || otherPlayerActor->m_health <= 0)
+		{
+			continue;
+		}
+
+		Vec3 otherPos = otherPlayerActor->m_position;
+		RaycastResult3D otherCast = RaycastVsZCylinder3D(startPoint, startPointToWatcher, sightRadius, otherPos, otherPos.z, otherPos.z + otherPlayerActor->m_physicsHeight, otherPlayerActor->m_physicsRadius);
+		if (otherCast.m_didImpact && otherCast.m_impactDist < watcherCast.m_impactDist && IsPositionInBounds(otherCast.m_impactPos))
+		{
+			return false;
+		}
+	}
+
+	//only pay for the wall test once the watcher is known to be on the line
+	return HasLineOfSight(startPoint, watcherCast.m_impactPos);
+}
+
+
+bool Map::IsActorWatchedBy(Actor const* actor, Actor const* watcher) const
+{
+	for (int playerIndex = 0; playerIndex < m_players.size(); playerIndex++)
+	{
+		if (m_players[playerIndex] != nullptr && m_players[playerIndex]->GetActor() == watcher)
+		{
+			return (actor->m_watchedByPlayerMask & (1u << playerIndex)) != 0;
+		}
+	}
+
+	return false;
+}
+
+
+//
+//public region functions
+//
+void Map::BuildRegions()
+{
+	int numTiles = m_dimensions.x * m_dimensions.y;
+	m_tileRegionIDs.assign(numTiles, -1);
+	m_regions.clear();
+	m_portals.clear();
+
+	//a corridor tile is an open tile pinched between walls on opposite sides, like a doorway or hallway
+	std::vector<bool> isCorridorTile(numTiles, false);
+	for (int tileY = 0; tileY < m_dimensions.y; tileY++)
+	{
+		for (int tileX = 0; tileX < m_dimensions.x; tileX++)
+		{
+			if (IsTileSolid(tileX, tileY))
+			{
+				continue;
+			}
+
+			bool isPinchedX = IsTileSolid(tileX - 1, tileY) && IsTileSolid(tileX + 1, tileY);
+			bool isPinchedY = IsTileSolid(tileX, tileY - 1) && IsTileSolid(tileX, tileY + 1);
+			isCorridorTile[GetTileIDFromCoords(tileX, tileY)] = isPinchedX || isPinchedY;
+		}
+	}
+
+	//flood fill rooms and corridors separately so doorways split the open space into regions
+	static const int k_numOrthogonalNeighbors = 4;
+	static const int k_orthogonalOffsetsX[k_numOrthogonalNeighbors] = { 1, -1, 0, 0 };
+	static const int k_orthogonalOffsetsY[k_numOrthogonalNeighbors] = { 0, 0, 1, -1 };
+
+	std::vector<int> openList;
+	for (int tileID = 0; tileID < numTiles; tileID++)
+	{
+		int tileX = tileID % m_dimensions.x;
+		int tileY = tileID / m_dimensions.x;
+		if (m_tileRegionIDs[tileID] != -1 || IsTileSolid(tileX, tileY))
+		{
+			continue;
+		}
+
+		int regionID = static_cast<int>(m_regions.size());
+		m_regions.push_back(MapRegion());
+		MapRegion& region = m_regions.back();
+		region.m_isCorridor = isCorridorTile[tileID];
+		region.m_minCoords = IntVec2(tileX, tileY);
+		region.m_maxCoords = IntVec2(tileX, tileY);
+
+		m_tileRegionIDs[tileID] = regionID;
+		openList.clear();
+		openList.push_back(tileID);
+
+		while (!openList.empty())
+		{
+			int currentTileID = openList.back();
+			openList.pop_back();
+
+			int currentX = currentTileID % m_dimensions.x;
+			int currentY = currentTileID / m_dimensions.x;
+
+			region.m_numTiles++;
+			region.m_minCoords = IntVec2(currentX < region.m_minCoords.x ? currentX : region.m_minCoords.x, currentY < region.m_minCoords.y ? currentY : region.m_minCoords.y);
+			region.m_maxCoords = IntVec2(currentX > region.m_maxCoords.x ? currentX : region.m_maxCoords.x, currentY > region.m_maxCoords.y ? currentY : region.m_maxCoords.y);
+
+			for (int neighborIndex = 0; neighborIndex < k_numOrthogonalNeighbors; neighborIndex++)
+			{
+				int neighborX = currentX + k_orthogonalOffsetsX[neighborIndex];
+				int neighborY = currentY + k_orthogonalOffsetsY[neighborIndex];
+				if (IsTileSolid(neighborX, neighborY))
+				{
+					continue;
+				}
+
+				int neighborTileID = GetTileIDFromCoords(neighborX, neighborY);
+				if (m_tileRegionIDs[neighborTileID] == -1 && isCorridorTile[neighborTileID] == region.m_isCorridor)
+				{
+					m_tileRegionIDs[neighborTileID] = regionID;
+					openList.push_back(neighborTileID);
+				}
+			}
+		}
+	}
+
+	//every shared edge between two regions belongs to the portal for that pair of regions
+	for (int tileY = 0; tileY < m_dimensions.y; tileY++)
+	{
+		for (int tileX = 0; tileX < m_dimensions.x; tileX++)
+		{
+			int regionID = GetRegionIDAtCoords(tileX, tileY);
+			if (regionID == -1)
+			{
+				continue;
+			}
+
+			for (int neighborIndex = 0; neighborIndex < 2; neighborIndex++)
+			{
+				int neighborX = tileX + (neighborIndex == 0 ? 1 : 0);
+				int neighborY = tileY + (neighborIndex == 1 ? 1 : 0);
+				int neighborRegionID = GetRegionIDAtCoords(neighborX, neighborY);
+				if (neighborRegionID == -1 || neighborRegionID == regionID)
+				{
+					continue;
+				}
+
+				float edgeMinX = static_cast<float>(neighborX);
+				float edgeMinY = static_cast<float>(neighborY);
+				AABB2 edgeBounds = AABB2(edgeMinX, edgeMinY, edgeMinX + (neighborIndex == 0 ? 0.0f : 1.0f), edgeMinY + (neighborIndex == 1 ? 0.0f : 1.0f));
+
+				int portalIndex = -1;
+				std::vector<int> const& regionPortalIndexes = m_regions[regionID].m_portalIndexes;
+				for (int regionPortalIndex = 0; regionPortalIndex < regionPortalIndexes.size(); regionPortalIndex++)
+				{
+					MapPortal const& portal = m_portals[regionPortalIndexes[regionPortalIndex]];
+					if (portal.m_regionA == neighborRegionID || portal.m_regionB == neighborRegionID)
+					{
+						portalIndex = regionPortalIndexes[regionPortalIndex];
+						break;
+					}
+				}
+
+				if (portalIndex == -1)
+				{
+					portalIndex = static_cast<int>(m_portals.size());
+
+					MapPortal newPortal;
+					newPortal.m_regionA = regionID;
+					newPortal.m_regionB = neighborRegionID;
+					newPortal.m_bounds = edgeBounds;
+					m_portals.push_back(newPortal);
+
+					m_regions[regionID].m_portalIndexes.push_back(portalIndex);
+					m_regions[regionID].m_neighborRegionIDs.push_back(neighborRegionID);
+					m_regions[neighborRegionID].m_portalIndexes.push_back(portalIndex);
+					m_regions[neighborRegionID].m_neighborRegionIDs.push_back(regionID);
+				}
+
+				MapPortal& portal = m_portals[portalIndex];
+				portal.m_bounds.m_mins = Vec2(edgeBounds.m_mins.x < portal.m_bounds.m_mins.x ? edgeBounds.m_mins.x : portal.m_bounds.m_mins.x, edgeBounds.m_mins.y < portal.m_bounds.m_mins.y ? edgeBounds.m_mins.y : portal.m_bounds.m_mins.y);
+				portal.m_bounds.m_maxs = Vec2(edgeBounds.m_maxs.x > portal.m_bounds.m_maxs.x ? edgeBounds.m_maxs.x : portal.m_bounds.m_maxs.x, edgeBounds.m_maxs.y > portal.m_bounds.m_maxs.y ? edgeBounds.m_maxs.y : portal.m_bounds.m_maxs.y);
+				portal.m_numEdges++;
+			}
+		}
+	}
+
+	//label connected components of the region graph for constant time reachability checks
+	int numComponents = 0;
+	for (int regionID = 0; regionID < m_regions.size(); regionID++)
+	{
+		if (m_regions[regionID].m_componentID != -1)
+		{
+			continue;
+		}
+
+		m_regions[regionID].m_componentID = numComponents;
+		openList.clear();
+		openList.push_back(regionID);
+
+		while (!openList.empty())
+		{
+			int currentRegionID = openList.back();
+			openList.pop_back();
+
+			std::vector<int> const& neighborRegionIDs = m_regions[currentRegionID].m_neighborRegionIDs;
+			for (int neighborIndex = 0; neighborIndex < neighborRegionIDs.size(); neighborIndex++)
+			{
+				MapRegion& neighborRegion = m_regions[neighborRegionIDs[neighborIndex]];
+				if (neighborRegion.m_componentID == -1)
+				{
+					neighborRegion.m_componentID = numComponents;
+					openList.push_back(neighborRegionIDs[neighborIndex]);
+				}
+			}
+		}
+
+		numComponents++;
+	}
+}
+
+
+int Map::GetRegionIDAtCoords(int x, int y) const
+{
+	if (!AreCoordsInBounds(x, y))
+	{
+		return -1;
+	}
+
+	return m_tileRegionIDs[GetTileIDFromCoords(x, y)];
+}
+
+
+int Map::GetRegionIDAtPosition(Vec3 const& position) const
+{
+	return GetRegionIDAtCoords(static_cast<int>(floorf(position.x)), static_cast<int>(floorf(position.y)));
+}
+
+
+bool Map::AreInSameRegion(Vec3 const& positionA, Vec3 const& positionB) const
+{
+	int regionIDA = GetRegionIDAtPosition(positionA);
+	return regionIDA != -1 && regionIDA == GetRegionIDAtPosition(positionB);
+}
+
+
+bool Map::AreRegionsConnected(int regionIDA, int regionIDB) const
+{
+	if (regionIDA == -1 || regionIDB == -1)
+	{
+		return false;
+	}
+
+	return m_regions[regionIDA].m_componentID == m_regions[regionIDB].m_componentID;
+}
+
+
+bool Map::ArePositionsReachable(Vec3 const& positionA, Vec3 const& positionB) const
+{
+	return AreRegionsConnected(GetRegionIDAtPosition(positionA), GetRegionIDAtPosition(positionB));
+}
+
+
+std::vector<int> const& Map::GetNeighborRegionIDs(int regionID) const
+{
+	static const std::vector<int> s_noNeighbors;
+
+	if (regionID < 0 || regionID >= m_regions.size())
+	{
+		return s_noNeighbors;
+	}
+
+	return m_regions[regionID].m_neighborRegionIDs;
+}
+
+
+//
+//public spatial query functions
+//
+void Map::RebuildActorBuckets()
+{
+	PROFILE_SCOPE("Map::RebuildActorBuckets");
+
+	//counting sort of actor indexes by the tile they stand in
+	int numTiles = m_dimensions.x * m_dimensions.y;
+	m_actorBucketStarts.assign(numTiles + 1, 0);
+	m_unbucketedActorIndexes.clear();
+
+	for (int liveIndex = 0; liveIndex < m_liveActors.size(); liveIndex++)
+	{
+		IntVec2 actorCoords = GetClampedCoordsFromPosition(m_liveActors[liveIndex]->m_position);
+		m_actorBucketStarts[GetTileIDFromCoords(actorCoords.x, actorCoords.y) + 1]++;
+	}
+
+	for (int tileID = 0; tileID < numTiles; tileID++)
+	{
+		m_actorBucketStarts[tileID + 1] += m_actorBucketStarts[tileID];
+	}
+
+	m_actorBucketIndexes.resize(m_actorBucketStarts[numTiles]);
+	m_actorBucketFillIndexes.assign(m_actorBucketStarts.begin(), m_actorBucketStarts.end() - 1);
+
+	for (int liveIndex = 0; liveIndex < m_liveActors.size(); liveIndex++)
+	{
+		Actor const* actor = m_liveActors[liveIndex];
+		IntVec2 actorCoords = GetClampedCoordsFromPosition(actor->m_position);
+		int tileID = GetTileIDFromCoords(actorCoords.x, actorCoords.y);
+		m_actorBucketIndexes[m_actorBucketFillIndexes[tileID]] = static_cast<int>(actor->m_UID.GetIndex());
+		m_actorBucketFillIndexes[tileID]++;
+	}
+}
+
+
+void Map::GetActorsInRadius(ActorRadiusQuery const& query, std::vector<Actor*>& out_actors) const
+{
+	out_actors.clear();
+
+	if (m_actorBucketStarts.empty())
+	{
+		return;
+	}
+
+	Vec3 searchExtents = Vec3(query.m_radius + k_actorBucketMargin, query.m_radius + k_actorBucketMargin, 0.0f);
+	IntVec2 minCoords = GetClampedCoordsFromPosition(query.m_center - searchExtents);
+	IntVec2 maxCoords = GetClampedCoordsFromPosition(query.m_center + searchExtents);
+
+	for (int tileY = minCoords.y; tileY <= maxCoords.y; tileY++)
+	{
+		for (int tileX = minCoords.x; tileX <= maxCoords.x; tileX++)
+		{
+			int tileID = GetTileIDFromCoords(tileX, tileY);
+			for (int bucketIndex = m_actorBucketStarts[tileID]; bucketIndex < m_actorBucketStarts[tileID + 1]; bucketIndex++)
+			{
+				Actor* actor = m_allActors[m_actorBucketIndexes[bucketIndex]];
+				if (actor != nullptr && DoesActorPassRadiusQuery(actor, query))
+				{
+					out_actors.push_back(actor);
+				}
+			}
+		}
+	}
+
+	for (int unbucketedIndex = 0; unbucketedIndex < m_unbucketedActorIndexes.size(); unbucketedIndex++)
+	{
+		Actor* actor = m_allActors[m_unbucketedActorIndexes[unbucketedIndex]];
+		if (actor != nullptr && DoesActorPassRadiusQuery(actor, query))
+		{
+			out_actors.push_back(actor);
+		}
+	}
+}
+
+
+void Map::GetActorsAlongRay(Vec3 const& startPosition, Vec3 const& directionNormal, float distance, float margin, std::vector<Actor*>& out_actors) const
+{
+	out_actors.clear();
+
+	if (m_actorBucketStarts.empty())
+	{
+		return;
+	}
+
+	//walk the ray one tile column at a time along its major axis, each column only scans the rows the ray crosses there
+	//widened by the margin, so the cost grows with the ray's length instead of its length squared
+	bool isXMajor = fabsf(directionNormal.x) >= fabsf(directionNormal.y);
+	float startU = isXMajor ? startPosition.x : startPosition.y;
+	float startV = isXMajor ? startPosition.y : startPosition.x;
+	float endU = startU + (isXMajor ? directionNormal.x : directionNormal.y) * distance;
+	float endV = startV + (isXMajor ? directionNormal.y : directionNormal.x) * distance;
+	float segmentMinU = startU < endU ? startU : endU;
+	float segmentMaxU = startU < endU ? endU : startU;
+	float slope = segmentMaxU - segmentMinU > 0.0001f ? (endV - startV) / (endU - startU) : 0.0f;
+	int dimensionU = isXMajor ? m_dimensions.x : m_dimensions.y;
+
+	//rows are measured straight across the major axis, a slanted ray needs up to sqrt 2 more of them to keep the full margin
+	float directionU = fabsf(isXMajor ? directionNormal.x : directionNormal.y);
+	float directionLengthXY = sqrtf(directionNormal.x * directionNormal.x + directionNormal.y * directionNormal.y);
+	float rowMargin = directionU > 0.0001f ? margin * directionLengthXY / directionU : margin;
+	int dimensionV = isXMajor ? m_dimensions.y : m_dimensions.x;
+
+	int firstColumn = GetClamped(static_cast<int>(floorf(segmentMinU - margin)), 0, dimensionU - 1);
+	int lastColumn = GetClamped(static_cast<int>(floorf(segmentMaxU + margin)), 0, dimensionU - 1);
+	for (int column = firstColumn; column <= lastColumn; column++)
+	{
+		float columnMinU = GetClamped(static_cast<float>(column), segmentMinU, segmentMaxU);
+		float columnMaxU = GetClamped(static_cast<float>(column + 1), segmentMinU, segmentMaxU);
+		float columnStartV = startV + (columnMinU - startU) * slope;
+		float columnEndV = startV + (columnMaxU - startU) * slope;
+		float columnMinV = columnStartV < columnEndV ? columnStartV : columnEndV;
+		float columnMaxV = columnStartV < columnEndV ? columnEndV : columnStartV;
+
+		int firstRow = GetClamped(static_cast<int>(floorf(columnMinV - rowMargin)), 0, dimensionV - 1);
+		int lastRow = GetClamped(static_cast<int>(floorf(columnMaxV + rowMargin)), 0, dimensionV - 1);
+		for (int row = firstRow; row <= lastRow; row++)
+		{
+			int tileID = isXMajor ? GetTileIDFromCoords(column, row) : GetTileIDFromCoords(row, column);
+			for (int bucketIndex = m_actorBucketStarts[tileID]; bucketIndex < m_actorBucketStarts[tileID + 1]; bucketIndex++)
+			{
+				Actor* actor = m_allActors[m_actorBucketIndexes[bucketIndex]];
+				if (actor != nullptr)
+				{
+					out_actors.push_back(actor);
+				}
+			}
+		}
+	}
+
+	for (int unbucketedIndex = 0; unbucketedIndex < m_unbucketedActorIndexes.size(); unbucketedIndex++)
+	{
+		Actor* actor = m_allActors[m_unbucketedActorIndexes[unbucketedIndex]];
+		if (actor != nullptr)
+		{
+			out_actors.push_back(actor);
+		}
+	}
+}
+
+
+bool Map::DoesActorPassRadiusQuery(Actor const* actor, ActorRadiusQuery const& query) const
+{
+	if (actor == query.m_ignoreActor)
+	{
+		return false;
+	}
+
+	if (query.m_filterByFaction && actor->m_definition->m_faction != query.m_faction)
+	{
+		return false;
+	}
+
+	if (GetDistanceSquared3D(query.m_center, actor->m_position) > query.m_radius * query.m_radius)
+	{
+		return false;
+	}
+
+	if (query.m_arcDegrees < 360.0f)
+	{
+		Vec3 displacement = actor->m_position - query.m_center;
+		float displacementAngle = GetAngleDegreesBetweenVectors2D(query.m_forwardXY, Vec2(displacement.x, displacement.y));
+		if (displacementAngle > query.m_arcDegrees * 0.5f)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+//
+//public pathfinding functions
+//
+void Map::UpdateFlowFields()
+{
+	PROFILE_SCOPE("Map::UpdateFlowFields");
+
+	//each field only rebuilds when its player steps into a different tile, and only so many rebuild per tick so extra players
+	//can't stack up searches in one frame, starting after the last player served so a deferred field goes first next tick
+	int numRebuilds = 0;
+	int numPlayers = static_cast<int>(m_players.size());
+	int startPlayerIndex = m_nextFlowFieldPlayerIndex < numPlayers ? m_nextFlowFieldPlayerIndex : 0;
+	for (int playerOffset = 0; playerOffset < numPlayers && numRebuilds < m_maxFlowFieldRebuildsPerTick; playerOffset++)
+	{
+		int playerIndex = (startPlayerIndex + playerOffset) % numPlayers;
+		if (m_players[playerIndex] == nullptr)
+		{
+			continue;
+		}
+
+		Actor* playerActor = m_players[playerIndex]->GetActor();
+		if (playerActor == nullptr || playerActor->m_health <= 0)
+		{
+			continue;
+		}
+
+		IntVec2 playerCoords = IntVec2(static_cast<int>(playerActor->m_position.x), static_cast<int>(playerActor->m_position.y));
+		FlowField& flowField = m_playerFlowFields[playerIndex];
+		if (playerCoords != flowField.m_goalCoords)
+		{
+			flowField.SetGoalCoords(playerCoords);
+			IncrementPerfCounter(PerfCounter::FLOW_FIELD_REBUILDS);
+			numRebuilds++;
+			m_nextFlowFieldPlayerIndex = (playerIndex + 1) % numPlayers;
+		}
+	}
+}
+
+
+FlowField const* Map::GetFlowFieldToActor(Actor const* targetActor) const
+{
+	for (int playerIndex = 0; playerIndex < m_players.size(); playerIndex++)
+	{
+		if (m_players[playerIndex] != nullptr && m_players[playerIndex]->GetActor() == targetActor && m_playerFlowFields[playerIndex].HasGoal())
+		{
+			return &m_playerFlowFields[playerIndex];
+		}
+	}
+
+	return nullptr;
+}
+
+
+//
+//public snapshot functions
+//
+void Map::WriteSnapshot(std::vector<unsigned char>& out_buffer) const
+{
+	PROFILE_SCOPE("Map::WriteSnapshot");
+
+	out_buffer.clear();
+
+	//in-flight order is stored per actor, skipping any projectile the system hasn't pruned yet
+	std::vector<int> projectileListIndexes(m_allActors.size(), -1);
+	int numProjectiles = 0;
+	for (int projectileIndex = 0; projectileIndex < m_projectileSystem->m_projectileUIDs.size(); projectileIndex++)
+	{
+		ActorUID projectileUID = m_projectileSystem->m_projectileUIDs[projectileIndex];
+		if (GetActorByUID(projectileUID) != nullptr)
+		{
+			projectileListIndexes[projectileUID.GetIndex()] = numProjectiles;
+			numProjectiles++;
+		}
+	}
+
+	MapSnapshotHeader header;
+	header.m_dimensions = m_dimensions;
+	header.m_numPlayers = static_cast<int>(m_players.size());
+	header.m_numActorSlots = static_cast<int>(m_allActors.size());
+	header.m_numLiveActors = static_cast<int>(m_liveActors.size());
+	header.m_numProjectiles = numProjectiles;
+	header.m_numEffectRings = static_cast<int>(m_effectSystem->m_rings.size());
+	header.m_simulationAccumulator = m_owner->m_simulationAccumulator;
+	header.m_ticksSinceActorSort = m_ticksSinceActorSort;
+	header.m_rngStateSize = static_cast<int>(sizeof(RandomNumberGenerator));
+	memcpy(header.m_rngState, &g_rng, sizeof(RandomNumberGenerator));
+	AppendSnapshotRecord(out_buffer, header);
+
+	for (int playerIndex = 0; playerIndex < m_players.size(); playerIndex++)
+	{
+		PlayerSnapshot playerSnapshot;
+		Player const* player = m_players[playerIndex];
+		if (player != nullptr)
+		{
+			playerSnapshot.m_actorUID = player->m_actorUID;
+			playerSnapshot.m_position = player->m_position;
+			playerSnapshot.m_velocity = player->m_velocity;
+			playerSnapshot.m_orientation = player->m_orientation;
+			playerSnapshot.m_angularVelocity = player->m_angularVelocity;
+			playerSnapshot.m_movementIntentions = player->m_movementIntentions;
+			playerSnapshot.m_numPlayerKills = player->m_numPlayerKills;
+			playerSnapshot.m_numPlayerDeaths = player->m_numPlayerDeaths;
+			playerSnapshot.m_isFreeFly = player->m_isFreeFly;
+			playerSnapshot.m_isSpeedUp = player->m_isSpeedUp;
+			playerSnapshot.m_isAttackHeld = player->m_isAttackHeld;
+		}
+		if (m_currentPlayerActors[playerIndex] != nullptr)
+		{
+			playerSnapshot.m_currentPlayerActorIndex = m_currentPlayerActors[playerIndex]->m_UID.GetIndex();
+		}
+		AppendSnapshotRecord(out_buffer, playerSnapshot);
+	}
+
+	for (int actorIndex = 0; actorIndex < m_allActors.size(); actorIndex++)
+	{
+		ActorSnapshot actorSnapshot;
+		actorSnapshot.m_slotGeneration = m_actorGenerations[actorIndex];
+		Actor const* actor = m_allActors[actorIndex];
+		if (actor == nullptr)
+		{
+			AppendSnapshotRecord(out_buffer, actorSnapshot);
+			continue;
+		}
+
+		ActorDefinition const* actorDefs = ActorDefinition::s_actorDefinitions.data();
+		int definitionIndex = static_cast<int>(actor->m_definition - actorDefs);
+		if (definitionIndex < 0 || definitionIndex >= ActorDefinition::s_actorDefinitions.size())
+		{
+			actorSnapshot.m_isProjectileDefinition = true;
+			definitionIndex = static_cast<int>(actor->m_definition - ActorDefinition::s_projectileActorDefinitions.data());
+		}
+
+		actorSnapshot.m_isOccupied = true;
+		actorSnapshot.m_liveActorIndex = m_liveActorIndexes[actorIndex];
+		actorSnapshot.m_projectileListIndex = projectileListIndexes[actorIndex];
+		actorSnapshot.m_archetypeListIndex = actor->m_archetypeListIndex;
+		actorSnapshot.m_definitionIndex = definitionIndex;
+		actorSnapshot.m_UID = actor->m_UID;
+		actorSnapshot.m_position = actor->m_position;
+		actorSnapshot.m_previousPosition = actor->m_previousPosition;
+		actorSnapshot.m_velocity = actor->m_velocity;
+		actorSnapshot.m_acceleration = actor->m_acceleration;
+		actorSnapshot.m_orientation = actor->m_orientation;
+		actorSnapshot.m_health = actor->m_health;
+		actorSnapshot.m_deathTimer = actor->m_deathTimer;
+		actorSnapshot.m_physicsHeight = actor->m_physicsHeight;
+		actorSnapshot.m_physicsRadius = actor->m_physicsRadius;
+		actorSnapshot.m_color = actor->m_color;
+		actorSnapshot.m_numWeapons = static_cast<int>(actor->m_weapons.size());
+		actorSnapshot.m_watchedByPlayerMask = actor->m_watchedByPlayerMask;
+		actorSnapshot.m_isStatic = actor->m_isStatic;
+		actorSnapshot.m_isSleeping = actor->m_isSleeping;
+		actorSnapshot.m_restingTicks = actor->m_restingTicks;
+		actorSnapshot.m_isGarbage = actor->m_isGarbage;
+
+		actorSnapshot.m_projectileOwnerUID = actor->m_projectileOwnerUID;
+
+		if (actor->m_currentController != nullptr && actor->m_currentController == actor->m_AIController)
+		{
+			actorSnapshot.m_controller = SNAPSHOT_CONTROLLER_AI;
+		}
+		for (int playerIndex = 0; playerIndex < m_players.size(); playerIndex++)
+		{
+			if (actor->m_currentController != nullptr && actor->m_currentController == m_players[playerIndex])
+			{
+				actorSnapshot.m_controller = playerIndex;
+			}
+		}
+		if (actor->m_AIController != nullptr)
+		{
+			actorSnapshot.m_AITargetUID = actor->m_AIController->m_targetUID;
+		}
+
+		if (actor->m_currentAnimGroup != nullptr)
+		{
+			actorSnapshot.m_animGroupIndex = static_cast<int>(actor->m_currentAnimGroup - actor->m_definition->m_animGroupDefs.data());
+		}
+
+		for (int weaponIndex = 0; weaponIndex < actor->m_weapons.size(); weaponIndex++)
+		{
+			if (actor->m_currentWeapon == actor->m_weapons[weaponIndex])
+			{
+				actorSnapshot.m_currentWeaponIndex = weaponIndex;
+			}
+		}
+
+		AppendSnapshotRecord(out_buffer, actorSnapshot);
+
+		for (int weaponIndex = 0; weaponIndex < actor->m_weapons.size(); weaponIndex++)
+		{
+			Weapon const* weapon = actor->m_weapons[weaponIndex];
+
+			WeaponSnapshot weaponSnapshot;
+			weaponSnapshot.m_refireTimer = weapon->m_refireTimer;
+			weaponSnapshot.m_damageIntervalTimer = weapon->m_damageIntervalTimer;
+			weaponSnapshot.m_currentLightIntensity = weapon->m_currentLightIntensity;
+			weaponSnapshot.m_currentLightRadius = weapon->m_currentLightRadius;
+			weaponSnapshot.m_holdWeaponBeingUsed = weapon->m_holdWeaponBeingUsed;
+			if (weapon->m_currentAnimDef != nullptr)
+			{
+				weaponSnapshot.m_animDefIndex = static_cast<int>(weapon->m_currentAnimDef - weapon->m_definition->m_weaponAnimDefs.data());
+			}
+			AppendSnapshotRecord(out_buffer, weaponSnapshot);
+		}
+	}
+
+	for (int ringIndex = 0; ringIndex < m_effectSystem->m_rings.size(); ringIndex++)
+	{
+		EffectRing const& ring = m_effectSystem->m_rings[ringIndex];
+
+		EffectRingSnapshot ringSnapshot;
+		ringSnapshot.m_capacity = static_cast<int>(ring.m_positions.size());
+		ringSnapshot.m_nextIndex = ring.m_nextIndex;
+		ringSnapshot.m_numAlive = ring.m_numAlive;
+		AppendSnapshotRecord(out_buffer, ringSnapshot);
+		AppendSnapshotArray(out_buffer, ring.m_positions.data(), ringSnapshot.m_capacity);
+		AppendSnapshotArray(out_buffer, ring.m_ages.data(), ringSnapshot.m_capacity);
+	}
+}
+
+
+bool Map::RestoreSnapshot(std::vector<unsigned char> const& buffer)
+{
+	PROFILE_SCOPE("Map::RestoreSnapshot");
+
+	//validate everything first so a bad buffer never leaves the map half restored
+	size_t readOffset = 0;
+	MapSnapshotHeader header;
+	if (!ReadSnapshotRecord(buffer, readOffset, header) || header.m_magic != MAP_SNAPSHOT_MAGIC || header.m_version != MAP_SNAPSHOT_VERSION)
+	{
+		return false;
+	}
+	if (header.m_dimensions != m_dimensions || header.m_numPlayers != m_players.size() || header.m_numEffectRings != m_effectSystem->m_rings.size()
+		|| header.m_rngStateSize != sizeof(RandomNumberGenerator) || header.m_numActorSlots < 0 || header.m_numLiveActors < 0 || header.m_numLiveActors > header.m_numActorSlots
+		|| header.m_numProjectiles < 0 || header.m_numProjectiles > header.m_numLiveActors)
+	{
+		return false;
+	}
+
+	size_t playersOffset = readOffset;
+	readOffset += sizeof(PlayerSnapshot) * header.m_numPlayers;
+
+	//every slot has at least an actor record, so a count the rest of the buffer can't hold is rejected before sizing anything by it
+	if (readOffset > buffer.size() || static_cast<size_t>(header.m_numActorSlots) > (buffer.size() - readOffset) / sizeof(ActorSnapshot))
+	{
+		return false;
+	}
+
+	size_t actorsOffset = readOffset;
+	std::vector<bool> isLiveIndexUsed(header.m_numLiveActors, false);
+	std::vector<bool> isProjectileIndexUsed(header.m_numProjectiles, false);
+	std::vector<bool> isArchetypeIndexUsed[ACTOR_ARCHETYPE_COUNT];	//grown as records are seen, most archetypes never show up
+	int archetypeCounts[ACTOR_ARCHETYPE_COUNT] = {};
+	int archetypeEndIndexes[ACTOR_ARCHETYPE_COUNT] = {};
+	int numOccupiedSlots = 0;
+	int numProjectiles = 0;
+	for (int actorIndex = 0; actorIndex < header.m_numActorSlots; actorIndex++)
+	{
+		ActorSnapshot actorSnapshot;
+		if (!ReadSnapshotRecord(buffer, readOffset, actorSnapshot))
+		{
+			return false;
+		}
+		if (!actorSnapshot.m_isOccupied)
+		{
+			continue;
+		}
+
+		ActorDefinition const* definition = GetSnapshotActorDefinition(actorSnapshot);
+		if (definition == nullptr || actorSnapshot.m_numWeapons != definition->m_weapons.size() || actorSnapshot.m_animGroupIndex >= static_cast<int>(definition->m_animGroupDefs.size())
+			|| actorSnapshot.m_currentWeaponIndex >= actorSnapshot.m_numWeapons || actorSnapshot.m_UID.GetIndex() != static_cast<unsigned int>(actorIndex)
+			|| actorSnapshot.m_UID.GetGeneration() != actorSnapshot.m_slotGeneration || actorSnapshot.m_liveActorIndex < 0 || actorSnapshot.m_liveActorIndex >= header.m_numLiveActors
+			|| isLiveIndexUsed[actorSnapshot.m_liveActorIndex] || actorSnapshot.m_projectileListIndex >= header.m_numProjectiles)
+		{
+			return false;
+		}
+		isLiveIndexUsed[actorSnapshot.m_liveActorIndex] = true;
+		numOccupiedSlots++;
+
+		//archetype lists have to come back packed, so every index is unique and below its archetype's count
+		unsigned int archetypeMask = definition->GetArchetypeMask();
+		int archetypeListIndex = actorSnapshot.m_archetypeListIndex;
+		if (archetypeListIndex < 0 || archetypeListIndex >= header.m_numLiveActors)
+		{
+			return false;
+		}
+		std::vector<bool>& isIndexUsed = isArchetypeIndexUsed[archetypeMask];
+		if (archetypeListIndex >= isIndexUsed.size())
+		{
+			isIndexUsed.resize(archetypeListIndex + 1, false);
+		}
+		else if (isIndexUsed[archetypeListIndex])
+		{
+			return false;
+		}
+		isIndexUsed[archetypeListIndex] = true;
+		archetypeCounts[archetypeMask]++;
+		archetypeEndIndexes[archetypeMask] = archetypeListIndex + 1 > archetypeEndIndexes[archetypeMask] ? archetypeListIndex + 1 : archetypeEndIndexes[archetypeMask];
+
+		if (actorSnapshot.m_projectileListIndex >= 0)
+		{
+			if (isProjectileIndexUsed[actorSnapshot.m_projectileListIndex])
+			{
+				return false;
+			}
+			isProjectileIndexUsed[actorSnapshot.m_projectileListIndex] = true;
+			numProjectiles++;
+		}
+		readOffset += sizeof(WeaponSnapshot) * actorSnapshot.m_numWeapons;
+	}
+	if (numOccupiedSlots != header.m_numLiveActors || numProjectiles != header.m_numProjectiles)
+	{
+		return false;
+	}
+	for (int archetypeMask = 0; archetypeMask < ACTOR_ARCHETYPE_COUNT; archetypeMask++)
+	{
+		if (archetypeEndIndexes[archetypeMask] != archetypeCounts[archetypeMask])
+		{
+			return false;
+		}
+	}
+
+	size_t effectsOffset = readOffset;
+	for (int ringIndex = 0; ringIndex < header.m_numEffectRings; ringIndex++)
+	{
+		EffectRingSnapshot ringSnapshot;
+		if (!ReadSnapshotRecord(buffer, readOffset, ringSnapshot) || ringSnapshot.m_capacity != m_effectSystem->m_rings[ringIndex].m_positions.size()
+			|| ringSnapshot.m_nextIndex < 0 || ringSnapshot.m_nextIndex >= ringSnapshot.m_capacity || ringSnapshot.m_numAlive < 0 || ringSnapshot.m_numAlive > ringSnapshot.m_capacity)
+		{
+			return false;
+		}
+		readOffset += (sizeof(Vec3) + sizeof(float)) * ringSnapshot.m_capacity;
+	}
+	if (readOffset > buffer.size())
+	{
+		return false;
+	}
+
+	//nothing that was playing or queued belongs to the restored state
+	m_voiceManager->StopAllVoices();
+	m_commandBuffer->Clear();
 
-	Vec3 raycastVector = directionNormal * distance;
+	m_owner->m_simulationAccumulator = header.m_simulationAccumulator;
+	m_ticksSinceActorSort = header.m_ticksSinceActorSort;
+	memcpy(&g_rng, header.m_rngState, sizeof(RandomNumberGenerator));
 
-	IntVec2 currentTileCoords = IntVec2(static_cast<int>(startPosition.x), static_cast<int>(startPosition.y));
-	Tile const* tile = GetTileAtCoords(currentTileCoords.x, currentTileCoords.y);
-	if (tile->m_definition->m_isSolid)
+	//actors are reused in place whenever the slot still holds the same definition
+	for (int actorIndex = header.m_numActorSlots; actorIndex < m_allActors.size(); actorIndex++)
 	{
-		raycastResult.m_didImpact = true;
-		raycastResult.m_impactDist = 0.0f;
-		raycastResult.m_impactPos = startPosition;
-		raycastResult.m_impactNormal = Vec3() - directionNormal;
+		delete m_allActors[actorIndex];
 	}
-	else
+	m_allActors.resize(header.m_numActorSlots, nullptr);
+	m_actorGenerations.resize(header.m_numActorSlots, 0);
+	m_liveActorIndexes.assign(header.m_numActorSlots, -1);
+	m_liveActors.assign(header.m_numLiveActors, nullptr);
+	for (int archetypeMask = 0; archetypeMask < ACTOR_ARCHETYPE_COUNT; archetypeMask++)
 	{
-		float forwardDistPerX = 1.0f / fabsf(directionNormal.x);
+		m_archetypeActors[archetypeMask].assign(archetypeCounts[archetypeMask], nullptr);
+	}
+	m_projectileSystem->m_projectileUIDs.assign(header.m_numProjectiles, ActorUID(ActorUID::INVALID, ActorUID::INVALID));
 
-		int tileStepDirectionX;
-		if (directionNormal.x < 0)
+	readOffset = actorsOffset;
+	for (int actorIndex = 0; actorIndex < header.m_numActorSlots; actorIndex++)
+	{
+		ActorSnapshot actorSnapshot;
+		ReadSnapshotRecord(buffer, readOffset, actorSnapshot);
+
+		m_actorGenerations[actorIndex] = actorSnapshot.m_slotGeneration;
+		Actor*& actor = m_allActors[actorIndex];
+		if (!actorSnapshot.m_isOccupied)
 		{
-			tileStepDirectionX = -1;
+			delete actor;
+			actor = nullptr;
+			continue;
 		}
-		else
+
+		ActorDefinition const* definition = GetSnapshotActorDefinition(actorSnapshot);
+		if (actor == nullptr || actor->m_definition != definition)
 		{
-			tileStepDirectionX = 1;
+			delete actor;
+			actor = new Actor(actorSnapshot.m_UID, definition, this, actorSnapshot.m_position, actorSnapshot.m_orientation, actorSnapshot.m_velocity);
+			actor->Startup();
 		}
 
-		float xAtFirstXCrossing = static_cast<float>(currentTileCoords.x + (tileStepDirectionX + 1)/2);
-		float xDistToFirstXCrossing = xAtFirstXCrossing - startPosition.x;
-		float totalDistAtNextXCrossing = fabsf(xDistToFirstXCrossing) * forwardDistPerX;
-
-		float forwardDistPerY = 1.0f / fabsf(directionNormal.y);
-
-		int tileStepDirectionY;
-		if (directionNormal.y < 0)
+		actor->m_UID = actorSnapshot.m_UID;
+		actor->m_position = actorSnapshot.m_position;
+		actor->m_previousPosition = actorSnapshot.m_previousPosition;
+		actor->m_velocity = actorSnapshot.m_velocity;
+		actor->m_acceleration = actorSnapshot.m_acceleration;
+		actor->m_orientation = actorSnapshot.m_orientation;
+		actor->m_health = actorSnapshot.m_health;
+		actor->m_deathTimer = actorSnapshot.m_deathTimer;
+		actor->m_physicsHeight = actorSnapshot.m_physicsHeight;
+		actor->m_physicsRadius = actorSnapshot.m_physicsRadius;
+		actor->m_color = actorSnapshot.m_color;
+		actor->m_watchedByPlayerMask = actorSnapshot.m_watchedByPlayerMask;
+		actor->m_isStatic = actorSnapshot.m_isStatic;
+		actor->m_isSleeping = actorSnapshot.m_isSleeping;
+		actor->m_restingTicks = actorSnapshot.m_restingTicks;
+		actor->m_isGarbage = actorSnapshot.m_isGarbage;
+		actor->m_weaponVoiceID = INVALID_VOICE_ID;
+		actor->m_currentWeapon = actorSnapshot.m_currentWeaponIndex >= 0 ? actor->m_weapons[actorSnapshot.m_currentWeaponIndex] : nullptr;
+		actor->m_currentAnimGroup = actorSnapshot.m_animGroupIndex >= 0 ? &definition->m_animGroupDefs[actorSnapshot.m_animGroupIndex] : nullptr;
+		actor->m_animClock->Reset();
+
+		if (actor->m_AIController != nullptr)
 		{
-			tileStepDirectionY = -1;
+			actor->m_AIController->m_actorUID = actor->m_UID;
+			actor->m_AIController->m_targetUID = actorSnapshot.m_AITargetUID;
 		}
-		else
+
+		for (int weaponIndex = 0; weaponIndex < actor->m_weapons.size(); weaponIndex++)
 		{
-			tileStepDirectionY = 1;
+			WeaponSnapshot weaponSnapshot;
+			ReadSnapshotRecord(buffer, readOffset, weaponSnapshot);
+
+			Weapon* weapon = actor->m_weapons[weaponIndex];
+			weapon->m_refireTimer = weaponSnapshot.m_refireTimer;
+			weapon->m_damageIntervalTimer = weaponSnapshot.m_damageIntervalTimer;
+			weapon->m_currentLightIntensity = weaponSnapshot.m_currentLightIntensity;
+			weapon->m_currentLightRadius = weaponSnapshot.m_currentLightRadius;
+			weapon->m_holdWeaponBeingUsed = weaponSnapshot.m_holdWeaponBeingUsed;
+			bool isAnimDefValid = weaponSnapshot.m_animDefIndex >= 0 && weaponSnapshot.m_animDefIndex < weapon->m_definition->m_weaponAnimDefs.size();
+			weapon->m_currentAnimDef = isAnimDefValid ? &weapon->m_definition->m_weaponAnimDefs[weaponSnapshot.m_animDefIndex] : nullptr;
+			weapon->m_animClock->Reset();
 		}
+	}
 
-		float yAtFirstYCrossing = static_cast<float>(currentTileCoords.y + (tileStepDirectionY + 1)/2);
-		float yDistToFirstYCrossing = yAtFirstYCrossing - startPosition.y;
-		float totalDistAtNextYCrossing = fabsf(yDistToFirstYCrossing) * forwardDistPerY;
+	//pointers between actors can only be resolved once every slot is filled
+	readOffset = actorsOffset;
+	for (int actorIndex = 0; actorIndex < header.m_numActorSlots; actorIndex++)
+	{
+		ActorSnapshot actorSnapshot;
+		ReadSnapshotRecord(buffer, readOffset, actorSnapshot);
+		readOffset += sizeof(WeaponSnapshot) * actorSnapshot.m_numWeapons;
 
-		while (totalDistAtNextXCrossing < distance || totalDistAtNextYCrossing < distance)
+		Actor* actor = m_allActors[actorIndex];
+		if (actor == nullptr)
 		{
-			if (totalDistAtNextXCrossing < totalDistAtNextYCrossing)
-			{
-				if (totalDistAtNextXCrossing > distance)
-				{
-					raycastResult.m_rayStartPosition = startPosition;
-					raycastResult.m_rayDirection = directionNormal;
-					raycastResult.m_rayLength = distance;
-
-					return raycastResult;
-				}
+			continue;
+		}
 
-				currentTileCoords.x += tileStepDirectionX;
-				tile = GetTileAtCoords(currentTileCoords.x, currentTileCoords.y);
-				if (tile->m_definition->m_isSolid)
-				{
-					raycastResult.m_didImpact = true;
-					raycastResult.m_impactDist = totalDistAtNextXCrossing;
-					raycastResult.m_impactPos = startPosition + (directionNormal * totalDistAtNextXCrossing);
-					if (tileStepDirectionX == -1)
-					{
-						raycastResult.m_impactNormal = Vec3(1.0f, 0.0f, 0.0f);
-					}
-					else
-					{
-						raycastResult.m_impactNormal = Vec3(-1.0f, 0.0f, 0.0f);
-					}
-					raycastResult.m_rayStartPosition = startPosition;
-					raycastResult.m_rayDirection = directionNormal;
-					raycastResult.m_rayLength = distance;
+		m_liveActors[actorSnapshot.m_liveActorIndex] = actor;
+		m_liveActorIndexes[actorIndex] = actorSnapshot.m_liveActorIndex;
+		m_archetypeActors[actor->m_archetypeMask][actorSnapshot.m_archetypeListIndex] = actor;
+		actor->m_archetypeListIndex = actorSnapshot.m_archetypeListIndex;
+		if (actorSnapshot.m_projectileListIndex >= 0)
+		{
+			m_projectileSystem->m_projectileUIDs[actorSnapshot.m_projectileListIndex] = actor->m_UID;
+		}
+		actor->m_projectileOwnerUID = actorSnapshot.m_projectileOwnerUID;
+		if (actorSnapshot.m_controller == SNAPSHOT_CONTROLLER_AI)
+		{
+			actor->m_currentController = actor->m_AIController;
+		}
+		else if (actorSnapshot.m_controller >= 0 && actorSnapshot.m_controller < m_players.size())
+		{
+			actor->m_currentController = m_players[actorSnapshot.m_controller];
+		}
+		else
+		{
+			actor->m_currentController = nullptr;
+		}
+	}
 
-					return raycastResult;
-				}
+	readOffset = playersOffset;
+	for (int playerIndex = 0; playerIndex < m_players.size(); playerIndex++)
+	{
+		PlayerSnapshot playerSnapshot;
+		ReadSnapshotRecord(buffer, readOffset, playerSnapshot);
 
-				totalDistAtNextXCrossing += forwardDistPerX;
-			}
-			else
-			{
-				if (totalDistAtNextYCrossing > distance)
-				{
-					raycastResult.m_rayStartPosition = startPosition;
-					raycastResult.m_rayDirection = directionNormal;
-					raycastResult.m_rayLength = distance;
+		int currentActorIndex = playerSnapshot.m_currentPlayerActorIndex;
+		m_currentPlayerActors[playerIndex] = (currentActorIndex >= 0 && currentActorIndex < m_allActors.size()) ? m_allActors[currentActorIndex] : nullptr;
 
-					return raycastResult;
-				}
+		Player* player = m_players[playerIndex];
+		if (player == nullptr)
+		{
+			continue;
+		}
 
-				currentTileCoords.y += tileStepDirectionY;
-				tile = GetTileAtCoords(currentTileCoords.x, currentTileCoords.y);
-				if (tile->m_definition->m_isSolid)
-				{
-					raycastResult.m_didImpact = true;
-					raycastResult.m_impactDist = totalDistAtNextYCrossing;
-					raycastResult.m_impactPos = startPosition + (directionNormal * totalDistAtNextYCrossing);
-					if (tileStepDirectionY == -1)
-					{
-						raycastResult.m_impactNormal = Vec3(0.0f, 1.0f, 0.0f);
-					}
-					else
-					{
-						raycastResult.m_impactNormal = Vec3(0.0f, -1.0f, 0.0f);
-					}
-					raycastResult.m_rayStartPosition = startPosition;
-					raycastResult.m_rayDirection = directionNormal;
-					raycastResult.m_rayLength = distance;
+		player->m_actorUID = playerSnapshot.m_actorUID;
+		player->m_position = playerSnapshot.m_position;
+		player->m_velocity = playerSnapshot.m_velocity;
+		player->m_orientation = playerSnapshot.m_orientation;
+		player->m_angularVelocity = playerSnapshot.m_angularVelocity;
+		player->m_movementIntentions = playerSnapshot.m_movementIntentions;
+		player->m_numPlayerKills = playerSnapshot.m_numPlayerKills;
+		player->m_numPlayerDeaths = playerSnapshot.m_numPlayerDeaths;
+		player->m_isFreeFly = playerSnapshot.m_isFreeFly;
+		player->m_isSpeedUp = playerSnapshot.m_isSpeedUp;
+		player->m_isAttackHeld = playerSnapshot.m_isAttackHeld;
+	}
 
-					return raycastResult;
-				}
+	readOffset = effectsOffset;
+	for (int ringIndex = 0; ringIndex < m_effectSystem->m_rings.size(); ringIndex++)
+	{
+		EffectRing& ring = m_effectSystem->m_rings[ringIndex];
 
-				totalDistAtNextYCrossing += forwardDistPerY;
-			}
-		}
+		EffectRingSnapshot ringSnapshot;
+		ReadSnapshotRecord(buffer, readOffset, ringSnapshot);
+		ring.m_nextIndex = ringSnapshot.m_nextIndex;
+		ring.m_numAlive = ringSnapshot.m_numAlive;
+		ReadSnapshotArray(buffer, readOffset, ring.m_positions.data(), ringSnapshot.m_capacity);
+		ReadSnapshotArray(buffer, readOffset, ring.m_ages.data(), ringSnapshot.m_capacity);
 	}
 
-	raycastResult.m_rayStartPosition = startPosition;
-	raycastResult.m_rayDirection = directionNormal;
-	raycastResult.m_rayLength = distance;
+	//derived state is rebuilt rather than stored
+	m_unbucketedActorIndexes.clear();
+	RebuildActorBuckets();
 
-	return raycastResult;
+	for (int fieldIndex = 0; fieldIndex < m_playerFlowFields.size(); fieldIndex++)
+	{
+		m_playerFlowFields[fieldIndex].m_goalCoords = IntVec2(-1, -1);
+	}
+	UpdateFlowFields();
+
+	return true;
 }
 
 
-RaycastResult3D Map::RaycastAgainstTilesZ(Vec3 const& startPosition, Vec3 const& directionNormal, float distance) const
+ActorDefinition const* Map::GetSnapshotActorDefinition(ActorSnapshot const& actorSnapshot) const
 {
-	RaycastResult3D raycastResult;
-
-	Vec3 raycastVector = directionNormal * distance;
-
-	if (raycastVector.z > 0.0f)
-	{
-		float t = (1.0f - startPosition.z) / raycastVector.z;
-		Vec3 posAtT = startPosition + (raycastVector * t);
-
-		if (t > 0.0f && t < 1.0f)
-		{
-			raycastResult.m_didImpact = true;
-			raycastResult.m_impactDist = GetDistance3D(posAtT, startPosition);
-			raycastResult.m_impactPos = posAtT;
-			raycastResult.m_impactNormal = Vec3(0.00001f, 0.0f, -1.0f);	//for some reason, the arrow doesn't render when facing purely -z and I don't know why
-		}
-	}
-	else if (raycastVector.z < 0.0f)
+	std::vector<ActorDefinition> const& definitions = actorSnapshot.m_isProjectileDefinition ? ActorDefinition::s_projectileActorDefinitions : ActorDefinition::s_actorDefinitions;
+	if (actorSnapshot.m_definitionIndex < 0 || actorSnapshot.m_definitionIndex >= definitions.size())
 	{
-		float t = (-startPosition.z) / raycastVector.z;
-		Vec3 posAtT = startPosition + (raycastVector * t);
-
-		if (t > 0.0f && t < 1.0f)
-		{
-			raycastResult.m_didImpact = true;
-			raycastResult.m_impactDist = GetDistance3D(posAtT, startPosition);
-			raycastResult.m_impactPos = posAtT;
-			raycastResult.m_impactNormal = Vec3(0.0f, 0.0f, 1.0f);
-		}
+		return nullptr;
 	}
 
-	raycastResult.m_rayStartPosition = startPosition;
-	raycastResult.m_rayDirection = directionNormal;
-	raycastResult.m_rayLength = distance;
-
-	return raycastResult;
+	return &definitions[actorSnapshot.m_definitionIndex];
 }
 
 
 //
 //public accessors
 //
-Tile const* Map::GetTileAtCoords(int x, int y) const
+TileDefinition const* Map::GetTileDefinitionAtCoords(int x, int y) const
 {
-	int tileID = x + (y * m_dimensions.x);
-	return &m_tiles[tileID];
+	if (!AreCoordsInBounds(x, y))
+	{
+		return nullptr;
+	}
+
+	unsigned char tileType = m_tileTypes[GetTileIDFromCoords(x, y)];
+	return tileType == k_unknownTileType ? nullptr : &TileDefinition::s_tileDefinitions[tileType];
 }
 
 
-Tile const* Map::GetTileAtPosition(Vec3 const& position) const
+int Map::GetTileGridBytes() const
 {
-	int tileID = static_cast<int>(position.x) + (static_cast<int>(position.y) * m_dimensions.x);
-	return &m_tiles[tileID];
+	return static_cast<int>(m_tileTypes.size() * sizeof(unsigned char) + m_solidTileBits.size() * sizeof(unsigned int) + m_tileNeighborSolidMasks.size() * sizeof(unsigned char));
 }
 
 
@@ -952,6 +2913,18 @@ int Map::GetTileIDFromPosition(Vec3 const& position) const
 }
 
 
+IntVec2 Map::GetClampedCoordsFromPosition(Vec3 const& position) const
+{
+	//positions off the edge of the map land in the nearest edge tile
+	int x = static_cast<int>(floorf(position.x));
+	int y = static_cast<int>(floorf(position.y));
+	x = x < 0 ? 0 : (x >= m_dimensions.x ? m_dimensions.x - 1 : x);
+	y = y < 0 ? 0 : (y >= m_dimensions.y ? m_dimensions.y - 1 : y);
+
+	return IntVec2(x, y);
+}
+
+
 bool Map::IsPositionInBounds(Vec3 const& position, float tolerance) const
 {
 	if (position.x < -tolerance || position.y < -tolerance || position.x > static_cast<float>(m_dimensions.x) + tolerance || position.y > static_cast<float>(m_dimensions.y) + tolerance)
@@ -969,7 +2942,7 @@ bool Map::IsPositionInBounds(Vec3 const& position, float tolerance) const
 
 bool Map::AreCoordsInBounds(int x, int y) const
 {
-	if (x < 0 || y < 0 || x > m_dimensions.x || y > m_dimensions.y)
+	if (x < 0 || y < 0 || x >= m_dimensions.x || y >= m_dimensions.y)
 	{
 		return false;
 	}
@@ -978,21 +2951,25 @@ bool Map::AreCoordsInBounds(int x, int y) const
 }
 
 
-Actor* Map::GetActorByUID(ActorUID uid) const
+bool Map::IsTileSolid(int x, int y) const
 {
-	if (uid.m_data == ActorUID::INVALID)
+	//treat everything outside the map as wall
+	if (!AreCoordsInBounds(x, y))
 	{
-		return nullptr;
+		return true;
 	}
 
-	unsigned int actorIndex = uid.GetIndex();
+	int tileID = GetTileIDFromCoords(x, y);
+	return (m_solidTileBits[tileID >> 5] & (1u << (tileID & 31))) != 0;
+}
 
-	if (m_allActors[actorIndex] == nullptr)
-	{
-		return nullptr;
-	}
 
-	else if (m_allActors[actorIndex]->m_UID.m_data != uid.m_data)
+Actor* Map::GetActorByUID(ActorUID uid) const
+{
+	//invalid handles have an out of range index, and a slot's generation moves on as soon as its actor is deleted,
+	//so the bounds and generation checks are all it takes to reject stale handles without touching the actor
+	unsigned int actorIndex = uid.GetIndex();
+	if (actorIndex >= m_actorGenerations.size() || m_actorGenerations[actorIndex] != uid.GetGeneration())
 	{
 		return nullptr;
 	}
@@ -1006,21 +2983,22 @@ Actor* Map::GetClosestVisibleEnemy(ActorFaction enemyFaction, Actor* requestor)
 	float closestEnemyDistance = FLT_MAX;
 	Actor* closestEnemy = nullptr;
 
-	for (int actorIndex = 0; actorIndex < m_allActors.size(); actorIndex++)
+	for (int actorIndex = 0; actorIndex < m_liveActors.size(); actorIndex++)
 	{
-		Actor* target = m_allActors[actorIndex];
-		if (target == nullptr)
+		Actor* target = m_liveActors[actorIndex];
+		if (target->m_definition->m_faction != enemyFaction)
 		{
 			continue;
 		}
 
-		if (target->m_definition->m_faction != enemyFaction)
+		float targetDistance = GetDistance3D(requestor->m_position, target->m_position);
+		if (targetDistance > requestor->m_definition->m_sightRadius * 0.5f)
 		{
 			continue;
 		}
 
-		float targetDistance = GetDistance3D(requestor->m_position, target->m_position);
-		if (targetDistance > requestor->m_definition->m_sightRadius * 0.5f)
+		//disconnected open areas always have a wall between them, so skip the sight line cast
+		if (!ArePositionsReachable(requestor->m_position, target->m_position))
 		{
 			continue;
 		}
@@ -1033,13 +3011,8 @@ Actor* Map::GetClosestVisibleEnemy(ActorFaction enemyFaction, Actor* requestor)
 			continue;
 		}
 
-		RaycastResult3D sightLineCast = RaycastAgainstTilesXY(requestor->m_position, targetDisplacement.GetNormalized(), requestor->m_definition->m_sightRadius);
-		if (sightLineCast.m_didImpact && sightLineCast.m_impactDist < targetDistance)
-		{
-			continue;
-		}
-
-		if (targetDistance < closestEnemyDistance)
+		//sight lines are only walked for targets that would beat the current closest
+		if (targetDistance < closestEnemyDistance && HasLineOfSight(requestor->m_position, target->m_position))
 		{
 			closestEnemyDistance = targetDistance;
 			closestEnemy = target;
@@ -1087,6 +3060,124 @@ void Map::DebugPossessNext()
 }
 
 
+//
+//debug functions for benchmarking hordes of chasing actors
+//
+void Map::DebugSpawnBenchmarkHorde()
+{
+	if (m_currentPlayerActors[0] == nullptr)
+	{
+		return;
+	}
+
+	std::string actorName = g_gameConfigBlackboard.GetValue("benchmarkActor", "Demon");
+	int numActors = g_gameConfigBlackboard.GetValue("benchmarkActorCount", 300);
+
+	int numSpawned = 0;
+	for (int attemptIndex = 0; attemptIndex < numActors * 10 && numSpawned < numActors; attemptIndex++)
+	{
+		int tileX = g_rng.RollRandomIntInRange(0, m_dimensions.x - 1);
+		int tileY = g_rng.RollRandomIntInRange(0, m_dimensions.y - 1);
+		if (IsTileSolid(tileX, tileY))
+		{
+			continue;
+		}
+
+		Vec3 spawnPosition = Vec3(static_cast<float>(tileX) + 0.5f, static_cast<float>(tileY) + 0.5f, 0.0f);
+		if (!ArePositionsReachable(spawnPosition, m_currentPlayerActors[0]->m_position))
+		{
+			continue;
+		}
+
+		Actor* newActor = SpawnActor(actorName, spawnPosition, EulerAngles());
+		if (newActor == nullptr)
+		{
+			break;
+		}
+
+		//send the horde straight at player 1 instead of waiting for them to spot someone
+		if (newActor->m_AIController != nullptr)
+		{
+			newActor->m_AIController->m_targetUID = m_currentPlayerActors[0]->m_UID;
+		}
+
+		numSpawned++;
+	}
+
+	m_isBenchmarkingHorde = true;
+	m_benchmarkTicks = 0;
+	m_benchmarkFlowFieldSeconds = 0.0;
+	m_benchmarkActorUpdateSeconds = 0.0;
+	m_benchmarkCollisionSeconds = 0.0;
+	m_benchmarkOtherOrderActorUpdateMS = -1.0;
+	m_benchmarkOtherOrderCollisionMS = -1.0;
+	m_benchmarkOtherOrderSpread = -1.0f;
+
+	//start the first window freshly sorted, the horde landed at the end of the live list in spawn order
+	m_isBenchmarkingSlotOrder = false;
+	if (m_actorSortIntervalTicks > 0)
+	{
+		SortLiveActors(true);
+		m_ticksSinceActorSort = 0;
+	}
+
+	DebugAddMessage(Stringf("Spawned %i chasing %s actors for benchmarking", numSpawned, actorName.c_str()), 4.0f);
+}
+
+
+void Map::DebugUpdateBenchmarkStats(double flowFieldSeconds, double actorUpdateSeconds, double collisionSeconds)
+{
+	static const int k_benchmarkReportTicks = 120;
+
+	m_benchmarkTicks++;
+	m_benchmarkFlowFieldSeconds += flowFieldSeconds;
+	m_benchmarkActorUpdateSeconds += actorUpdateSeconds;
+	m_benchmarkCollisionSeconds += collisionSeconds;
+
+	if (m_benchmarkTicks >= k_benchmarkReportTicks)
+	{
+		double averageFlowFieldMS = m_benchmarkFlowFieldSeconds * 1000.0 / static_cast<double>(m_benchmarkTicks);
+		double averageActorUpdateMS = m_benchmarkActorUpdateSeconds * 1000.0 / static_cast<double>(m_benchmarkTicks);
+		double averageCollisionMS = m_benchmarkCollisionSeconds * 1000.0 / static_cast<double>(m_benchmarkTicks);
+		float orderSpread = GetLiveActorOrderSpread();
+		int numFlowFieldRebuilds = 0;
+		for (int fieldIndex = 0; fieldIndex < m_playerFlowFields.size(); fieldIndex++)
+		{
+			numFlowFieldRebuilds += m_playerFlowFields[fieldIndex].m_numRebuilds;
+		}
+
+		char const* orderName = m_actorSortIntervalTicks <= 0 ? "unsorted" : (m_isBenchmarkingSlotOrder ? "slot order" : "Morton order");
+		DebugAddMessage(Stringf("Horde benchmark (%s): flow fields %.3f ms/tick, actor update %.3f ms/tick, collision %.3f ms/tick, %.2f tiles between update neighbors, %i total field rebuilds",
+			orderName, averageFlowFieldMS, averageActorUpdateMS, averageCollisionMS, orderSpread, numFlowFieldRebuilds), 4.0f);
+
+		//with sorting on, windows alternate between Morton and slot order so each report can show the delta against the other one
+		if (m_actorSortIntervalTicks > 0)
+		{
+			if (m_benchmarkOtherOrderCollisionMS > 0.0 && m_benchmarkOtherOrderActorUpdateMS > 0.0 && m_benchmarkOtherOrderSpread > 0.0f)
+			{
+				double actorUpdateDelta = (averageActorUpdateMS - m_benchmarkOtherOrderActorUpdateMS) * 100.0 / m_benchmarkOtherOrderActorUpdateMS;
+				double collisionDelta = (averageCollisionMS - m_benchmarkOtherOrderCollisionMS) * 100.0 / m_benchmarkOtherOrderCollisionMS;
+				float spreadDelta = (orderSpread - m_benchmarkOtherOrderSpread) * 100.0f / m_benchmarkOtherOrderSpread;
+				DebugAddMessage(Stringf("  vs %s: actor update %+.1f%%, collision %+.1f%%, update neighbor distance %+.1f%%",
+					m_isBenchmarkingSlotOrder ? "Morton order" : "slot order", actorUpdateDelta, collisionDelta, spreadDelta), 4.0f);
+			}
+
+			m_benchmarkOtherOrderActorUpdateMS = averageActorUpdateMS;
+			m_benchmarkOtherOrderCollisionMS = averageCollisionMS;
+			m_benchmarkOtherOrderSpread = orderSpread;
+			m_isBenchmarkingSlotOrder = !m_isBenchmarkingSlotOrder;
+			SortLiveActors(!m_isBenchmarkingSlotOrder);
+			m_ticksSinceActorSort = 0;
+		}
+
+		m_benchmarkTicks = 0;
+		m_benchmarkFlowFieldSeconds = 0.0;
+		m_benchmarkActorUpdateSeconds = 0.0;
+		m_benchmarkCollisionSeconds = 0.0;
+	}
+}
+
+
 //
 //light constants function for lights out mode
 //
@@ -2,6 +2,12 @@
 #include "Game/Tile.hpp"
 #include "Game/ActorUID.hpp"
 #include "Game/ActorDefinition.hpp"
+#include "Game/FlowField.hpp"
+#include "Game/VoiceManager.hpp"
+#include "Game/EffectSystem.hpp"
+#include "Game/MapCommandBuffer.hpp"
+#include "Game/ProjectileSystem.hpp"
+#include "Game/MapSnapshot.hpp"
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Core/Vertex_PNCU.hpp"
 #include "Engine/Math/MathUtils.hpp"
@@ -11,6 +17,7 @@
 
 //forward declarations
 class MapDefinition;
+class TileDefinition;
 class Game;
 class Player;
 class SpriteSheet;
@@ -28,52 +35,216 @@ struct RaycastResultGame
 };
 
 
+//what a raycast can hit, walls and floors are cast first and clip how far the actor search has to look
+constexpr unsigned int RAYCAST_LAYER_WALLS = 1 << 0;
+constexpr unsigned int RAYCAST_LAYER_FLOOR_AND_CEILING = 1 << 1;
+constexpr unsigned int RAYCAST_LAYER_ACTORS = 1 << 2;
+constexpr unsigned int RAYCAST_LAYER_ALL = RAYCAST_LAYER_WALLS | RAYCAST_LAYER_FLOOR_AND_CEILING | RAYCAST_LAYER_ACTORS;
+
+constexpr unsigned int RAYCAST_FACTION_ALL = 0xffffffff;	//faction masks have one bit per ActorFaction value
+constexpr int RAYCAST_MAX_IGNORED_ACTORS = 4;
+
+
+struct RaycastFilter
+{
+	unsigned int m_layerMask = RAYCAST_LAYER_ALL;
+	unsigned int m_factionMask = RAYCAST_FACTION_ALL;
+	bool		 m_isAliveOnly = true;
+	bool		 m_isPlayersOnly = false;		//only actors currently controlled by a player
+	Actor const* m_ignoredActors[RAYCAST_MAX_IGNORED_ACTORS] = {};
+	int			 m_numIgnoredActors = 0;
+
+	void IgnoreActor(Actor const* actor);
+};
+
+
+struct ActorRadiusQuery
+{
+	Vec3		 m_center;
+	float		 m_radius = 0.0f;
+	Vec2		 m_forwardXY = Vec2(1.0f, 0.0f);
+	float		 m_arcDegrees = 360.0f;		//full circle skips the arc test
+	bool		 m_filterByFaction = false;
+	ActorFaction m_faction = ActorFaction::NEUTRAL;
+	Actor const* m_ignoreActor = nullptr;
+};
+
+
+//systems that walk actors by archetype instead of testing definition flags per actor
+enum class ActorSystem
+{
+	AI,
+	PHYSICS,
+	MAP_COLLISION,
+	ACTOR_COLLISION,
+	RENDER,
+	COUNT
+};
+
+
+//Morton code of the actor's tile in the high bits over its slot index
+struct ActorSortEntry
+{
+	unsigned long long m_sortKey = 0;
+	Actor*			   m_actor = nullptr;
+};
+
+
+//two actors that were pushed apart, kept until the callbacks can run on the main thread
+struct ActorCollisionContact
+{
+	Actor* m_actorA = nullptr;
+	Actor* m_actorB = nullptr;
+};
+
+
+//what one actor collision job found, each job only ever writes its own cell
+struct ActorCollisionCell
+{
+	std::vector<ActorCollisionContact> m_contacts;
+	int								   m_numPairsTested = 0;
+};
+
+
+//cells are colored three across and two down, a cell and its forward neighbors never overlap another cell of the same color
+constexpr int ACTOR_COLLISION_CELL_COLORS = 6;
+
+
+struct MapPortal
+{
+	int	  m_regionA = -1;
+	int	  m_regionB = -1;
+	AABB2 m_bounds;			//union of the tile edges shared by both regions
+	int	  m_numEdges = 0;
+};
+
+
+struct MapRegion
+{
+	int				 m_componentID = -1;	//regions with the same component ID can reach each other
+	int				 m_numTiles = 0;
+	bool			 m_isCorridor = false;
+	IntVec2			 m_minCoords = IntVec2(-1, -1);
+	IntVec2			 m_maxCoords = IntVec2(-1, -1);
+	std::vector<int> m_portalIndexes;
+	std::vector<int> m_neighborRegionIDs;
+};
+
+
 class Map
 {
 //public member functions
 public:
 	//constructor
-	Map(Game* owner, MapDefinition const* definition, int numPlayers, int player1XboxID, int player2XboxID);
+	Map(Game* owner, MapDefinition const* definition, std::vector<int> const& playerXboxIDs);	//one xbox id per local player, -1 for keyboard
 
 	//game flow functions
 	void Startup();
+	void UpdateInput(float deltaSeconds);
 	void Update(float deltaSeconds);
+	void UpdateCameras(float renderAlpha);
 	void Render(int currentPlayerRendering);
 	void Shutdown();
 
+	//split screen functions
+	void ArrangePlayerViews();
+	int	 GetPlayerIndexForActor(Actor const* actor) const;
+
 	//actor handling functions
 	void DeleteDestroyedActors();
+	ActorUID AllocateActorUID();
+	void	 AddLiveActor(int actorIndex);
+	void	 RemoveLiveActor(int actorIndex);
+	void	 BuildSystemArchetypeMasks();
+	void	 UpdateActorAI(float deltaSeconds);
+	void	 UpdateActorPhysics(float deltaSeconds);
+	void	 SortLiveActors(bool isSpatialOrder);		//Morton order of each actor's tile, or slot order when false
+	float	 GetLiveActorOrderSpread() const;
 	Actor* SpawnPlayer(int playerIndex);
-	Actor* SpawnActor(std::string actorDefName, Vec3 const& position, EulerAngles const& orientation, Vec3 const& velocity = Vec3());
-	Actor* SpawnProjectile(std::string projectileDefName, Vec3 const& position, EulerAngles const& orientation, Vec3 const& velocity = Vec3(), Actor* projectileOwner = nullptr);
+	Actor* SpawnActor(std::string const& actorDefName, Vec3 const& position, EulerAngles const& orientation, Vec3 const& velocity = Vec3());
+	Actor* SpawnProjectile(std::string const& projectileDefName, Vec3 const& position, EulerAngles const& orientation, Vec3 const& velocity = Vec3(), ActorUID projectileOwnerUID = ActorUID(ActorUID::INVALID, ActorUID::INVALID));
+	void   SpawnEffect(std::string const& effectDefName, Vec3 const& position);
+	void   SpawnEffect(int effectDefIndex, Vec3 const& position);
+
+	//network player and replication functions
+	int	   AddRemotePlayer(int xboxID);
+	void   RemovePlayer(int playerIndex);
+	Actor* SpawnActorAtSlot(ActorUID uid, ActorDefinition const* definition, Vec3 const& position, EulerAngles const& orientation);
+	void   DeleteAllActors();
 
 	//collision functions
 	void CollideAllActorsWithEachOther();
-	void CollideActorsWithEachOther(Actor* actorA, Actor* actorB);
+	void BuildActorCollisionCells();
+	void CollideActorsInCell(int cellID);
+	void CollideActorPairInCell(ActorCollisionCell& cell, Actor* actorA, Actor* actorB);
+	int	 GetActorCollisionCellID(Vec3 const& position) const;
+	bool CollideActorsWithEachOther(Actor* actorA, Actor* actorB);	//pushes apart only, callbacks are up to the caller
 	void CollideAllActorsWithMap();
-	void CollideActorWithMap(Actor* actor);
-	void CollideActorWithTile(Actor* actor, Tile const* tile);
+	int	 CollideActorWithMap(Actor* actor);		//returns how many tile pushouts were tested
+	void CollideActorWithTile(Actor* actor, AABB2 const& tileBounds);
+	void BuildCompactTileGrid(std::vector<Tile> const& tiles);
+	void BuildTileNeighborSolidMasks();
+	unsigned char GetTileNeighborSolidMask(int x, int y) const;
 
 	//raycast functions
+	RaycastResultGame Raycast(Vec3 const& startPosition, Vec3 const& directionNormal, float distance, RaycastFilter const& filter);	//not reentrant, candidates go through m_raycastCandidates
+	bool			  DoesActorPassRaycastFilter(Actor const* actor, RaycastFilter const& filter) const;
 	RaycastResultGame RaycastAgainstAll(Vec3 const& startPosition, Vec3 const& directionNormal, float distance, Actor* owner = nullptr);
 	RaycastResultGame RaycastAgainstActors(Vec3 const& startPosition, Vec3 const& directionNormal, float distance, Actor* owner = nullptr);
 	RaycastResultGame RaycastAgainstPlayers(Vec3 const& startPosition, Vec3 const& directionNormal, float distance, Actor* owner = nullptr);
 	RaycastResult3D RaycastAgainstTilesXY(Vec3 const& startPosition, Vec3 const& directionNormal, float distance) const;
 	RaycastResult3D RaycastAgainstTilesZ(Vec3 const& startPosition, Vec3 const& directionNormal, float distance) const;
+	bool			HasLineOfSight(Vec3 const& startPosition, Vec3 const& endPosition) const;	//true when no wall tile lies between the two points
+
+	//perception functions
+	void UpdateWatchedActors();
+	bool IsActorInWatcherView(Actor* actor, Actor* watcher, int watcherPlayerIndex);
+	bool IsWatcherVisibleFromPoint(Vec3 const& startPoint, Vec3 const& eyeHeightVector, float sightRadius, Actor* watcher, int watcherPlayerIndex);
+	bool IsActorWatchedBy(Actor const* actor, Actor const* watcher) const;
+
+	//region functions
+	void BuildRegions();
+	int	 GetRegionIDAtCoords(int x, int y) const;
+	int	 GetRegionIDAtPosition(Vec3 const& position) const;
+	bool AreInSameRegion(Vec3 const& positionA, Vec3 const& positionB) const;
+	bool AreRegionsConnected(int regionIDA, int regionIDB) const;
+	bool ArePositionsReachable(Vec3 const& positionA, Vec3 const& positionB) const;
+	std::vector<int> const& GetNeighborRegionIDs(int regionID) const;
+
+	//spatial query functions
+	void RebuildActorBuckets();
+	void GetActorsInRadius(ActorRadiusQuery const& query, std::vector<Actor*>& out_actors) const;
+	void GetActorsAlongRay(Vec3 const& startPosition, Vec3 const& directionNormal, float distance, float margin, std::vector<Actor*>& out_actors) const;
+	bool DoesActorPassRadiusQuery(Actor const* actor, ActorRadiusQuery const& query) const;
+
+	//snapshot functions
+	void				   WriteSnapshot(std::vector<unsigned char>& out_buffer) const;
+	bool				   RestoreSnapshot(std::vector<unsigned char> const& buffer);
+	ActorDefinition const* GetSnapshotActorDefinition(ActorSnapshot const& actorSnapshot) const;
+
+	//pathfinding functions
+	void			 UpdateFlowFields();
+	FlowField const* GetFlowFieldToActor(Actor const* targetActor) const;
 
 	//accessors
-	Tile const* GetTileAtCoords(int x, int y) const;
-	Tile const* GetTileAtPosition(Vec3 const& position) const;
+	TileDefinition const* GetTileDefinitionAtCoords(int x, int y) const;
+	int			GetTileGridBytes() const;
 	int			GetTileIDFromCoords(int x, int y) const;
 	int			GetTileIDFromPosition(Vec3 const& position) const;
+	IntVec2		GetClampedCoordsFromPosition(Vec3 const& position) const;
 	bool		IsPositionInBounds(Vec3 const& position, float tolerance = 0.0f) const;
 	bool		AreCoordsInBounds(int x, int y) const;
+	bool		IsTileSolid(int x, int y) const;		//outside the map counts as solid
 	Actor*		GetActorByUID(ActorUID uid) const;
 	Actor*		GetClosestVisibleEnemy(ActorFaction enemyFaction, Actor* requestor) const;
 
 	//debug function for possessing actors
 	void DebugPossessNext();
 
+	//debug functions for benchmarking hordes of chasing actors
+	void DebugSpawnBenchmarkHorde();
+	void DebugUpdateBenchmarkStats(double flowFieldSeconds, double actorUpdateSeconds, double collisionSeconds);
+
 	//light constants function for lights out mode
 	void SetFlashlightConstants(Vec3 flashlightPosition, float flashlightIntensity, float flashlightSize, Vec3 flashlightAtt);
 
@@ -81,16 +252,53 @@ public:
 public:
 	Game* m_owner;
 
-	std::vector<Actor*> m_allActors;
-	unsigned int		m_actorSalt;
+	std::vector<Actor*>		  m_allActors;			//indexed by uid slot, null where an actor was deleted
+	std::vector<unsigned int> m_actorGenerations;	//one per slot, bumped whenever the slot's actor is deleted
+	std::vector<Actor*>		  m_liveActors;			//every live actor packed with no holes, reordered by deletes and the spatial sort
+	std::vector<int>		  m_liveActorIndexes;	//one per slot, index into m_liveActors or -1 for empty slots
+
+	//live actors again, split by definition flag combination so each system only walks the archetypes it handles
+	std::vector<Actor*> m_archetypeActors[ACTOR_ARCHETYPE_COUNT];
+	std::vector<int>	m_systemArchetypeMasks[(int)ActorSystem::COUNT];	//archetypes each system walks, in mask order
 
-	int m_numPlayers;
+	int m_numPlayers;							//local split screen players, always the first entries in m_players
+	int m_maxPlayers = 16;						//local plus remote players, capped at 32 since watched masks have one bit per player
 	std::vector<Player*> m_players;
 	std::vector<Actor*>  m_currentPlayerActors;
+	std::vector<FlowField> m_playerFlowFields;
+	int					   m_nextFlowFieldPlayerIndex = 0;	//round robin start for the per tick rebuild budget
+	int					   m_maxFlowFieldRebuildsPerTick = 4;
+
+	VoiceManager* m_voiceManager = nullptr;
+	EffectSystem* m_effectSystem = nullptr;
+	MapCommandBuffer* m_commandBuffer = nullptr;	//actor to actor effects, applied once per tick after collision
+	ProjectileSystem* m_projectileSystem = nullptr;
 
-	std::vector<Tile>	 m_tiles;
+	std::vector<unsigned char> m_tileTypes;		//index into TileDefinition::s_tileDefinitions, one byte per tile
+	std::vector<unsigned int>  m_solidTileBits;	//one bit per tile in tile ID order, what every wall test reads
+	std::vector<int>	 m_tileRegionIDs;	//-1 for solid tiles
+	std::vector<unsigned char> m_tileNeighborSolidMasks;	//one bit per solid neighbor in k_neighborTileOffsets order, outside the map counts as wall
+	std::vector<MapRegion> m_regions;
+	std::vector<MapPortal> m_portals;
+	std::vector<int>	 m_actorBucketStarts;		//one entry per tile plus an end marker, indexes into m_actorBucketIndexes
+	std::vector<int>	 m_actorBucketIndexes;		//actor indexes sorted by tile
+	std::vector<int>	 m_actorBucketFillIndexes;	//next free slot per tile while filling, reused every rebuild
+	std::vector<int>	 m_unbucketedActorIndexes;	//actors spawned since the last bucket rebuild
+	std::vector<Actor*>	 m_collidingActors;			//actors in the collision cells this tick, reused every tick
+	std::vector<Actor*>	 m_mapCollidingActors;		//actors pushed out of the walls this tick, reused every tick
+	std::vector<int>	 m_mapCollisionChunkPushoutTests;	//one per map collision job, summed into the perf counter afterwards
+	std::vector<Actor*>	 m_raycastCandidates;		//actors near the current raycast, shared by every raycast so raycasts can't nest or run on two threads at once
 	MapDefinition const* m_definition;
 	IntVec2				 m_dimensions;
+
+	//actor collision cells, rebuilt each tick and sized so touching actors are always in the same or neighboring cells
+	float							m_actorCollisionCellSize = 2.0f;
+	IntVec2							m_actorCollisionCellDimensions;
+	std::vector<int>				m_actorCollisionCellStarts;		//awake then sleeping start per cell plus an end marker, indexes into m_actorCollisionCellActors
+	std::vector<int>				m_actorCollisionCellFillIndexes;	//next free slot per start while filling, reused every tick
+	std::vector<Actor*>				m_actorCollisionCellActors;
+	std::vector<ActorCollisionCell> m_actorCollisionCells;
+	std::vector<int>				m_actorCollisionColorCellIDs[ACTOR_COLLISION_CELL_COLORS];	//cells with work, by color
 	
 	std::vector<Vertex_PNCU>  m_tileVerts;
 	std::vector<unsigned int> m_tileVertIndexes;
@@ -106,4 +314,28 @@ public:
 
 	float m_lightsOutSunIntensity = 0.15f;
 	float m_lightsOutAmbientIntensity = 0.08f;
+
+	float m_renderAlpha = 1.0f;	//how far rendering is between the previous and current simulation tick
+
+	//an actor that stays under both limits for this many ticks falls asleep until something disturbs it
+	float m_actorSleepSpeed = 0.05f;
+	float m_actorSleepAcceleration = 0.1f;
+	int	  m_actorSleepTicks = 30;
+
+	//live actors are sorted by the Morton code of their tile this often so world neighbors are update order neighbors, 0 turns it off
+	int						   m_actorSortIntervalTicks = 60;
+	int						   m_ticksSinceActorSort = 0;
+	std::vector<ActorSortEntry> m_actorSortEntries;
+
+	bool m_isNetClient = false;	//actors come from server snapshots, nothing is simulated or spawned locally
+
+	bool   m_isBenchmarkingHorde = false;
+	int	   m_benchmarkTicks = 0;
+	double m_benchmarkFlowFieldSeconds = 0.0;
+	double m_benchmarkActorUpdateSeconds = 0.0;
+	double m_benchmarkCollisionSeconds = 0.0;
+	bool   m_isBenchmarkingSlotOrder = false;		//benchmark windows alternate orders so the report can compare them
+	double m_benchmarkOtherOrderActorUpdateMS = -1.0;
+	double m_benchmarkOtherOrderCollisionMS = -1.0;
+	float  m_benchmarkOtherOrderSpread = -1.0f;
 };
@@ -0,0 +1,216 @@
+#include "Game/MapCommandBuffer.hpp"
+#include "Game/Map.hpp"
+#include "Game/Actor.hpp"
+#include "Game/Profiler.hpp"
+#include "Game/PerfCounters.hpp"
+#include <algorithm>
+
+
+//
+//constructor
+//
+MapCommandBuffer::MapCommandBuffer(Map* map)
+	: m_map(map)
+{
+}
+
+
+//
+//public queueing functions
+//
+void MapCommandBuffer::QueueDamage(ActorUID targetUID, ActorUID sourceUID, int damageAmount)
+{
+	DamageCommand command;
+	command.m_targetUID = targetUID;
+	command.m_sourceUID = sourceUID;
+	command.m_damageAmount = damageAmount;
+	m_damageCommands.push_back(command);
+	IncrementPerfCounter(PerfCounter::DAMAGE_COMMANDS);
+}
+
+
+void MapCommandBuffer::QueueImpulse(ActorUID targetUID, Vec3 const& impulse)
+{
+	ImpulseCommand command;
+	command.m_targetUID = targetUID;
+	command.m_impulse = impulse;
+	m_impulseCommands.push_back(command);
+}
+
+
+void MapCommandBuffer::QueueSpawnProjectile(std::string const& projectileDefName, Vec3 const& position, EulerAngles const& orientation, Vec3 const& velocity, ActorUID ownerUID)
+{
+	SpawnCommand command;
+	command.m_type = SpawnCommandType::PROJECTILE;
+	command.m_definitionName = projectileDefName;
+	command.m_position = position;
+	command.m_orientation = orientation;
+	command.m_velocity = velocity;
+	command.m_ownerUID = ownerUID;
+	m_spawnCommands.push_back(command);
+}
+
+
+void MapCommandBuffer::QueueSpawnEffect(std::string const& effectDefName, int effectDefIndex, Vec3 const& position)
+{
+	//the name is only needed when there is no effect definition and it has to spawn as an actor
+	SpawnCommand command;
+	command.m_type = SpawnCommandType::EFFECT;
+	command.m_effectDefinitionIndex = effectDefIndex;
+	if (effectDefIndex == -1)
+	{
+		command.m_definitionName = effectDefName;
+	}
+	command.m_position = position;
+	m_spawnCommands.push_back(command);
+}
+
+
+void MapCommandBuffer::QueueDestroy(ActorUID targetUID)
+{
+	m_destroyCommands.push_back(targetUID);
+}
+
+
+void MapCommandBuffer::QueueSound(SoundID soundID, ActorUID ownerUID, Vec3 const& position, bool isLooping, float volume, VoicePriority priority)
+{
+	SoundCommand command;
+	command.m_soundID = soundID;
+	command.m_ownerUID = ownerUID;
+	command.m_position = position;
+	command.m_isLooping = isLooping;
+	command.m_volume = volume;
+	command.m_priority = priority;
+	m_soundCommands.push_back(command);
+}
+
+
+//
+//public execution functions
+//
+void MapCommandBuffer::Execute()
+{
+	PROFILE_SCOPE("MapCommandBuffer::Execute");
+
+	//damage goes first so hurt sounds it queues still play this tick, spawns go late so new actors can't be hit by this tick's commands
+	ExecuteDamage();
+	ExecuteImpulses();
+	ExecuteDestroys();
+	ExecuteSpawns();
+	ExecuteSounds();
+}
+
+
+void MapCommandBuffer::Clear()
+{
+	m_damageCommands.clear();
+	m_impulseCommands.clear();
+	m_spawnCommands.clear();
+	m_destroyCommands.clear();
+	m_soundCommands.clear();
+}
+
+
+//
+//private execution functions
+//
+void MapCommandBuffer::ExecuteDamage()
+{
+	//grouping by target and source turns a shotgun volley into a single hit with one hurt reaction, stable so equal keys keep queue order
+	std::stable_sort(m_damageCommands.begin(), m_damageCommands.end(), [](DamageCommand const& commandA, DamageCommand const& commandB)
+	{
+		if (commandA.m_targetUID.m_data != commandB.m_targetUID.m_data)
+		{
+			return commandA.m_targetUID.m_data < commandB.m_targetUID.m_data;
+		}
+		return commandA.m_sourceUID.m_data < commandB.m_sourceUID.m_data;
+	});
+
+	for (int commandIndex = 0; commandIndex < m_damageCommands.size(); commandIndex++)
+	{
+		DamageCommand mergedCommand = m_damageCommands[commandIndex];
+		while (commandIndex + 1 < m_damageCommands.size() && m_damageCommands[commandIndex + 1].m_targetUID.m_data == mergedCommand.m_targetUID.m_data
+			&& m_damageCommands[commandIndex + 1].m_sourceUID.m_data == mergedCommand.m_sourceUID.m_data)
+		{
+			commandIndex++;
+			mergedCommand.m_damageAmount += m_damageCommands[commandIndex].m_damageAmount;
+		}
+
+		Actor* target = m_map->GetActorByUID(mergedCommand.m_targetUID);
+		if (target != nullptr)
+		{
+			target->TakeDamage(mergedCommand.m_sourceUID, mergedCommand.m_damageAmount);
+			IncrementPerfCounter(PerfCounter::DAMAGE_EVENTS);
+		}
+	}
+
+	m_damageCommands.clear();
+}
+
+
+void MapCommandBuffer::ExecuteImpulses()
+{
+	for (int commandIndex = 0; commandIndex < m_impulseCommands.size(); commandIndex++)
+	{
+		ImpulseCommand const& command = m_impulseCommands[commandIndex];
+		Actor* target = m_map->GetActorByUID(command.m_targetUID);
+		if (target != nullptr)
+		{
+			target->AddImpulse(command.m_impulse);
+		}
+	}
+
+	m_impulseCommands.clear();
+}
+
+
+void MapCommandBuffer::ExecuteDestroys()
+{
+	for (int commandIndex = 0; commandIndex < m_destroyCommands.size(); commandIndex++)
+	{
+		Actor* target = m_map->GetActorByUID(m_destroyCommands[commandIndex]);
+		if (target != nullptr)
+		{
+			target->m_isGarbage = true;
+		}
+	}
+
+	m_destroyCommands.clear();
+}
+
+
+void MapCommandBuffer::ExecuteSpawns()
+{
+	for (int commandIndex = 0; commandIndex < m_spawnCommands.size(); commandIndex++)
+	{
+		SpawnCommand const& command = m_spawnCommands[commandIndex];
+		switch (command.m_type)
+		{
+			case SpawnCommandType::PROJECTILE: m_map->SpawnProjectile(command.m_definitionName, command.m_position, command.m_orientation, command.m_velocity, command.m_ownerUID); break;
+			case SpawnCommandType::EFFECT:
+				if (command.m_effectDefinitionIndex != -1)
+				{
+					m_map->SpawnEffect(command.m_effectDefinitionIndex, command.m_position);
+				}
+				else
+				{
+					m_map->SpawnEffect(command.m_definitionName, command.m_position);
+				}
+				break;
+		}
+	}
+
+	m_spawnCommands.clear();
+}
+
+
+void MapCommandBuffer::ExecuteSounds()
+{
+	for (int commandIndex = 0; commandIndex < m_soundCommands.size(); commandIndex++)
+	{
+		SoundCommand const& command = m_soundCommands[commandIndex];
+		m_map->m_voiceManager->StartVoice(command.m_soundID, command.m_ownerUID, command.m_position, command.m_isLooping, command.m_volume, command.m_priority);
+	}
+
+	m_soundCommands.clear();
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include "Game/ActorUID.hpp"
+#include "Game/VoiceManager.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Math/Vec3.hpp"
+#include "Engine/Math/EulerAngles.hpp"
+
+
+//forward declarations
+class Map;
+
+
+struct DamageCommand
+{
+	ActorUID m_targetUID = ActorUID(ActorUID::INVALID, ActorUID::INVALID);
+	ActorUID m_sourceUID = ActorUID(ActorUID::INVALID, ActorUID::INVALID);
+	int		 m_damageAmount = 0;
+};
+
+
+struct ImpulseCommand
+{
+	ActorUID m_targetUID = ActorUID(ActorUID::INVALID, ActorUID::INVALID);
+	Vec3	 m_impulse;
+};
+
+
+enum class SpawnCommandType
+{
+	PROJECTILE,
+	EFFECT,
+};
+
+
+struct SpawnCommand
+{
+	SpawnCommandType m_type = SpawnCommandType::PROJECTILE;
+	std::string		 m_definitionName;
+	Vec3			 m_position;
+	EulerAngles		 m_orientation;
+	Vec3			 m_velocity;
+	ActorUID		 m_ownerUID = ActorUID(ActorUID::INVALID, ActorUID::INVALID);	//projectile owner, kept as a handle on the projectile
+	int				 m_effectDefinitionIndex = -1;	//effects with a definition skip the name, -1 spawns m_definitionName instead
+};
+
+
+struct SoundCommand
+{
+	SoundID		  m_soundID = MISSING_SOUND_ID;
+	ActorUID	  m_ownerUID = ActorUID(ActorUID::INVALID, ActorUID::INVALID);
+	Vec3		  m_position;
+	bool		  m_isLooping = false;
+	float		  m_volume = 1.0f;
+	VoicePriority m_priority = VoicePriority::NORMAL;
+};
+
+
+//everything one actor does to another or to the map during a tick is queued here and applied in one pass at the end of the tick,
+//so actor updates only read shared state and the result doesn't depend on which actor happened to update first
+class MapCommandBuffer
+{
+//public member functions
+public:
+	//constructor
+	explicit MapCommandBuffer(Map* map);
+
+	//queueing functions
+	void QueueDamage(ActorUID targetUID, ActorUID sourceUID, int damageAmount);
+	void QueueImpulse(ActorUID targetUID, Vec3 const& impulse);
+	void QueueSpawnProjectile(std::string const& projectileDefName, Vec3 const& position, EulerAngles const& orientation, Vec3 const& velocity, ActorUID ownerUID);
+	void QueueSpawnEffect(std::string const& effectDefName, int effectDefIndex, Vec3 const& position);
+	void QueueDestroy(ActorUID targetUID);
+	void QueueSound(SoundID soundID, ActorUID ownerUID, Vec3 const& position, bool isLooping, float volume, VoicePriority priority);
+
+	//execution functions
+	void Execute();
+	void Clear();
+
+//public member variables
+public:
+	Map* m_map = nullptr;
+
+	std::vector<DamageCommand>	m_damageCommands;
+	std::vector<ImpulseCommand> m_impulseCommands;
+	std::vector<SpawnCommand>	m_spawnCommands;
+	std::vector<ActorUID>		m_destroyCommands;
+	std::vector<SoundCommand>	m_soundCommands;
+
+//private member functions
+private:
+	void ExecuteDamage();
+	void ExecuteImpulses();
+	void ExecuteDestroys();
+	void ExecuteSpawns();
+	void ExecuteSounds();
+};
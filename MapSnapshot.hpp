@@ -0,0 +1,153 @@
+#pragma once
+#include "Game/ActorUID.hpp"
+#include "Engine/Math/Vec3.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Math/EulerAngles.hpp"
+#include "Engine/Core/Rgba8.hpp"
+#include <vector>
+#include <cstring>
+
+
+//snapshots are a header, one record per player, one record per actor slot followed by its weapon records, then the effect rings
+constexpr unsigned int MAP_SNAPSHOT_MAGIC = 0x534d4644;	//"DFMS"
+constexpr unsigned int MAP_SNAPSHOT_VERSION = 7;
+constexpr int MAP_SNAPSHOT_RNG_BYTES = 64;
+
+//actor controller encoding, player controllers are stored as their player index
+constexpr int SNAPSHOT_CONTROLLER_NONE = -1;
+constexpr int SNAPSHOT_CONTROLLER_AI = -2;
+
+
+//every record is plain data so whole records can be copied in and out of the buffer at once
+struct MapSnapshotHeader
+{
+	unsigned int  m_magic = MAP_SNAPSHOT_MAGIC;
+	unsigned int  m_version = MAP_SNAPSHOT_VERSION;
+	IntVec2		  m_dimensions;
+	int			  m_numPlayers = 0;
+	int			  m_numActorSlots = 0;
+	int			  m_numLiveActors = 0;
+	int			  m_numProjectiles = 0;
+	int			  m_numEffectRings = 0;
+	float		  m_simulationAccumulator = 0.0f;
+	int			  m_ticksSinceActorSort = 0;		//when the next spatial sort lands changes update order
+	int			  m_rngStateSize = 0;
+	unsigned char m_rngState[MAP_SNAPSHOT_RNG_BYTES] = {};
+};
+
+
+struct PlayerSnapshot
+{
+	ActorUID	m_actorUID = ActorUID(ActorUID::INVALID, ActorUID::INVALID);
+	int			m_currentPlayerActorIndex = -1;
+	Vec3		m_position;
+	Vec3		m_velocity;
+	EulerAngles m_orientation;
+	EulerAngles m_angularVelocity;
+	Vec3		m_movementIntentions;
+	int			m_numPlayerKills = 0;
+	int			m_numPlayerDeaths = 0;
+	bool		m_isFreeFly = false;
+	bool		m_isSpeedUp = false;
+	bool		m_isAttackHeld = false;
+};
+
+
+struct ActorSnapshot
+{
+	bool		 m_isOccupied = false;		//empty slots only store this and the slot generation
+	unsigned int m_slotGeneration = 0;
+	int			 m_liveActorIndex = -1;		//update order has to survive a restore for replays to stay in sync
+	int			 m_projectileListIndex = -1;	//order in the projectile system, -1 for anything not in flight
+	int			 m_archetypeListIndex = -1;		//order in its archetype list, which collision and ai walk
+	bool		 m_isProjectileDefinition = false;
+	int			 m_definitionIndex = -1;
+	ActorUID	 m_UID = ActorUID(ActorUID::INVALID, ActorUID::INVALID);
+	ActorUID	 m_projectileOwnerUID = ActorUID(ActorUID::INVALID, ActorUID::INVALID);
+	int			 m_controller = SNAPSHOT_CONTROLLER_NONE;
+	ActorUID	 m_AITargetUID = ActorUID(ActorUID::INVALID, ActorUID::INVALID);
+	Vec3		 m_position;
+	Vec3		 m_previousPosition;
+	Vec3		 m_velocity;
+	Vec3		 m_acceleration;
+	EulerAngles	 m_orientation;
+	int			 m_health = 0;
+	float		 m_deathTimer = 0.0f;
+	float		 m_physicsHeight = 0.0f;
+	float		 m_physicsRadius = 0.0f;
+	Rgba8		 m_color;
+	int			 m_animGroupIndex = -1;
+	int			 m_currentWeaponIndex = -1;
+	int			 m_numWeapons = 0;
+	unsigned int m_watchedByPlayerMask = 0;
+	bool		 m_isStatic = false;
+	bool		 m_isSleeping = false;
+	int			 m_restingTicks = 0;
+	bool		 m_isGarbage = false;
+};
+
+
+struct WeaponSnapshot
+{
+	float m_refireTimer = 0.0f;
+	float m_damageIntervalTimer = 0.0f;
+	float m_currentLightIntensity = 0.0f;
+	float m_currentLightRadius = 0.0f;
+	int	  m_animDefIndex = -1;
+	bool  m_holdWeaponBeingUsed = false;
+};
+
+
+struct EffectRingSnapshot
+{
+	int m_capacity = 0;				//followed by this many positions and then this many ages
+	int m_nextIndex = 0;
+	int m_numAlive = 0;
+};
+
+
+//buffer helpers, reads are bounds checked so restore can reject short buffers
+template <typename T>
+void AppendSnapshotRecord(std::vector<unsigned char>& buffer, T const& record)
+{
+	size_t writeOffset = buffer.size();
+	buffer.resize(writeOffset + sizeof(T));
+	memcpy(buffer.data() + writeOffset, &record, sizeof(T));
+}
+
+
+template <typename T>
+void AppendSnapshotArray(std::vector<unsigned char>& buffer, T const* records, int numRecords)
+{
+	size_t writeOffset = buffer.size();
+	buffer.resize(writeOffset + sizeof(T) * numRecords);
+	memcpy(buffer.data() + writeOffset, records, sizeof(T) * numRecords);
+}
+
+
+template <typename T>
+bool ReadSnapshotRecord(std::vector<unsigned char> const& buffer, size_t& readOffset, T& out_record)
+{
+	if (readOffset + sizeof(T) > buffer.size())
+	{
+		return false;
+	}
+
+	memcpy(&out_record, buffer.data() + readOffset, sizeof(T));
+	readOffset += sizeof(T);
+	return true;
+}
+
+
+template <typename T>
+bool ReadSnapshotArray(std::vector<unsigned char> const& buffer, size_t& readOffset, T* out_records, int numRecords)
+{
+	if (readOffset + sizeof(T) * numRecords > buffer.size())
+	{
+		return false;
+	}
+
+	memcpy(out_records, buffer.data() + readOffset, sizeof(T) * numRecords);
+	readOffset += sizeof(T) * numRecords;
+	return true;
+}
@@ -0,0 +1,330 @@
+#include "Game/NetClient.hpp"
+#include "Game/Map.hpp"
+#include "Game/Player.hpp"
+#include "Game/Actor.hpp"
+#include "Game/ActorDefinition.hpp"
+#include "Game/GameCommon.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Core/Clock.hpp"
+
+
+//
+//constructor and destructor
+//
+NetClient::NetClient(NetTransport* transport, int serverConnectionID, int xboxID)
+	: m_transport(transport)
+	, m_serverConnectionID(serverConnectionID)
+	, m_xboxID(xboxID)
+{
+	m_timeoutSeconds = g_gameConfigBlackboard.GetValue("netTimeoutSeconds", 5.0f);
+	m_lastReceiveSeconds = GetCurrentTimeSeconds();
+}
+
+
+NetClient::~NetClient()
+{
+	Disconnect();
+
+	delete m_transport;
+	m_transport = nullptr;
+}
+
+
+//
+//public client flow functions
+//
+void NetClient::Update(FrameInput const& frameInput)
+{
+	ReceivePackets();
+
+	double currentSeconds = GetCurrentTimeSeconds();
+	if (m_state == NetClientState::CONNECTING)
+	{
+		//hellos are unreliable like everything else, so keep asking until a welcome arrives
+		if (currentSeconds - m_lastHelloSeconds > 0.25)
+		{
+			WritePacketHeader(m_writer, NetMessageType::CLIENT_HELLO);
+			m_writer.WriteByte(static_cast<unsigned char>(static_cast<signed char>(m_xboxID)));
+			m_transport->Send(m_serverConnectionID, m_writer.m_data.data(), static_cast<int>(m_writer.m_data.size()));
+			m_lastHelloSeconds = currentSeconds;
+		}
+	}
+	else if (m_state == NetClientState::CONNECTED)
+	{
+		SendInput(frameInput);
+	}
+
+	if (m_state != NetClientState::DISCONNECTED && currentSeconds - m_lastReceiveSeconds > m_timeoutSeconds)
+	{
+		m_state = NetClientState::DISCONNECTED;
+	}
+}
+
+
+void NetClient::AttachMap(Map* map)
+{
+	//everything on the map comes from the server from here on
+	m_map = map;
+	m_map->m_isNetClient = true;
+	m_map->DeleteAllActors();
+
+	m_appliedStates.clear();
+	m_appliedTick = 0;
+}
+
+
+void NetClient::ApplyToMap()
+{
+	if (m_map == nullptr || m_newestTick == m_appliedTick)
+	{
+		return;
+	}
+
+	std::vector<NetActorState> const& states = m_receivedStates[m_newestTick % NET_SNAPSHOT_HISTORY];
+
+	double currentSeconds = GetCurrentTimeSeconds();
+	float secondsSinceApply = static_cast<float>(currentSeconds - m_lastApplySeconds);
+	m_applyIntervalSeconds = secondsSinceApply;
+	m_lastApplySeconds = currentSeconds;
+
+	//actors that dropped out of the snapshot are gone, either destroyed or out of range
+	int stateIndex = 0;
+	for (int slotIndex = 0; slotIndex < m_appliedStates.size(); slotIndex++)
+	{
+		while (stateIndex < states.size() && states[stateIndex].GetSlotIndex() < slotIndex)
+		{
+			stateIndex++;
+		}
+
+		bool isPresent = stateIndex < states.size() && states[stateIndex].GetSlotIndex() == slotIndex;
+		if (!isPresent && m_appliedStates[slotIndex].m_uid != ActorUID::INVALID_DATA)
+		{
+			if (slotIndex < m_map->m_allActors.size() && m_map->m_allActors[slotIndex] != nullptr)
+			{
+				m_map->m_allActors[slotIndex]->m_isGarbage = true;
+			}
+			m_appliedStates[slotIndex] = NetActorState();
+		}
+	}
+	m_map->DeleteDestroyedActors();
+
+	for (stateIndex = 0; stateIndex < states.size(); stateIndex++)
+	{
+		NetActorState const& state = states[stateIndex];
+		int slotIndex = state.GetSlotIndex();
+		if (slotIndex >= m_appliedStates.size())
+		{
+			m_appliedStates.resize(slotIndex + 1);
+		}
+
+		NetActorState const& previousState = m_appliedStates[slotIndex];
+		Vec3 position = GetDequantizedPosition(state);
+		EulerAngles orientation = GetDequantizedOrientation(state);
+
+		Actor* actor = slotIndex < m_map->m_allActors.size() ? m_map->m_allActors[slotIndex] : nullptr;
+		bool isNewActor = actor == nullptr || actor->m_UID.m_data != state.m_uid || previousState.m_definitionCode != state.m_definitionCode;
+		if (isNewActor)
+		{
+			ActorDefinition const* definition = GetNetActorDefinition(state.m_definitionCode);
+			if (definition == nullptr)
+			{
+				continue;
+			}
+
+			ActorUID uid = ActorUID(ActorUID::INVALID, ActorUID::INVALID);
+			uid.m_data = state.m_uid;
+			actor = m_map->SpawnActorAtSlot(uid, definition, position, orientation);
+		}
+
+		actor->m_previousPosition = isNewActor ? position : actor->m_position;
+		actor->m_velocity = (!isNewActor && secondsSinceApply > 0.0f) ? (position - actor->m_position) / secondsSinceApply : Vec3();
+		actor->m_position = position;
+		actor->m_health = state.m_health;
+
+		//the local player looks around at frame rate, the server only ever catches up to it
+		if (state.m_uid != m_playerActorUID || isNewActor)
+		{
+			actor->m_orientation = orientation;
+		}
+
+		if ((isNewActor || state.m_animGroupIndex != previousState.m_animGroupIndex) && state.m_animGroupIndex < actor->m_definition->m_animGroupDefs.size())
+		{
+			actor->m_currentAnimGroup = &actor->m_definition->m_animGroupDefs[state.m_animGroupIndex];
+			actor->m_animClock->Reset();
+		}
+
+		if (state.m_weaponIndex < actor->m_weapons.size())
+		{
+			actor->m_currentWeapon = actor->m_weapons[state.m_weaponIndex];
+		}
+
+		m_appliedStates[slotIndex] = state;
+	}
+
+	//the player views the world from whichever actor the server says it owns
+	Player* player = m_map->m_players[0];
+	ActorUID playerActorUID = ActorUID(ActorUID::INVALID, ActorUID::INVALID);
+	playerActorUID.m_data = m_playerActorUID;
+	Actor* playerActor = m_map->GetActorByUID(playerActorUID);
+	if (playerActor != nullptr && player->m_actorUID.m_data != m_playerActorUID)
+	{
+		player->Possess(playerActorUID);
+	}
+	m_map->m_currentPlayerActors[0] = playerActor;
+
+	m_map->RebuildActorBuckets();
+	m_appliedTick = m_newestTick;
+}
+
+
+void NetClient::Disconnect()
+{
+	if (m_state == NetClientState::DISCONNECTED)
+	{
+		return;
+	}
+
+	WritePacketHeader(m_writer, NetMessageType::CLIENT_DISCONNECT);
+	m_transport->Send(m_serverConnectionID, m_writer.m_data.data(), static_cast<int>(m_writer.m_data.size()));
+	m_state = NetClientState::DISCONNECTED;
+}
+
+
+//
+//public accessors
+//
+bool NetClient::IsConnected() const
+{
+	return m_state == NetClientState::CONNECTED;
+}
+
+
+float NetClient::GetRenderAlpha() const
+{
+	//render a snapshot behind so actors blend between the last two the server sent
+	if (m_applyIntervalSeconds <= 0.0)
+	{
+		return 1.0f;
+	}
+
+	float renderAlpha = static_cast<float>((GetCurrentTimeSeconds() - m_lastApplySeconds) / m_applyIntervalSeconds);
+	return renderAlpha > 1.0f ? 1.0f : renderAlpha;
+}
+
+
+//
+//private client functions
+//
+void NetClient::ReceivePackets()
+{
+	m_receivedPackets.clear();
+	m_transport->Receive(m_receivedPackets);
+
+	for (int packetIndex = 0; packetIndex < m_receivedPackets.size(); packetIndex++)
+	{
+		NetPacket const& packet = m_receivedPackets[packetIndex];
+		if (packet.m_connectionID != m_serverConnectionID)
+		{
+			continue;
+		}
+
+		NetReader reader(packet.m_data.data(), static_cast<int>(packet.m_data.size()));
+		NetMessageType messageType;
+		if (!ReadPacketHeader(reader, messageType))
+		{
+			continue;
+		}
+
+		m_lastReceiveSeconds = GetCurrentTimeSeconds();
+		switch (messageType)
+		{
+			case NetMessageType::SERVER_WELCOME:
+			{
+				int playerIndex = reader.ReadByte();
+				std::string mapName = reader.ReadString();
+				bool isLightsOutMode = reader.ReadByte() != 0;
+				if (reader.m_isValid && m_state == NetClientState::CONNECTING)
+				{
+					m_playerIndex = playerIndex;
+					m_mapName = mapName;
+					m_isLightsOutMode = isLightsOutMode;
+					m_state = NetClientState::CONNECTED;
+				}
+				break;
+			}
+			case NetMessageType::SERVER_FULL:
+			case NetMessageType::CLIENT_DISCONNECT:
+			{
+				m_state = NetClientState::DISCONNECTED;
+				break;
+			}
+			case NetMessageType::SERVER_SNAPSHOT:
+			{
+				if (m_state == NetClientState::CONNECTED)
+				{
+					HandleSnapshot(reader);
+				}
+				break;
+			}
+		}
+	}
+}
+
+
+void NetClient::HandleSnapshot(NetReader& reader)
+{
+	unsigned int tick = reader.ReadUInt();
+	unsigned int baselineTick = reader.ReadUInt();
+	unsigned int playerActorIndex = reader.ReadUInt();
+	unsigned int playerActorGeneration = reader.ReadUInt();
+	if (!reader.m_isValid || tick <= m_newestTick)
+	{
+		return;
+	}
+
+	//a delta against a snapshot that never arrived, or has been overwritten, can't be decoded and the next one will do
+	static std::vector<NetActorState> const s_emptyBaseline;
+	std::vector<NetActorState> const* baselineStates = &s_emptyBaseline;
+	if (baselineTick != 0)
+	{
+		int baselineIndex = baselineTick % NET_SNAPSHOT_HISTORY;
+		if (m_receivedTicks[baselineIndex] != baselineTick)
+		{
+			return;
+		}
+		baselineStates = &m_receivedStates[baselineIndex];
+	}
+
+	if (!ReadSnapshotDelta(reader, *baselineStates, m_decodedStates))
+	{
+		return;
+	}
+
+	int historyIndex = tick % NET_SNAPSHOT_HISTORY;
+	m_receivedStates[historyIndex].swap(m_decodedStates);
+	m_receivedTicks[historyIndex] = tick;
+	m_newestTick = tick;
+	m_playerActorUID = ActorUID(playerActorIndex, playerActorGeneration).m_data;
+}
+
+
+void NetClient::SendInput(FrameInput const& frameInput)
+{
+	m_inputSequence++;
+	m_recentInputs.push_back(frameInput);
+	if (m_recentInputs.size() > NET_REDUNDANT_INPUTS)
+	{
+		m_recentInputs.erase(m_recentInputs.begin());
+	}
+
+	WritePacketHeader(m_writer, NetMessageType::CLIENT_INPUT);
+	m_writer.WriteUInt(m_newestTick);
+	m_writer.WriteUInt(m_inputSequence);
+	m_writer.WriteByte(static_cast<unsigned char>(m_recentInputs.size()));
+	for (int inputIndex = static_cast<int>(m_recentInputs.size()) - 1; inputIndex >= 0; inputIndex--)
+	{
+		WriteFrameInput(m_writer, m_recentInputs[inputIndex]);
+	}
+
+	m_transport->Send(m_serverConnectionID, m_writer.m_data.data(), static_cast<int>(m_writer.m_data.size()));
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include "Game/NetProtocol.hpp"
+#include "Game/NetTransport.hpp"
+
+
+//forward declarations
+class Map;
+
+
+enum class NetClientState
+{
+	CONNECTING,
+	CONNECTED,
+	DISCONNECTED,
+	COUNT
+};
+
+
+//sends local input to the server and mirrors the snapshots it gets back onto a map that never simulates
+class NetClient
+{
+//public member functions
+public:
+	//constructor and destructor
+	NetClient(NetTransport* transport, int serverConnectionID, int xboxID);
+	~NetClient();
+
+	//client flow functions
+	void Update(FrameInput const& frameInput);
+	void AttachMap(Map* map);
+	void ApplyToMap();
+	void Disconnect();
+
+	//accessors
+	bool  IsConnected() const;
+	float GetRenderAlpha() const;
+
+//public member variables
+public:
+	NetTransport*  m_transport = nullptr;
+	int			   m_serverConnectionID = NET_INVALID_CONNECTION;
+	int			   m_xboxID = -1;
+	NetClientState m_state = NetClientState::CONNECTING;
+	Map*		   m_map = nullptr;		//stays null for loopback bots, which only exercise the protocol
+	float		   m_timeoutSeconds = 5.0f;
+
+	//welcome info
+	int			m_playerIndex = -1;
+	std::string m_mapName;
+	bool		m_isLightsOutMode = false;
+
+	//input history, newest last, resent until it falls out of the redundancy window
+	std::vector<FrameInput> m_recentInputs;
+	unsigned int			m_inputSequence = 0;
+
+	//received snapshots by tick, the newest decoded one is what gets applied
+	std::vector<NetActorState> m_receivedStates[NET_SNAPSHOT_HISTORY];
+	unsigned int			   m_receivedTicks[NET_SNAPSHOT_HISTORY] = {};
+	unsigned int			   m_newestTick = 0;
+	unsigned int			   m_appliedTick = 0;
+	unsigned long long		   m_playerActorUID = ActorUID::INVALID_DATA;
+
+	//what is currently on the map, by slot, so only changes touch the actors
+	std::vector<NetActorState> m_appliedStates;
+
+	double m_lastHelloSeconds = 0.0;
+	double m_lastReceiveSeconds = 0.0;
+	double m_lastApplySeconds = 0.0;
+	double m_applyIntervalSeconds = 0.0;
+
+//private member functions
+private:
+	void ReceivePackets();
+	void HandleSnapshot(NetReader& reader);
+	void SendInput(FrameInput const& frameInput);
+
+//private member variables
+private:
+	std::vector<NetPacket>	   m_receivedPackets;
+	std::vector<NetActorState> m_decodedStates;
+	NetWriter				   m_writer;
+};
@@ -0,0 +1,514 @@
+#include "Game/NetProtocol.hpp"
+#include "Game/Actor.hpp"
+#include "Game/ActorDefinition.hpp"
+#include "Game/Weapon.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <climits>
+
+
+//
+//static helper functions
+//
+static short QuantizeToShort(float value, float scale)
+{
+	float scaledValue = roundf(value * scale);
+	if (scaledValue > 32767.0f)
+	{
+		return 32767;
+	}
+	if (scaledValue < -32768.0f)
+	{
+		return -32768;
+	}
+
+	return static_cast<short>(scaledValue);
+}
+
+
+static float GetWrappedDegrees(float degrees)
+{
+	float wrappedDegrees = fmodf(degrees + 180.0f, 360.0f);
+	if (wrappedDegrees < 0.0f)
+	{
+		wrappedDegrees += 360.0f;
+	}
+
+	return wrappedDegrees - 180.0f;
+}
+
+
+static void WriteActorFields(NetWriter& writer, NetActorState const& baseline, NetActorState const& current, unsigned char fieldFlags)
+{
+	//every field goes out as a zigzag delta from the baseline, so slow movers cost a byte or two per axis
+	if (fieldFlags & NET_ACTOR_POSITION)
+	{
+		writer.WriteVarInt(current.m_position[0] - baseline.m_position[0]);
+		writer.WriteVarInt(current.m_position[1] - baseline.m_position[1]);
+		writer.WriteVarInt(current.m_position[2] - baseline.m_position[2]);
+	}
+	if (fieldFlags & NET_ACTOR_ORIENTATION)
+	{
+		writer.WriteVarInt(static_cast<short>(current.m_orientation[0] - baseline.m_orientation[0]));
+		writer.WriteVarInt(static_cast<short>(current.m_orientation[1] - baseline.m_orientation[1]));
+	}
+	if (fieldFlags & NET_ACTOR_HEALTH)
+	{
+		writer.WriteVarInt(current.m_health - baseline.m_health);
+	}
+	if (fieldFlags & NET_ACTOR_ANIMATION)
+	{
+		writer.WriteByte(current.m_animGroupIndex);
+		writer.WriteByte(current.m_weaponIndex);
+	}
+}
+
+
+static void ReadActorFields(NetReader& reader, NetActorState const& baseline, NetActorState& out_current, unsigned char fieldFlags)
+{
+	if (fieldFlags & NET_ACTOR_POSITION)
+	{
+		out_current.m_position[0] = static_cast<short>(baseline.m_position[0] + reader.ReadVarInt());
+		out_current.m_position[1] = static_cast<short>(baseline.m_position[1] + reader.ReadVarInt());
+		out_current.m_position[2] = static_cast<short>(baseline.m_position[2] + reader.ReadVarInt());
+	}
+	if (fieldFlags & NET_ACTOR_ORIENTATION)
+	{
+		out_current.m_orientation[0] = static_cast<short>(baseline.m_orientation[0] + reader.ReadVarInt());
+		out_current.m_orientation[1] = static_cast<short>(baseline.m_orientation[1] + reader.ReadVarInt());
+	}
+	if (fieldFlags & NET_ACTOR_HEALTH)
+	{
+		out_current.m_health = static_cast<short>(baseline.m_health + reader.ReadVarInt());
+	}
+	if (fieldFlags & NET_ACTOR_ANIMATION)
+	{
+		out_current.m_animGroupIndex = reader.ReadByte();
+		out_current.m_weaponIndex = reader.ReadByte();
+	}
+}
+
+
+static unsigned char GetChangedFieldFlags(NetActorState const& baseline, NetActorState const& current)
+{
+	unsigned char fieldFlags = 0;
+	if (current.m_position[0] != baseline.m_position[0] || current.m_position[1] != baseline.m_position[1] || current.m_position[2] != baseline.m_position[2])
+	{
+		fieldFlags |= NET_ACTOR_POSITION;
+	}
+	if (current.m_orientation[0] != baseline.m_orientation[0] || current.m_orientation[1] != baseline.m_orientation[1])
+	{
+		fieldFlags |= NET_ACTOR_ORIENTATION;
+	}
+	if (current.m_health != baseline.m_health)
+	{
+		fieldFlags |= NET_ACTOR_HEALTH;
+	}
+	if (current.m_animGroupIndex != baseline.m_animGroupIndex || current.m_weaponIndex != baseline.m_weaponIndex)
+	{
+		fieldFlags |= NET_ACTOR_ANIMATION;
+	}
+
+	return fieldFlags;
+}
+
+
+//
+//net actor state functions
+//
+int NetActorState::GetSlotIndex() const
+{
+	return static_cast<int>(m_uid & 0xffffffff);
+}
+
+
+//
+//public writer functions
+//
+void NetWriter::Clear()
+{
+	m_data.clear();
+}
+
+
+void NetWriter::WriteByte(unsigned char value)
+{
+	m_data.push_back(value);
+}
+
+
+void NetWriter::WriteUShort(unsigned short value)
+{
+	m_data.push_back(static_cast<unsigned char>(value & 0xff));
+	m_data.push_back(static_cast<unsigned char>(value >> 8));
+}
+
+
+void NetWriter::WriteUInt(unsigned int value)
+{
+	WriteUShort(static_cast<unsigned short>(value & 0xffff));
+	WriteUShort(static_cast<unsigned short>(value >> 16));
+}
+
+
+void NetWriter::WriteVarUInt(unsigned int value)
+{
+	while (value >= 0x80)
+	{
+		m_data.push_back(static_cast<unsigned char>(value | 0x80));
+		value >>= 7;
+	}
+	m_data.push_back(static_cast<unsigned char>(value));
+}
+
+
+void NetWriter::WriteVarInt(int value)
+{
+	//zigzag so small negative deltas stay small
+	unsigned int zigzagValue = (static_cast<unsigned int>(value) << 1) ^ static_cast<unsigned int>(value >> 31);
+	WriteVarUInt(zigzagValue);
+}
+
+
+void NetWriter::WriteString(std::string const& value)
+{
+	WriteVarUInt(static_cast<unsigned int>(value.size()));
+	m_data.insert(m_data.end(), value.begin(), value.end());
+}
+
+
+//
+//reader constructor
+//
+NetReader::NetReader(unsigned char const* data, int numBytes)
+	: m_data(data)
+	, m_numBytes(numBytes)
+{
+}
+
+
+//
+//public reader functions
+//
+unsigned char NetReader::ReadByte()
+{
+	if (m_readOffset >= m_numBytes)
+	{
+		m_isValid = false;
+		return 0;
+	}
+
+	return m_data[m_readOffset++];
+}
+
+
+unsigned short NetReader::ReadUShort()
+{
+	unsigned short lowByte = ReadByte();
+	unsigned short highByte = ReadByte();
+	return static_cast<unsigned short>(lowByte | (highByte << 8));
+}
+
+
+unsigned int NetReader::ReadUInt()
+{
+	unsigned int lowShort = ReadUShort();
+	unsigned int highShort = ReadUShort();
+	return lowShort | (highShort << 16);
+}
+
+
+unsigned int NetReader::ReadVarUInt()
+{
+	unsigned int value = 0;
+	for (int shift = 0; shift < 35; shift += 7)
+	{
+		unsigned char byte = ReadByte();
+		value |= static_cast<unsigned int>(byte & 0x7f) << shift;
+		if ((byte & 0x80) == 0)
+		{
+			return value;
+		}
+	}
+
+	m_isValid = false;
+	return 0;
+}
+
+
+int NetReader::ReadVarInt()
+{
+	unsigned int zigzagValue = ReadVarUInt();
+	return static_cast<int>(zigzagValue >> 1) ^ -static_cast<int>(zigzagValue & 1);
+}
+
+
+std::string NetReader::ReadString()
+{
+	unsigned int length = ReadVarUInt();
+	if (!m_isValid || m_readOffset + static_cast<int>(length) > m_numBytes)
+	{
+		m_isValid = false;
+		return "";
+	}
+
+	std::string value(reinterpret_cast<char const*>(m_data + m_readOffset), length);
+	m_readOffset += length;
+	return value;
+}
+
+
+bool NetReader::IsAtEnd() const
+{
+	return m_readOffset >= m_numBytes;
+}
+
+
+//
+//public protocol functions
+//
+void WritePacketHeader(NetWriter& writer, NetMessageType messageType)
+{
+	writer.Clear();
+	writer.WriteUShort(NET_PROTOCOL_ID);
+	writer.WriteByte(static_cast<unsigned char>(messageType));
+}
+
+
+bool ReadPacketHeader(NetReader& reader, NetMessageType& out_messageType)
+{
+	unsigned short protocolID = reader.ReadUShort();
+	unsigned char messageType = reader.ReadByte();
+	if (!reader.m_isValid || protocolID != NET_PROTOCOL_ID || messageType >= static_cast<unsigned char>(NetMessageType::COUNT))
+	{
+		return false;
+	}
+
+	out_messageType = static_cast<NetMessageType>(messageType);
+	return true;
+}
+
+
+void WriteFrameInput(NetWriter& writer, FrameInput const& frameInput)
+{
+	writer.WriteVarUInt(frameInput.m_buttonsDown);
+	writer.WriteVarUInt(frameInput.m_buttonsJustPressed);
+	writer.WriteVarInt(frameInput.m_cursorDelta.x);
+	writer.WriteVarInt(frameInput.m_cursorDelta.y);
+	writer.WriteByte(static_cast<unsigned char>(QuantizeToShort(frameInput.m_leftStick.x, 127.0f)));
+	writer.WriteByte(static_cast<unsigned char>(QuantizeToShort(frameInput.m_leftStick.y, 127.0f)));
+	writer.WriteByte(static_cast<unsigned char>(QuantizeToShort(frameInput.m_rightStick.x, 127.0f)));
+	writer.WriteByte(static_cast<unsigned char>(QuantizeToShort(frameInput.m_rightStick.y, 127.0f)));
+	writer.WriteByte(static_cast<unsigned char>(QuantizeToShort(frameInput.m_rightTrigger, 255.0f)));
+}
+
+
+FrameInput ReadFrameInput(NetReader& reader)
+{
+	FrameInput frameInput;
+	frameInput.m_buttonsDown = reader.ReadVarUInt();
+	frameInput.m_buttonsJustPressed = reader.ReadVarUInt();
+	frameInput.m_cursorDelta.x = reader.ReadVarInt();
+	frameInput.m_cursorDelta.y = reader.ReadVarInt();
+	frameInput.m_leftStick.x = static_cast<float>(static_cast<signed char>(reader.ReadByte())) / 127.0f;
+	frameInput.m_leftStick.y = static_cast<float>(static_cast<signed char>(reader.ReadByte())) / 127.0f;
+	frameInput.m_rightStick.x = static_cast<float>(static_cast<signed char>(reader.ReadByte())) / 127.0f;
+	frameInput.m_rightStick.y = static_cast<float>(static_cast<signed char>(reader.ReadByte())) / 127.0f;
+	frameInput.m_rightTrigger = static_cast<float>(reader.ReadByte()) / 255.0f;
+	return frameInput;
+}
+
+
+NetActorState QuantizeActor(Actor const* actor)
+{
+	NetActorState state;
+	state.m_uid = actor->m_UID.m_data;
+
+	ActorDefinition const* actorDefs = ActorDefinition::s_actorDefinitions.data();
+	int definitionIndex = static_cast<int>(actor->m_definition - actorDefs);
+	if (definitionIndex < 0 || definitionIndex >= ActorDefinition::s_actorDefinitions.size())
+	{
+		definitionIndex = static_cast<int>(actor->m_definition - ActorDefinition::s_projectileActorDefinitions.data()) | 0x8000;
+	}
+	state.m_definitionCode = static_cast<unsigned short>(definitionIndex);
+
+	state.m_position[0] = QuantizeToShort(actor->m_position.x, NET_POSITION_SCALE);
+	state.m_position[1] = QuantizeToShort(actor->m_position.y, NET_POSITION_SCALE);
+	state.m_position[2] = QuantizeToShort(actor->m_position.z, NET_POSITION_SCALE);
+	state.m_orientation[0] = QuantizeToShort(GetWrappedDegrees(actor->m_orientation.m_yawDegrees), NET_DEGREES_SCALE);
+	state.m_orientation[1] = QuantizeToShort(GetWrappedDegrees(actor->m_orientation.m_pitchDegrees), NET_DEGREES_SCALE);
+	state.m_health = static_cast<short>(GetClamped(static_cast<float>(actor->m_health), -32768.0f, 32767.0f));
+
+	if (actor->m_currentAnimGroup != nullptr)
+	{
+		state.m_animGroupIndex = static_cast<unsigned char>(actor->m_currentAnimGroup - actor->m_definition->m_animGroupDefs.data());
+	}
+	for (int weaponIndex = 0; weaponIndex < actor->m_weapons.size() && weaponIndex < NET_NO_INDEX; weaponIndex++)
+	{
+		if (actor->m_currentWeapon == actor->m_weapons[weaponIndex])
+		{
+			state.m_weaponIndex = static_cast<unsigned char>(weaponIndex);
+		}
+	}
+
+	return state;
+}
+
+
+Vec3 GetDequantizedPosition(NetActorState const& state)
+{
+	return Vec3(state.m_position[0], state.m_position[1], state.m_position[2]) * (1.0f / NET_POSITION_SCALE);
+}
+
+
+EulerAngles GetDequantizedOrientation(NetActorState const& state)
+{
+	return EulerAngles(state.m_orientation[0] / NET_DEGREES_SCALE, state.m_orientation[1] / NET_DEGREES_SCALE, 0.0f);
+}
+
+
+ActorDefinition const* GetNetActorDefinition(unsigned short definitionCode)
+{
+	bool isProjectile = (definitionCode & 0x8000) != 0;
+	int definitionIndex = definitionCode & 0x7fff;
+
+	std::vector<ActorDefinition> const& definitions = isProjectile ? ActorDefinition::s_projectileActorDefinitions : ActorDefinition::s_actorDefinitions;
+	if (definitionIndex >= definitions.size())
+	{
+		return nullptr;
+	}
+
+	return &definitions[definitionIndex];
+}
+
+
+void WriteSnapshotDelta(NetWriter& writer, std::vector<NetActorState> const& baseline, std::vector<NetActorState> const& current)
+{
+	//both lists are sorted by slot, so one merge walk finds every new, changed and removed actor
+	size_t countOffset = writer.m_data.size();
+	writer.WriteUShort(0);
+	int numEntries = 0;
+	int previousSlotIndex = 0;
+
+	size_t baselineIndex = 0;
+	size_t currentIndex = 0;
+	while (baselineIndex < baseline.size() || currentIndex < current.size())
+	{
+		int baselineSlot = baselineIndex < baseline.size() ? baseline[baselineIndex].GetSlotIndex() : INT_MAX;
+		int currentSlot = currentIndex < current.size() ? current[currentIndex].GetSlotIndex() : INT_MAX;
+
+		if (baselineSlot < currentSlot)
+		{
+			writer.WriteVarUInt(static_cast<unsigned int>(baselineSlot - previousSlotIndex));
+			writer.WriteByte(NET_ACTOR_REMOVED);
+			previousSlotIndex = baselineSlot;
+			numEntries++;
+			baselineIndex++;
+			continue;
+		}
+
+		NetActorState const& currentState = current[currentIndex];
+		if (baselineSlot == currentSlot && baseline[baselineIndex].m_uid == currentState.m_uid && baseline[baselineIndex].m_definitionCode == currentState.m_definitionCode)
+		{
+			unsigned char fieldFlags = GetChangedFieldFlags(baseline[baselineIndex], currentState);
+			if (fieldFlags != 0)
+			{
+				writer.WriteVarUInt(static_cast<unsigned int>(currentSlot - previousSlotIndex));
+				writer.WriteByte(fieldFlags);
+				WriteActorFields(writer, baseline[baselineIndex], currentState, fieldFlags);
+				previousSlotIndex = currentSlot;
+				numEntries++;
+			}
+		}
+		else
+		{
+			//a reused slot is sent as new, which replaces whatever the client had there
+			unsigned char fieldFlags = NET_ACTOR_NEW | NET_ACTOR_POSITION | NET_ACTOR_ORIENTATION | NET_ACTOR_HEALTH | NET_ACTOR_ANIMATION;
+			writer.WriteVarUInt(static_cast<unsigned int>(currentSlot - previousSlotIndex));
+			writer.WriteByte(fieldFlags);
+			writer.WriteVarUInt(static_cast<unsigned int>(currentState.m_uid >> 32));	//the slot is already known, so only the generation is sent
+			writer.WriteUShort(currentState.m_definitionCode);
+			WriteActorFields(writer, NetActorState(), currentState, fieldFlags);
+			previousSlotIndex = currentSlot;
+			numEntries++;
+		}
+
+		if (baselineSlot == currentSlot)
+		{
+			baselineIndex++;
+		}
+		currentIndex++;
+	}
+
+	writer.m_data[countOffset] = static_cast<unsigned char>(numEntries & 0xff);
+	writer.m_data[countOffset + 1] = static_cast<unsigned char>(numEntries >> 8);
+}
+
+
+bool ReadSnapshotDelta(NetReader& reader, std::vector<NetActorState> const& baseline, std::vector<NetActorState>& out_current)
+{
+	out_current.clear();
+
+	int numEntries = reader.ReadUShort();
+	int slotIndex = 0;
+	size_t baselineIndex = 0;
+
+	for (int entryIndex = 0; entryIndex < numEntries && reader.m_isValid; entryIndex++)
+	{
+		slotIndex += static_cast<int>(reader.ReadVarUInt());
+		unsigned char fieldFlags = reader.ReadByte();
+
+		//baseline actors before this entry are unchanged
+		while (baselineIndex < baseline.size() && baseline[baselineIndex].GetSlotIndex() < slotIndex)
+		{
+			out_current.push_back(baseline[baselineIndex]);
+			baselineIndex++;
+		}
+
+		bool hasBaseline = baselineIndex < baseline.size() && baseline[baselineIndex].GetSlotIndex() == slotIndex;
+		if (fieldFlags & NET_ACTOR_REMOVED)
+		{
+			if (hasBaseline)
+			{
+				baselineIndex++;
+			}
+			continue;
+		}
+
+		NetActorState state;
+		if (fieldFlags & NET_ACTOR_NEW)
+		{
+			state.m_uid = (static_cast<unsigned long long>(reader.ReadVarUInt()) << 32) | static_cast<unsigned int>(slotIndex);
+			state.m_definitionCode = reader.ReadUShort();
+			ReadActorFields(reader, NetActorState(), state, fieldFlags);
+		}
+		else
+		{
+			if (!hasBaseline)
+			{
+				return false;
+			}
+
+			state = baseline[baselineIndex];
+			ReadActorFields(reader, baseline[baselineIndex], state, fieldFlags);
+		}
+
+		if (hasBaseline)
+		{
+			baselineIndex++;
+		}
+
+		if (state.GetSlotIndex() != slotIndex)
+		{
+			return false;
+		}
+		out_current.push_back(state);
+	}
+
+	while (baselineIndex < baseline.size())
+	{
+		out_current.push_back(baseline[baselineIndex]);
+		baselineIndex++;
+	}
+
+	return reader.m_isValid;
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include "Game/InputRecording.hpp"
+#include "Game/ActorUID.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+
+
+//forward declarations
+class Actor;
+class ActorDefinition;
+
+
+constexpr unsigned short NET_PROTOCOL_ID = 0xd00f;		//bumped whenever the wire format changes
+constexpr int NET_SNAPSHOT_HISTORY = 32;				//snapshots kept on both ends as delta baselines
+constexpr int NET_REDUNDANT_INPUTS = 3;					//each input packet repeats the last few frames so one lost packet drops nothing
+constexpr float NET_POSITION_SCALE = 128.0f;			//1/128 of a tile, +-256 tiles fit in a short
+constexpr float NET_DEGREES_SCALE = 32768.0f / 180.0f;
+constexpr unsigned char NET_NO_INDEX = 255;
+
+
+enum class NetMessageType : unsigned char
+{
+	CLIENT_HELLO,
+	SERVER_WELCOME,
+	SERVER_FULL,
+	CLIENT_INPUT,
+	SERVER_SNAPSHOT,
+	CLIENT_DISCONNECT,
+	COUNT
+};
+
+
+//which fields follow an actor entry in a snapshot, anything not flagged matches the baseline
+enum NetActorFieldFlags : unsigned char
+{
+	NET_ACTOR_NEW			= 1 << 0,	//no baseline, every field follows
+	NET_ACTOR_REMOVED		= 1 << 1,
+	NET_ACTOR_POSITION		= 1 << 2,
+	NET_ACTOR_ORIENTATION	= 1 << 3,
+	NET_ACTOR_HEALTH		= 1 << 4,
+	NET_ACTOR_ANIMATION		= 1 << 5,
+};
+
+
+//quantized replicated actor, only ever compared bitwise so quantization noise never causes resends
+struct NetActorState
+{
+	unsigned long long m_uid = ActorUID::INVALID_DATA;
+	unsigned short	   m_definitionCode = 0;	//top bit set for projectile definitions
+	short			   m_position[3] = {};
+	short			   m_orientation[2] = {};	//yaw and pitch
+	short			   m_health = 0;
+	unsigned char	   m_animGroupIndex = NET_NO_INDEX;
+	unsigned char	   m_weaponIndex = NET_NO_INDEX;
+
+	int GetSlotIndex() const;
+};
+
+
+//byte stream with varints, reads past the end return zero and mark the stream invalid
+class NetWriter
+{
+//public member functions
+public:
+	void Clear();
+	void WriteByte(unsigned char value);
+	void WriteUShort(unsigned short value);
+	void WriteUInt(unsigned int value);
+	void WriteVarUInt(unsigned int value);
+	void WriteVarInt(int value);
+	void WriteString(std::string const& value);
+
+//public member variables
+public:
+	std::vector<unsigned char> m_data;
+};
+
+
+class NetReader
+{
+//public member functions
+public:
+	//constructor
+	NetReader(unsigned char const* data, int numBytes);
+
+	//read functions
+	unsigned char  ReadByte();
+	unsigned short ReadUShort();
+	unsigned int   ReadUInt();
+	unsigned int   ReadVarUInt();
+	int			   ReadVarInt();
+	std::string	   ReadString();
+
+	//accessors
+	bool IsAtEnd() const;
+
+//public member variables
+public:
+	unsigned char const* m_data = nullptr;
+	int					 m_numBytes = 0;
+	int					 m_readOffset = 0;
+	bool				 m_isValid = true;
+};
+
+
+//protocol functions
+void		 WritePacketHeader(NetWriter& writer, NetMessageType messageType);
+bool		 ReadPacketHeader(NetReader& reader, NetMessageType& out_messageType);
+void		 WriteFrameInput(NetWriter& writer, FrameInput const& frameInput);
+FrameInput	 ReadFrameInput(NetReader& reader);
+
+NetActorState		   QuantizeActor(Actor const* actor);
+Vec3				   GetDequantizedPosition(NetActorState const& state);
+EulerAngles			   GetDequantizedOrientation(NetActorState const& state);
+ActorDefinition const* GetNetActorDefinition(unsigned short definitionCode);
+
+void WriteSnapshotDelta(NetWriter& writer, std::vector<NetActorState> const& baseline, std::vector<NetActorState> const& current);
+bool ReadSnapshotDelta(NetReader& reader, std::vector<NetActorState> const& baseline, std::vector<NetActorState>& out_current);
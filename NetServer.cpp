@@ -0,0 +1,390 @@
+#include "Game/NetServer.hpp"
+#include "Game/Map.hpp"
+#include "Game/MapDefinition.hpp"
+#include "Game/Game.hpp"
+#include "Game/Player.hpp"
+#include "Game/Actor.hpp"
+#include "Game/GameCommon.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include <algorithm>
+
+
+//a snapshot that doesn't fit in one packet is rebuilt with the interest radius scaled by this until it fits or gets this small
+static const float k_interestRadiusShrinkFactor = 0.75f;
+static const float k_minInterestRadius = 2.0f;
+
+
+//
+//constructor and destructor
+//
+NetServer::NetServer(Map* map, NetTransport* transport, bool isHeadless)
+	: m_map(map)
+	, m_transport(transport)
+	, m_isHeadless(isHeadless)
+{
+	float tickRate = g_gameConfigBlackboard.GetValue("simulationTickRate", 60.0f);
+	float snapshotRate = g_gameConfigBlackboard.GetValue("netSnapshotRate", 20.0f);
+	m_ticksPerSnapshot = static_cast<int>(roundf(tickRate / snapshotRate));
+	if (m_ticksPerSnapshot < 1)
+	{
+		m_ticksPerSnapshot = 1;
+	}
+	m_interestRadius = g_gameConfigBlackboard.GetValue("netInterestRadius", 24.0f);
+	m_timeoutSeconds = g_gameConfigBlackboard.GetValue("netTimeoutSeconds", 5.0f);
+	m_lastReportSeconds = GetCurrentTimeSeconds();
+}
+
+
+NetServer::~NetServer()
+{
+	DisconnectAll();
+
+	delete m_transport;
+	m_transport = nullptr;
+}
+
+
+//
+//public server flow functions
+//
+void NetServer::ReceivePackets()
+{
+	m_receivedPackets.clear();
+	m_transport->Receive(m_receivedPackets);
+
+	for (int packetIndex = 0; packetIndex < m_receivedPackets.size(); packetIndex++)
+	{
+		NetPacket const& packet = m_receivedPackets[packetIndex];
+		NetReader reader(packet.m_data.data(), static_cast<int>(packet.m_data.size()));
+
+		NetMessageType messageType;
+		if (!ReadPacketHeader(reader, messageType))
+		{
+			continue;
+		}
+
+		if (messageType == NetMessageType::CLIENT_HELLO)
+		{
+			HandleHello(packet, reader);
+			continue;
+		}
+
+		int clientIndex = GetClientIndex(packet.m_connectionID);
+		if (clientIndex == -1)
+		{
+			continue;
+		}
+
+		m_clients[clientIndex].m_lastReceiveSeconds = GetCurrentTimeSeconds();
+		if (messageType == NetMessageType::CLIENT_INPUT)
+		{
+			HandleInput(m_clients[clientIndex], reader);
+		}
+		else if (messageType == NetMessageType::CLIENT_DISCONNECT)
+		{
+			DropClient(clientIndex);
+		}
+	}
+
+	//clients that went quiet lose their player
+	double currentSeconds = GetCurrentTimeSeconds();
+	for (int clientIndex = static_cast<int>(m_clients.size()) - 1; clientIndex >= 0; clientIndex--)
+	{
+		if (currentSeconds - m_clients[clientIndex].m_lastReceiveSeconds > m_timeoutSeconds)
+		{
+			DropClient(clientIndex);
+		}
+	}
+}
+
+
+void NetServer::EndTick(double tickSeconds)
+{
+	m_currentTick++;
+	m_tickSecondsSinceReport += tickSeconds;
+	m_ticksSinceReport++;
+
+	if (m_currentTick % m_ticksPerSnapshot == 0)
+	{
+		SendSnapshots();
+	}
+}
+
+
+void NetServer::SendSnapshots()
+{
+	for (int clientIndex = 0; clientIndex < m_clients.size(); clientIndex++)
+	{
+		NetClientConnection& client = m_clients[clientIndex];
+
+		//delta against the newest snapshot the client has confirmed, or send everything if that has fallen out of the history
+		static std::vector<NetActorState> const s_emptyBaseline;
+		unsigned int baselineTick = 0;
+		int baselineIndex = client.m_ackedTick % NET_SNAPSHOT_HISTORY;
+		if (client.m_ackedTick != 0 && client.m_sentTicks[baselineIndex] == client.m_ackedTick && m_currentTick - client.m_ackedTick < NET_SNAPSHOT_HISTORY)
+		{
+			baselineTick = client.m_ackedTick;
+		}
+		else
+		{
+			client.m_numFullSnapshots++;
+		}
+		std::vector<NetActorState> const& baselineStates = baselineTick != 0 ? client.m_sentStates[baselineIndex] : s_emptyBaseline;
+
+		Actor const* playerActor = m_map->m_currentPlayerActors[client.m_playerIndex];
+		ActorUID playerActorUID = playerActor != nullptr ? playerActor->m_UID : ActorUID(ActorUID::INVALID, ActorUID::INVALID);
+
+		//a snapshot too big for one packet never arrives, and a lost full snapshot leaves the client without a baseline for good,
+		//so pull the interest set in until it fits, the client is told to remove whatever falls outside it
+		int historyIndex = m_currentTick % NET_SNAPSHOT_HISTORY;
+		std::vector<NetActorState>& currentStates = client.m_sentStates[historyIndex];
+		float interestRadius = m_interestRadius;
+		while (true)
+		{
+			GatherClientActorStates(client, interestRadius, currentStates);
+
+			WritePacketHeader(m_writer, NetMessageType::SERVER_SNAPSHOT);
+			m_writer.WriteUInt(m_currentTick);
+			m_writer.WriteUInt(baselineTick);
+			m_writer.WriteUInt(playerActorUID.GetIndex());
+			m_writer.WriteUInt(playerActorUID.GetGeneration());
+			WriteSnapshotDelta(m_writer, baselineStates, currentStates);
+
+			if (m_writer.m_data.size() <= NET_MAX_PACKET_BYTES || interestRadius <= k_minInterestRadius)
+			{
+				break;
+			}
+			interestRadius *= k_interestRadiusShrinkFactor;
+		}
+
+		if (interestRadius < m_interestRadius)
+		{
+			client.m_numShrunkSnapshots++;
+			if (client.m_numShrunkSnapshots == 1)
+			{
+				g_theDevConsole->AddLine(DevConsole::COLOR_WARNING, Stringf("Snapshot for player %d is over %d bytes, shrinking its interest radius to fit", client.m_playerIndex,
+					NET_MAX_PACKET_BYTES));
+			}
+		}
+
+		if (m_writer.m_data.size() > NET_MAX_PACKET_BYTES)
+		{
+			//nothing usable went out, so this tick can't become a baseline
+			client.m_sentTicks[historyIndex] = 0;
+			client.m_numDroppedSnapshots++;
+			if (client.m_numDroppedSnapshots == 1)
+			{
+				g_theDevConsole->AddLine(DevConsole::COLOR_WARNING, Stringf("Snapshot for player %d is over %d bytes even at the minimum interest radius, dropping it",
+					client.m_playerIndex, NET_MAX_PACKET_BYTES));
+			}
+			continue;
+		}
+
+		client.m_sentTicks[historyIndex] = m_currentTick;
+
+		m_transport->Send(client.m_connectionID, m_writer.m_data.data(), static_cast<int>(m_writer.m_data.size()));
+		client.m_bytesSent += m_writer.m_data.size();
+		client.m_bytesSentSinceReport += m_writer.m_data.size();
+	}
+}
+
+
+void NetServer::DisconnectAll()
+{
+	WritePacketHeader(m_writer, NetMessageType::CLIENT_DISCONNECT);
+	for (int clientIndex = static_cast<int>(m_clients.size()) - 1; clientIndex >= 0; clientIndex--)
+	{
+		m_transport->Send(m_clients[clientIndex].m_connectionID, m_writer.m_data.data(), static_cast<int>(m_writer.m_data.size()));
+		DropClient(clientIndex);
+	}
+}
+
+
+//
+//public stats functions
+//
+std::string NetServer::GetStatsReport()
+{
+	double currentSeconds = GetCurrentTimeSeconds();
+	double elapsedSeconds = currentSeconds - m_lastReportSeconds;
+	if (elapsedSeconds <= 0.0)
+	{
+		elapsedSeconds = 1.0;
+	}
+
+	double averageTickMS = m_ticksSinceReport > 0 ? 1000.0 * m_tickSecondsSinceReport / m_ticksSinceReport : 0.0;
+	std::string report = Stringf("Server: %d clients, tick %u, %.3f ms per tick, snapshot every %d ticks%s\n", static_cast<int>(m_clients.size()), m_currentTick, averageTickMS,
+		m_ticksPerSnapshot, m_isHeadless ? ", headless" : "");
+
+	for (int clientIndex = 0; clientIndex < m_clients.size(); clientIndex++)
+	{
+		NetClientConnection& client = m_clients[clientIndex];
+		double kbps = static_cast<double>(client.m_bytesSentSinceReport) * 8.0 / 1000.0 / elapsedSeconds;
+		report += Stringf("  player %d: %.1f kbps down, acked tick %u, %d full snapshots, %d shrunk to fit, %d dropped, %lld bytes total\n", client.m_playerIndex, kbps,
+			client.m_ackedTick, client.m_numFullSnapshots, client.m_numShrunkSnapshots, client.m_numDroppedSnapshots, client.m_bytesSent);
+		client.m_bytesSentSinceReport = 0;
+	}
+
+	m_tickSecondsSinceReport = 0.0;
+	m_ticksSinceReport = 0;
+	m_lastReportSeconds = currentSeconds;
+	return report;
+}
+
+
+//
+//private server functions
+//
+void NetServer::HandleHello(NetPacket const& packet, NetReader& reader)
+{
+	int xboxID = static_cast<signed char>(reader.ReadByte());
+	if (!reader.m_isValid)
+	{
+		return;
+	}
+
+	//hellos repeat until the welcome gets through, so a known client just gets another welcome
+	int clientIndex = GetClientIndex(packet.m_connectionID);
+	if (clientIndex == -1)
+	{
+		int playerIndex = m_map->AddRemotePlayer(xboxID);
+		if (playerIndex == -1)
+		{
+			WritePacketHeader(m_writer, NetMessageType::SERVER_FULL);
+			m_transport->Send(packet.m_connectionID, m_writer.m_data.data(), static_cast<int>(m_writer.m_data.size()));
+			return;
+		}
+
+		NetClientConnection client;
+		client.m_connectionID = packet.m_connectionID;
+		client.m_playerIndex = playerIndex;
+		m_clients.push_back(client);
+		clientIndex = static_cast<int>(m_clients.size()) - 1;
+	}
+
+	NetClientConnection& client = m_clients[clientIndex];
+	client.m_lastReceiveSeconds = GetCurrentTimeSeconds();
+
+	WritePacketHeader(m_writer, NetMessageType::SERVER_WELCOME);
+	m_writer.WriteByte(static_cast<unsigned char>(client.m_playerIndex));
+	m_writer.WriteString(m_map->m_definition->m_name);
+	m_writer.WriteByte(m_map->m_owner->m_isLightsOutMode ? 1 : 0);
+	m_transport->Send(client.m_connectionID, m_writer.m_data.data(), static_cast<int>(m_writer.m_data.size()));
+}
+
+
+void NetServer::HandleInput(NetClientConnection& client, NetReader& reader)
+{
+	unsigned int ackedTick = reader.ReadUInt();
+	unsigned int newestSequence = reader.ReadUInt();
+	int numInputs = reader.ReadByte();
+
+	FrameInput inputs[NET_REDUNDANT_INPUTS];
+	if (numInputs > NET_REDUNDANT_INPUTS)
+	{
+		numInputs = NET_REDUNDANT_INPUTS;
+	}
+	for (int inputIndex = 0; inputIndex < numInputs; inputIndex++)
+	{
+		inputs[inputIndex] = ReadFrameInput(reader);
+	}
+
+	if (!reader.m_isValid)
+	{
+		return;
+	}
+
+	if (ackedTick > client.m_ackedTick && ackedTick <= m_currentTick)
+	{
+		client.m_ackedTick = ackedTick;
+	}
+
+	Player* player = m_map->m_players[client.m_playerIndex];
+	if (player == nullptr)
+	{
+		return;
+	}
+
+	//inputs come newest first, merge the ones not seen yet oldest first so presses and mouse motion from a lost packet still land
+	for (int inputIndex = numInputs - 1; inputIndex >= 0; inputIndex--)
+	{
+		if (static_cast<unsigned int>(inputIndex) >= newestSequence)
+		{
+			continue;
+		}
+
+		unsigned int sequence = newestSequence - inputIndex;
+		if (sequence <= client.m_lastInputSequence)
+		{
+			continue;
+		}
+
+		FrameInput const& input = inputs[inputIndex];
+		player->m_frameInput.m_buttonsDown = input.m_buttonsDown;
+		player->m_frameInput.m_buttonsJustPressed |= input.m_buttonsJustPressed;
+		player->m_frameInput.m_cursorDelta = player->m_frameInput.m_cursorDelta + input.m_cursorDelta;
+		player->m_frameInput.m_leftStick = input.m_leftStick;
+		player->m_frameInput.m_rightStick = input.m_rightStick;
+		player->m_frameInput.m_rightTrigger = input.m_rightTrigger;
+		client.m_lastInputSequence = sequence;
+	}
+}
+
+
+void NetServer::DropClient(int clientIndex)
+{
+	m_map->RemovePlayer(m_clients[clientIndex].m_playerIndex);
+	m_clients.erase(m_clients.begin() + clientIndex);
+}
+
+
+int NetServer::GetClientIndex(int connectionID) const
+{
+	for (int clientIndex = 0; clientIndex < m_clients.size(); clientIndex++)
+	{
+		if (m_clients[clientIndex].m_connectionID == connectionID)
+		{
+			return clientIndex;
+		}
+	}
+
+	return -1;
+}
+
+
+void NetServer::GatherClientActorStates(NetClientConnection const& client, float interestRadius, std::vector<NetActorState>& out_states)
+{
+	out_states.clear();
+
+	//clients only hear about actors near their player, plus their own actor wherever it is
+	Player const* player = m_map->m_players[client.m_playerIndex];
+	Actor const* playerActor = m_map->m_currentPlayerActors[client.m_playerIndex];
+
+	ActorRadiusQuery query;
+	query.m_center = playerActor != nullptr ? playerActor->m_position : player->m_position;
+	query.m_radius = interestRadius;
+	m_map->GetActorsInRadius(query, m_queryActors);
+	if (playerActor != nullptr && std::find(m_queryActors.begin(), m_queryActors.end(), playerActor) == m_queryActors.end())
+	{
+		m_queryActors.push_back(const_cast<Actor*>(playerActor));
+	}
+
+	for (int actorIndex = 0; actorIndex < m_queryActors.size(); actorIndex++)
+	{
+		if (!m_queryActors[actorIndex]->m_isGarbage)
+		{
+			out_states.push_back(QuantizeActor(m_queryActors[actorIndex]));
+		}
+	}
+
+	//deltas walk both lists by slot
+	std::sort(out_states.begin(), out_states.end(), [](NetActorState const& stateA, NetActorState const& stateB)
+	{
+		return stateA.GetSlotIndex() < stateB.GetSlotIndex();
+	});
+	out_states.erase(std::unique(out_states.begin(), out_states.end(), [](NetActorState const& stateA, NetActorState const& stateB)
+	{
+		return stateA.GetSlotIndex() == stateB.GetSlotIndex();
+	}), out_states.end());
+}
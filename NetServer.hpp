@@ -0,0 +1,78 @@
+#pragma once
+#include "Game/NetProtocol.hpp"
+#include "Game/NetTransport.hpp"
+
+
+//forward declarations
+class Map;
+
+
+struct NetClientConnection
+{
+	int			 m_connectionID = NET_INVALID_CONNECTION;
+	int			 m_playerIndex = -1;
+	unsigned int m_lastInputSequence = 0;
+	unsigned int m_ackedTick = 0;					//0 until the client has acked a snapshot, which forces full snapshots
+	double		 m_lastReceiveSeconds = 0.0;
+
+	//sent snapshots by tick, used as delta baselines once acked
+	std::vector<NetActorState> m_sentStates[NET_SNAPSHOT_HISTORY];
+	unsigned int			   m_sentTicks[NET_SNAPSHOT_HISTORY] = {};
+
+	long long m_bytesSent = 0;
+	long long m_bytesSentSinceReport = 0;
+	int		  m_numFullSnapshots = 0;
+	int		  m_numShrunkSnapshots = 0;		//sent with a smaller interest radius because the full one didn't fit in a packet
+	int		  m_numDroppedSnapshots = 0;	//too big even at the minimum interest radius
+};
+
+
+//owns the authoritative map, applies client inputs to remote players and sends each client a delta snapshot of what is near them
+class NetServer
+{
+//public member functions
+public:
+	//constructor and destructor
+	NetServer(Map* map, NetTransport* transport, bool isHeadless);
+	~NetServer();
+
+	//server flow functions
+	void ReceivePackets();
+	void EndTick(double tickSeconds);
+	void SendSnapshots();
+	void DisconnectAll();
+
+	//stats functions
+	std::string GetStatsReport();
+
+//public member variables
+public:
+	Map*		  m_map = nullptr;
+	NetTransport* m_transport = nullptr;
+	bool		  m_isHeadless = false;
+
+	std::vector<NetClientConnection> m_clients;
+	unsigned int					 m_currentTick = 0;
+	int								 m_ticksPerSnapshot = 3;
+	float							 m_interestRadius = 24.0f;
+	float							 m_timeoutSeconds = 5.0f;
+
+	//tick cost and bandwidth since the last report
+	double m_tickSecondsSinceReport = 0.0;
+	int	   m_ticksSinceReport = 0;
+	double m_lastReportSeconds = 0.0;
+
+//private member functions
+private:
+	void HandleHello(NetPacket const& packet, NetReader& reader);
+	void HandleInput(NetClientConnection& client, NetReader& reader);
+	void DropClient(int clientIndex);
+	int	 GetClientIndex(int connectionID) const;
+	void GatherClientActorStates(NetClientConnection const& client, float interestRadius, std::vector<NetActorState>& out_states);
+
+//private member variables
+private:
+	std::vector<NetPacket> m_receivedPackets;
+	std::vector<Actor*>	   m_queryActors;
+	NetWriter			   m_writer;
+};
@@ -0,0 +1,233 @@
+#include "Game/NetTransport.hpp"
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+typedef int socklen_t;
+typedef SOCKET NativeSocket;
+static const unsigned long long k_invalidSocket = INVALID_SOCKET;
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+typedef int NativeSocket;
+static const unsigned long long k_invalidSocket = ~0ull;
+#endif
+
+
+//
+//static helper functions
+//
+static NativeSocket GetNativeSocket(unsigned long long socketHandle)
+{
+	return static_cast<NativeSocket>(socketHandle);
+}
+
+
+//
+//constructors
+//
+LoopbackNetwork::LoopbackNetwork(int numEndpoints)
+{
+	m_inboxes.resize(numEndpoints);
+}
+
+
+LoopbackTransport::LoopbackTransport(LoopbackNetwork* network, int endpointIndex)
+	: m_network(network)
+	, m_endpointIndex(endpointIndex)
+{
+}
+
+
+//
+//public loopback transport utilities
+//
+void LoopbackTransport::Send(int connectionID, unsigned char const* data, int numBytes)
+{
+	if (connectionID < 0 || connectionID >= m_network->m_inboxes.size())
+	{
+		return;
+	}
+
+	//endpoint indexes double as connection IDs, so the receiver sees the sender's index
+	NetPacket packet;
+	packet.m_connectionID = m_endpointIndex;
+	packet.m_data.assign(data, data + numBytes);
+	m_network->m_inboxes[connectionID].push_back(packet);
+
+	m_totalBytesSent += numBytes;
+}
+
+
+void LoopbackTransport::Receive(std::vector<NetPacket>& out_packets)
+{
+	std::deque<NetPacket>& inbox = m_network->m_inboxes[m_endpointIndex];
+	while (!inbox.empty())
+	{
+		m_totalBytesReceived += static_cast<int>(inbox.front().m_data.size());
+		out_packets.push_back(inbox.front());
+		inbox.pop_front();
+	}
+}
+
+
+//
+//udp constructor and destructor
+//
+UdpTransport::UdpTransport()
+	: m_socket(k_invalidSocket)
+{
+#if defined(_WIN32)
+	WSADATA wsaData;
+	WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+
+	m_receiveBuffer.resize(NET_MAX_PACKET_BYTES);
+}
+
+
+UdpTransport::~UdpTransport()
+{
+	if (m_socket != k_invalidSocket)
+	{
+#if defined(_WIN32)
+		closesocket(GetNativeSocket(m_socket));
+#else
+		close(GetNativeSocket(m_socket));
+#endif
+	}
+
+#if defined(_WIN32)
+	WSACleanup();
+#endif
+}
+
+
+//
+//public socket functions
+//
+bool UdpTransport::Bind(unsigned short port)
+{
+	if (m_socket == k_invalidSocket)
+	{
+		m_socket = static_cast<unsigned long long>(socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
+		if (m_socket == k_invalidSocket)
+		{
+			return false;
+		}
+
+		//the game polls once per frame, so reads can never block
+#if defined(_WIN32)
+		u_long isNonBlocking = 1;
+		ioctlsocket(GetNativeSocket(m_socket), FIONBIO, &isNonBlocking);
+#else
+		fcntl(GetNativeSocket(m_socket), F_SETFL, O_NONBLOCK);
+#endif
+	}
+
+	sockaddr_in bindAddress = {};
+	bindAddress.sin_family = AF_INET;
+	bindAddress.sin_addr.s_addr = htonl(INADDR_ANY);
+	bindAddress.sin_port = htons(port);
+
+	return bind(GetNativeSocket(m_socket), reinterpret_cast<sockaddr*>(&bindAddress), sizeof(bindAddress)) == 0;
+}
+
+
+int UdpTransport::Connect(std::string const& hostAddress, unsigned short port)
+{
+	//clients bind to any free port
+	if (m_socket == k_invalidSocket && !Bind(0))
+	{
+		return NET_INVALID_CONNECTION;
+	}
+
+	std::string numericAddress = hostAddress == "localhost" ? "127.0.0.1" : hostAddress;
+	in_addr address = {};
+	if (inet_pton(AF_INET, numericAddress.c_str(), &address) != 1)
+	{
+		return NET_INVALID_CONNECTION;
+	}
+
+	UdpPeer peer;
+	peer.m_address = address.s_addr;
+	peer.m_port = htons(port);
+	return GetConnectionID(peer);
+}
+
+
+//
+//public udp transport utilities
+//
+void UdpTransport::Send(int connectionID, unsigned char const* data, int numBytes)
+{
+	if (m_socket == k_invalidSocket || connectionID < 0 || connectionID >= m_peers.size() || numBytes > NET_MAX_PACKET_BYTES)
+	{
+		return;
+	}
+
+	sockaddr_in toAddress = {};
+	toAddress.sin_family = AF_INET;
+	toAddress.sin_addr.s_addr = m_peers[connectionID].m_address;
+	toAddress.sin_port = m_peers[connectionID].m_port;
+
+	int numBytesSent = static_cast<int>(sendto(GetNativeSocket(m_socket), reinterpret_cast<char const*>(data), numBytes, 0, reinterpret_cast<sockaddr*>(&toAddress), sizeof(toAddress)));
+	if (numBytesSent > 0)
+	{
+		m_totalBytesSent += numBytesSent;
+	}
+}
+
+
+void UdpTransport::Receive(std::vector<NetPacket>& out_packets)
+{
+	if (m_socket == k_invalidSocket)
+	{
+		return;
+	}
+
+	while (true)
+	{
+		sockaddr_in fromAddress = {};
+		socklen_t fromAddressSize = sizeof(fromAddress);
+		int numBytesReceived = static_cast<int>(recvfrom(GetNativeSocket(m_socket), reinterpret_cast<char*>(m_receiveBuffer.data()), NET_MAX_PACKET_BYTES, 0,
+			reinterpret_cast<sockaddr*>(&fromAddress), &fromAddressSize));
+		if (numBytesReceived <= 0)
+		{
+			break;
+		}
+
+		UdpPeer peer;
+		peer.m_address = fromAddress.sin_addr.s_addr;
+		peer.m_port = fromAddress.sin_port;
+
+		NetPacket packet;
+		packet.m_connectionID = GetConnectionID(peer);
+		packet.m_data.assign(m_receiveBuffer.begin(), m_receiveBuffer.begin() + numBytesReceived);
+		out_packets.push_back(packet);
+
+		m_totalBytesReceived += numBytesReceived;
+	}
+}
+
+
+//
+//public accessors
+//
+int UdpTransport::GetConnectionID(UdpPeer const& peer)
+{
+	for (int peerIndex = 0; peerIndex < m_peers.size(); peerIndex++)
+	{
+		if (m_peers[peerIndex].m_address == peer.m_address && m_peers[peerIndex].m_port == peer.m_port)
+		{
+			return peerIndex;
+		}
+	}
+
+	m_peers.push_back(peer);
+	return static_cast<int>(m_peers.size()) - 1;
+}
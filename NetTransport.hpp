@@ -0,0 +1,101 @@
+#pragma once
+#include "Engine/Core/EngineCommon.hpp"
+#include <deque>
+
+
+//connection IDs are local to a transport, servers see one per client and clients see the server as connection 0
+constexpr int NET_INVALID_CONNECTION = -1;
+constexpr int NET_MAX_PACKET_BYTES = 65507;	//largest udp payload, localhost never fragments in practice
+
+
+struct NetPacket
+{
+	int						   m_connectionID = NET_INVALID_CONNECTION;
+	std::vector<unsigned char> m_data;
+};
+
+
+//unreliable, unordered datagrams, which is all the snapshot protocol needs
+class NetTransport
+{
+//public member functions
+public:
+	//constructor and destructor
+	NetTransport() = default;
+	virtual ~NetTransport() = default;
+
+	//transport utilities
+	virtual void Send(int connectionID, unsigned char const* data, int numBytes) = 0;
+	virtual void Receive(std::vector<NetPacket>& out_packets) = 0;
+
+//public member variables
+public:
+	long long m_totalBytesSent = 0;
+	long long m_totalBytesReceived = 0;
+};
+
+
+//in-process network where every endpoint has an inbox, for testing the protocol without sockets
+class LoopbackNetwork
+{
+//public member functions
+public:
+	//constructor
+	explicit LoopbackNetwork(int numEndpoints);
+
+//public member variables
+public:
+	std::vector<std::deque<NetPacket>> m_inboxes;
+};
+
+
+class LoopbackTransport : public NetTransport
+{
+//public member functions
+public:
+	//constructor
+	LoopbackTransport(LoopbackNetwork* network, int endpointIndex);
+
+	//transport utilities
+	void Send(int connectionID, unsigned char const* data, int numBytes) override;
+	void Receive(std::vector<NetPacket>& out_packets) override;
+
+//public member variables
+public:
+	LoopbackNetwork* m_network = nullptr;
+	int				 m_endpointIndex = 0;
+};
+
+
+struct UdpPeer
+{
+	unsigned int   m_address = 0;	//both in network byte order
+	unsigned short m_port = 0;
+};
+
+
+class UdpTransport : public NetTransport
+{
+//public member functions
+public:
+	//constructor and destructor
+	UdpTransport();
+	~UdpTransport() override;
+
+	//socket functions
+	bool Bind(unsigned short port);
+	int	 Connect(std::string const& hostAddress, unsigned short port);
+
+	//transport utilities
+	void Send(int connectionID, unsigned char const* data, int numBytes) override;
+	void Receive(std::vector<NetPacket>& out_packets) override;
+
+	//accessors
+	int GetConnectionID(UdpPeer const& peer);
+
+//public member variables
+public:
+	unsigned long long		   m_socket;
+	std::vector<UdpPeer>	   m_peers;			//index is the connection ID
+	std::vector<unsigned char> m_receiveBuffer;
+};
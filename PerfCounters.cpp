@@ -0,0 +1,255 @@
+#include "Game/PerfCounters.hpp"
+#include "Game/Map.hpp"
+#include "Game/Actor.hpp"
+#include "Game/ActorDefinition.hpp"
+#include "Game/GameCommon.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/Vertex_PCU.hpp"
+#include "Engine/Renderer/Renderer.hpp"
+#include "Engine/Renderer/BitmapFont.hpp"
+#include <map>
+
+
+PerfCounters g_perfCounters;
+
+
+//upper edge of each frame time bucket in milliseconds, the last bucket catches everything slower
+static const float k_frameTimeBucketMaxMilliseconds[PERF_FRAME_TIME_BUCKETS] = { 8.0f, 16.7f, 33.3f, 50.0f, 100.0f, FLT_MAX };
+static const int k_maxHistogramBarLength = 40;
+
+
+//
+//static helper functions
+//
+static bool Event_PerfCounters(EventArgs& args)
+{
+	UNUSED(args);
+
+	//split the report into console lines
+	std::string report = g_perfCounters.GetReport();
+	size_t lineStart = 0;
+	while (lineStart < report.size())
+	{
+		size_t lineEnd = report.find('\n', lineStart);
+		if (lineEnd == std::string::npos)
+		{
+			lineEnd = report.size();
+		}
+
+		g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, report.substr(lineStart, lineEnd - lineStart));
+		lineStart = lineEnd + 1;
+	}
+
+	return true;
+}
+
+
+static bool Event_PerfOverlay(EventArgs& args)
+{
+	UNUSED(args);
+
+	g_perfCounters.m_isOverlayVisible = !g_perfCounters.m_isOverlayVisible;
+	return true;
+}
+
+
+//
+//public frame flow functions
+//
+void PerfCounters::EndFrame(float frameSeconds, Map const* currentMap)
+{
+	m_currentMap = currentMap;
+
+	//retire the oldest frame out of the window before writing this one over it
+	if (m_numHistoryFrames == PERF_COUNTER_HISTORY_FRAMES)
+	{
+		for (int counterIndex = 0; counterIndex < (int)PerfCounter::COUNT; counterIndex++)
+		{
+			m_historySums[counterIndex] -= m_history[counterIndex][m_historyIndex];
+		}
+
+		m_frameSecondsSum -= m_frameSecondsHistory[m_historyIndex];
+		m_frameTimeHistogram[GetFrameTimeBucket(m_frameSecondsHistory[m_historyIndex])]--;
+	}
+	else
+	{
+		m_numHistoryFrames++;
+	}
+
+	for (int counterIndex = 0; counterIndex < (int)PerfCounter::COUNT; counterIndex++)
+	{
+		m_history[counterIndex][m_historyIndex] = m_currentFrameCounts[counterIndex];
+		m_historySums[counterIndex] += m_currentFrameCounts[counterIndex];
+		m_currentFrameCounts[counterIndex] = 0;
+	}
+
+	m_frameSecondsHistory[m_historyIndex] = frameSeconds;
+	m_frameSecondsSum += frameSeconds;
+	m_frameTimeHistogram[GetFrameTimeBucket(frameSeconds)]++;
+
+	m_historyIndex = (m_historyIndex + 1) % PERF_COUNTER_HISTORY_FRAMES;
+}
+
+
+//
+//public accessors
+//
+float PerfCounters::GetAverage(PerfCounter counter) const
+{
+	if (m_numHistoryFrames == 0)
+	{
+		return 0.0f;
+	}
+
+	return static_cast<float>(m_historySums[(int)counter]) / static_cast<float>(m_numHistoryFrames);
+}
+
+
+float PerfCounters::GetAverageFrameSeconds() const
+{
+	if (m_numHistoryFrames == 0)
+	{
+		return 0.0f;
+	}
+
+	return m_frameSecondsSum / static_cast<float>(m_numHistoryFrames);
+}
+
+
+int PerfCounters::GetNumHistoryFrames() const
+{
+	return m_numHistoryFrames;
+}
+
+
+std::string PerfCounters::GetReport() const
+{
+	std::string report = Stringf("Frame time: %.2f ms average over %d frames\n", GetAverageFrameSeconds() * 1000.0f, m_numHistoryFrames);
+
+	int lastFrameIndex = (m_historyIndex + PERF_COUNTER_HISTORY_FRAMES - 1) % PERF_COUNTER_HISTORY_FRAMES;
+	for (int counterIndex = 0; counterIndex < (int)PerfCounter::COUNT; counterIndex++)
+	{
+		report += Stringf("%-26s avg %10.1f  last %8d\n", GetCounterName((PerfCounter)counterIndex), GetAverage((PerfCounter)counterIndex), m_history[counterIndex][lastFrameIndex]);
+	}
+
+	report += "Frame time histogram:\n";
+	for (int bucketIndex = 0; bucketIndex < PERF_FRAME_TIME_BUCKETS; bucketIndex++)
+	{
+		int numFrames = m_frameTimeHistogram[bucketIndex];
+		int barLength = m_numHistoryFrames > 0 ? (numFrames * k_maxHistogramBarLength) / m_numHistoryFrames : 0;
+		report += Stringf("%-10s %4d %s\n", GetFrameTimeBucketName(bucketIndex), numFrames, std::string(barLength, '#').c_str());
+	}
+
+	if (m_currentMap != nullptr)
+	{
+		std::map<std::string, int> actorCountsByDefinition;
+		int numActors = static_cast<int>(m_currentMap->m_liveActors.size());
+		for (int actorIndex = 0; actorIndex < numActors; actorIndex++)
+		{
+			actorCountsByDefinition[m_currentMap->m_liveActors[actorIndex]->m_definition->m_name]++;
+		}
+
+		int numTiles = m_currentMap->m_dimensions.x * m_currentMap->m_dimensions.y;
+		report += Stringf("Tile grid: %d tiles, %d bytes, %.2f bytes per tile\n", numTiles, m_currentMap->GetTileGridBytes(), numTiles > 0 ? static_cast<float>(m_currentMap->GetTileGridBytes()) / static_cast<float>(numTiles) : 0.0f);
+		report += Stringf("Active actors: %d\n", numActors);
+		for (auto countIter = actorCountsByDefinition.begin(); countIter != actorCountsByDefinition.end(); countIter++)
+		{
+			report += Stringf("  %-24s %d\n", countIter->first.c_str(), countIter->second);
+		}
+	}
+
+	return report;
+}
+
+
+//
+//static accessors
+//
+char const* PerfCounters::GetCounterName(PerfCounter counter)
+{
+	switch (counter)
+	{
+		case PerfCounter::ACTOR_SPAWNS:				return "Actor spawns";
+		case PerfCounter::ACTOR_DELETES:			return "Actor deletes";
+		case PerfCounter::COLLISION_PAIRS_TESTED:	return "Collision pairs tested";
+		case PerfCounter::COLLISION_PAIRS_COLLIDED: return "Collision pairs collided";
+		case PerfCounter::RAYCASTS:					return "Tile raycasts";
+		case PerfCounter::RAYCAST_TILES_STEPPED:	return "Raycast tiles stepped";
+		case PerfCounter::MAP_DRAW_CALLS:			return "Map draw calls";
+		case PerfCounter::MAP_BYTES_UPLOADED:		return "Map bytes uploaded";
+		case PerfCounter::PLAYER_VIEWS_RENDERED:	return "Player views rendered";
+		case PerfCounter::FLOW_FIELD_REBUILDS:		return "Flow field rebuilds";
+		case PerfCounter::DAMAGE_COMMANDS:			return "Damage commands";
+		case PerfCounter::DAMAGE_EVENTS:			return "Damage events";
+		case PerfCounter::PROJECTILE_SWEEPS:		return "Projectile sweeps";
+		case PerfCounter::SLEEPING_ACTORS:			return "Sleeping actors";
+		case PerfCounter::TILE_PUSHOUT_TESTS:		return "Tile pushout tests";
+		case PerfCounter::LINE_OF_SIGHT_QUERIES:	return "Line of sight queries";
+		default:									return "Unknown counter";
+	}
+}
+
+
+char const* PerfCounters::GetFrameTimeBucketName(int bucketIndex)
+{
+	switch (bucketIndex)
+	{
+		case 0:	 return "<8ms";
+		case 1:	 return "8-17ms";
+		case 2:	 return "17-33ms";
+		case 3:	 return "33-50ms";
+		case 4:	 return "50-100ms";
+		default: return ">100ms";
+	}
+}
+
+
+int PerfCounters::GetFrameTimeBucket(float frameSeconds)
+{
+	float frameMilliseconds = frameSeconds * 1000.0f;
+	for (int bucketIndex = 0; bucketIndex < PERF_FRAME_TIME_BUCKETS - 1; bucketIndex++)
+	{
+		if (frameMilliseconds < k_frameTimeBucketMaxMilliseconds[bucketIndex])
+		{
+			return bucketIndex;
+		}
+	}
+
+	return PERF_FRAME_TIME_BUCKETS - 1;
+}
+
+
+//
+//perf counter management functions
+//
+void PerfCountersStartup()
+{
+	SubscribeEventCallbackFunction("perfcounters", Event_PerfCounters);
+	SubscribeEventCallbackFunction("perfoverlay", Event_PerfOverlay);
+}
+
+
+void PerfCountersShutdown()
+{
+	UnsubscribeEventCallbackFunction("perfcounters", Event_PerfCounters);
+	UnsubscribeEventCallbackFunction("perfoverlay", Event_PerfOverlay);
+}
+
+
+void RenderPerfCountersOverlay(BitmapFont* font)
+{
+	if (!g_perfCounters.m_isOverlayVisible || font == nullptr)
+	{
+		return;
+	}
+
+	std::vector<Vertex_PCU> textVerts;
+	std::string report = g_perfCounters.GetReport();
+	font->AddVertsForTextInBox2D(textVerts, AABB2(SCREEN_CAMERA_SIZE_X * 0.6f, 0.0f, SCREEN_CAMERA_SIZE_X, SCREEN_CAMERA_SIZE_Y), 12.0f, report, Rgba8(255, 255, 0), 0.7f, Vec2(0.0f, 1.0f),
+		TextBoxMode::OVERRUN);
+
+	g_theRenderer->SetModelConstants();
+	g_theRenderer->BindShader(nullptr);
+	g_theRenderer->BindTexture(&font->GetTexture());
+	g_theRenderer->DrawVertexArray(static_cast<int>(textVerts.size()), textVerts.data());
+}
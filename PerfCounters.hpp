@@ -0,0 +1,84 @@
+#pragma once
+#include "Engine/Core/EngineCommon.hpp"
+
+
+//forward declarations
+class Map;
+class BitmapFont;
+struct Vertex_PCU;
+
+
+enum class PerfCounter
+{
+	ACTOR_SPAWNS,
+	ACTOR_DELETES,
+	COLLISION_PAIRS_TESTED,
+	COLLISION_PAIRS_COLLIDED,
+	RAYCASTS,
+	RAYCAST_TILES_STEPPED,
+	MAP_DRAW_CALLS,
+	MAP_BYTES_UPLOADED,
+	PLAYER_VIEWS_RENDERED,
+	FLOW_FIELD_REBUILDS,
+	DAMAGE_COMMANDS,
+	DAMAGE_EVENTS,
+	PROJECTILE_SWEEPS,
+	SLEEPING_ACTORS,
+	TILE_PUSHOUT_TESTS,
+	LINE_OF_SIGHT_QUERIES,
+	COUNT
+};
+
+
+constexpr int PERF_COUNTER_HISTORY_FRAMES = 120;
+constexpr int PERF_FRAME_TIME_BUCKETS = 6;
+
+
+class PerfCounters
+{
+//public member functions
+public:
+	//frame flow functions
+	void EndFrame(float frameSeconds, Map const* currentMap);
+
+	//accessors
+	float		GetAverage(PerfCounter counter) const;
+	float		GetAverageFrameSeconds() const;
+	int			GetNumHistoryFrames() const;
+	std::string GetReport() const;
+
+	//static accessors
+	static char const* GetCounterName(PerfCounter counter);
+	static char const* GetFrameTimeBucketName(int bucketIndex);
+	static int		   GetFrameTimeBucket(float frameSeconds);
+
+//public member variables
+public:
+	int m_currentFrameCounts[(int)PerfCounter::COUNT] = {};
+
+	//rolling window of finished frames, kept as running sums so averages are free to read
+	int	  m_history[(int)PerfCounter::COUNT][PERF_COUNTER_HISTORY_FRAMES] = {};
+	int	  m_historySums[(int)PerfCounter::COUNT] = {};
+	float m_frameSecondsHistory[PERF_COUNTER_HISTORY_FRAMES] = {};
+	float m_frameSecondsSum = 0.0f;
+	int	  m_frameTimeHistogram[PERF_FRAME_TIME_BUCKETS] = {};
+	int	  m_historyIndex = 0;
+	int	  m_numHistoryFrames = 0;
+
+	Map const* m_currentMap = nullptr;		//actors are only counted when a map is being played
+	bool	   m_isOverlayVisible = false;
+};
+
+
+extern PerfCounters g_perfCounters;
+
+
+//counter functions, cheap enough to call from hot loops
+inline void IncrementPerfCounter(PerfCounter counter, int amount = 1)
+{
+	g_perfCounters.m_currentFrameCounts[(int)counter] += amount;
+}
+
+void PerfCountersStartup();
+void PerfCountersShutdown();
+void RenderPerfCountersOverlay(BitmapFont* font);
@@ -34,9 +34,11 @@ Player::Player(Game* owner, Map* map, int playerIndex, int xboxID)
 //
 //public game flow functions
 //
-void Player::Update(float deltaSeconds)
+void Player::UpdateInput(float deltaSeconds)
 {
-	if (g_theInput->WasKeyJustPressed('F') && m_map->m_players[1] == nullptr)	//can't free fly when player 2 exists
+	FrameInput const& frameInput = m_frameInput;
+
+	if (frameInput.WasButtonJustPressed(InputButton::TOGGLE_FREE_FLY) && m_map->m_numPlayers == 1 && !m_isRemote)	//can't free fly in split screen
 	{
 		m_isFreeFly = !m_isFreeFly;
 
@@ -50,23 +52,65 @@ void Player::Update(float deltaSeconds)
 		}
 	}
 
-	if (g_theInput->WasKeyJustPressed('N') && m_map->m_players[1] == nullptr)	//can't debug possess when player 2 exists
+	if (frameInput.WasButtonJustPressed(InputButton::DEBUG_POSSESS) && m_map->m_numPlayers == 1 && !m_isRemote && !m_map->m_isNetClient)	//can't debug possess in split screen
 	{
 		m_map->DebugPossessNext();
 	}
 
+	m_movementIntentions = Vec3();
+	m_isAttackHeld = false;
+
 	if (m_isFreeFly)
 	{
 		float systemDeltaSeconds = Clock::GetSystemClock().GetDeltaSeconds();
 		UpdateFreeFly(systemDeltaSeconds);
 	}
+	else if (m_xboxControllerID == -1)
+	{
+		UpdateInputActor();
+	}
 	else
+	{
+		UpdateFromControllerActor(deltaSeconds);
+	}
+}
+
+
+void Player::Update(float deltaSeconds)
+{
+	if (!m_isFreeFly)
 	{
 		UpdateActor(deltaSeconds);
 	}
 }
 
 
+void Player::UpdateCamera()
+{
+	//free fly already moved the camera this frame
+	if (m_isFreeFly)
+	{
+		return;
+	}
+
+	Actor* playerActor = m_map->GetActorByUID(m_actorUID);
+	if (playerActor == nullptr)
+	{
+		return;
+	}
+
+	//dead players keep the falling eye height worked out during the simulation tick
+	if (playerActor->m_health > 0)
+	{
+		m_position = playerActor->GetRenderPosition() + Vec3(0.0f, 0.0f, playerActor->m_definition->m_eyeHeight);
+		m_orientation = playerActor->m_orientation;
+	}
+
+	m_playerCamera.SetTransform(m_position, m_orientation);
+	m_playerCamera.SetFieldOfViewDegrees(playerActor->m_definition->m_cameraFOVDegrees);
+}
+
+
 void Player::UpdateActor(float deltaSeconds)
 {
 	Actor* playerActor = m_map->GetActorByUID(m_actorUID);
@@ -83,197 +127,194 @@ void Player::UpdateActor(float deltaSeconds)
 
 			m_position.z = Interpolate(playerActor->m_definition->m_eyeHeight, 0.0f, fractionFallen);
 		}
-		
-		m_playerCamera.SetTransform(m_position, m_orientation);
 
 		return;
 	}
 
-	m_isSpeedUp = false;
-
-	if (m_xboxControllerID == -1)
+	//input was gathered once this frame, but forces and attacks have to be applied on every simulation tick
+	if (m_movementIntentions != Vec3())
 	{
-		Vec3 movementIntentions = Vec3();
+		Vec3 movementDirection = playerActor->GetModelMatrixYawOnly().TransformVectorQuantity3D(m_movementIntentions);
 
-		if (g_theInput->IsKeyDown('W'))
-		{
-			movementIntentions.x += 1.0f;
-		}
-		if (g_theInput->IsKeyDown('S'))
-		{
-			movementIntentions.x -= 1.0f;
-		}
-		if (g_theInput->IsKeyDown('A'))
-		{
-			movementIntentions.y += 1.0f;
-		}
-		if (g_theInput->IsKeyDown('D'))
-		{
-			movementIntentions.y -= 1.0f;
-		}
-		if (g_theInput->IsKeyDown('Z'))
+		if (m_isSpeedUp)
 		{
-			movementIntentions.z += 1.0f;
+			playerActor->MoveInDirection(movementDirection, playerActor->m_definition->m_runSpeed);
 		}
-		if (g_theInput->IsKeyDown('C'))
+		else
 		{
-			movementIntentions.z -= 1.0f;
+			playerActor->MoveInDirection(movementDirection, playerActor->m_definition->m_walkSpeed);
 		}
+	}
 
-		if (g_theInput->IsKeyDown(KEYCODE_SHIFT))
-		{
-			m_isSpeedUp = true;
-		}
+	if (m_isAttackHeld)
+	{
+		playerActor->Attack();
+	}
 
-		if (g_theInput->IsKeyDown(KEYCODE_LMB))
-		{
-			m_map->GetActorByUID(m_actorUID)->Attack();
-		}
+	m_position = playerActor->m_position + Vec3(0.0f, 0.0f, playerActor->m_definition->m_eyeHeight);
+	m_orientation = playerActor->m_orientation;
 
-		if (g_theInput->WasKeyJustPressed('1'))
-		{
-			playerActor->EquipWeapon(0);
-		}
-		if (g_theInput->WasKeyJustPressed('2'))
-		{
-			playerActor->EquipWeapon(1);
-		}
+	UNUSED(deltaSeconds);
+}
 
-		if (g_theInput->WasKeyJustPressed(KEYCODE_LEFT))
+
+void Player::UpdateInputActor()
+{
+	Actor* playerActor = m_map->GetActorByUID(m_actorUID);
+	if (playerActor == nullptr || playerActor->m_health <= 0)
+	{
+		return;
+	}
+
+	//everything that reaches the simulation comes from the frame input so replays can drive it
+	FrameInput const& frameInput = m_frameInput;
+
+	m_isSpeedUp = false;
+
+	if (frameInput.IsButtonDown(InputButton::KEYBOARD_FORWARD))
+	{
+		m_movementIntentions.x += 1.0f;
+	}
+	if (frameInput.IsButtonDown(InputButton::KEYBOARD_BACK))
+	{
+		m_movementIntentions.x -= 1.0f;
+	}
+	if (frameInput.IsButtonDown(InputButton::KEYBOARD_LEFT))
+	{
+		m_movementIntentions.y += 1.0f;
+	}
+	if (frameInput.IsButtonDown(InputButton::KEYBOARD_RIGHT))
+	{
+		m_movementIntentions.y -= 1.0f;
+	}
+	if (frameInput.IsButtonDown(InputButton::KEYBOARD_UP))
+	{
+		m_movementIntentions.z += 1.0f;
+	}
+	if (frameInput.IsButtonDown(InputButton::KEYBOARD_DOWN))
+	{
+		m_movementIntentions.z -= 1.0f;
+	}
+
+	if (m_movementIntentions != Vec3())
+	{
+		m_movementIntentions.Normalize();
+	}
+
+	if (frameInput.IsButtonDown(InputButton::KEYBOARD_SPEED_UP))
+	{
+		m_isSpeedUp = true;
+	}
+
+	if (frameInput.IsButtonDown(InputButton::KEYBOARD_ATTACK))
+	{
+		m_isAttackHeld = true;
+	}
+
+	if (frameInput.WasButtonJustPressed(InputButton::KEYBOARD_WEAPON_1))
+	{
+		playerActor->EquipWeapon(0);
+	}
+	if (frameInput.WasButtonJustPressed(InputButton::KEYBOARD_WEAPON_2))
+	{
+		playerActor->EquipWeapon(1);
+	}
+
+	if (frameInput.WasButtonJustPressed(InputButton::KEYBOARD_PREVIOUS_WEAPON))
+	{
+		for (int weaponIndex = 0; weaponIndex < playerActor->m_weapons.size(); weaponIndex++)
 		{
-			for (int weaponIndex = 0; weaponIndex < playerActor->m_weapons.size(); weaponIndex++)
+			if (playerActor->m_currentWeapon == playerActor->m_weapons[weaponIndex])
 			{
-				if (playerActor->m_currentWeapon == playerActor->m_weapons[weaponIndex])
+				if (weaponIndex == 0)
 				{
-					if (weaponIndex == 0)
-					{
-						playerActor->EquipWeapon(static_cast<int>(playerActor->m_weapons.size() - 1));
-					}
-					else
-					{
-						playerActor->EquipWeapon(weaponIndex - 1);
-					}
-					break;
+					playerActor->EquipWeapon(static_cast<int>(playerActor->m_weapons.size() - 1));
 				}
-			}
-		}
-		if (g_theInput->WasKeyJustPressed(KEYCODE_RIGHT))
-		{
-			for (int weaponIndex = 0; weaponIndex < playerActor->m_weapons.size(); weaponIndex++)
-			{
-				if (playerActor->m_currentWeapon == playerActor->m_weapons[weaponIndex])
+				else
 				{
-					if (weaponIndex == static_cast<int>(playerActor->m_weapons.size() - 1))
-					{
-						playerActor->EquipWeapon(0);
-					}
-					else
-					{
-						playerActor->EquipWeapon(weaponIndex + 1);
-					}
-					break;
+					playerActor->EquipWeapon(weaponIndex - 1);
 				}
+				break;
 			}
 		}
-
-		if (movementIntentions != Vec3())
+	}
+	if (frameInput.WasButtonJustPressed(InputButton::KEYBOARD_NEXT_WEAPON))
+	{
+		for (int weaponIndex = 0; weaponIndex < playerActor->m_weapons.size(); weaponIndex++)
 		{
-			movementIntentions.Normalize();
-			movementIntentions = playerActor->GetModelMatrixYawOnly().TransformVectorQuantity3D(movementIntentions);
-
-			if (m_isSpeedUp)
-			{
-				playerActor->MoveInDirection(movementIntentions, playerActor->m_definition->m_runSpeed);
-			}
-			else
+			if (playerActor->m_currentWeapon == playerActor->m_weapons[weaponIndex])
 			{
-				playerActor->MoveInDirection(movementIntentions, playerActor->m_definition->m_walkSpeed);
+				if (weaponIndex == static_cast<int>(playerActor->m_weapons.size() - 1))
+				{
+					playerActor->EquipWeapon(0);
+				}
+				else
+				{
+					playerActor->EquipWeapon(weaponIndex + 1);
+				}
+				break;
 			}
 		}
-
-		IntVec2 mouseDelta = g_theInput->GetCursorClientDelta();
-
-		playerActor->m_orientation.m_yawDegrees -= (float)mouseDelta.x * m_mouseTurnRate;
-		playerActor->m_orientation.m_pitchDegrees += (float)mouseDelta.y * m_mouseTurnRate;
-
-		playerActor->m_orientation.m_pitchDegrees = GetClamped(playerActor->m_orientation.m_pitchDegrees, -85.0f, 85.0f);
-	}
-	else
-	{
-		UpdateFromControllerActor(deltaSeconds);
 	}
 
-	m_position = playerActor->m_position + Vec3(0.0f, 0.0f, playerActor->m_definition->m_eyeHeight);
-	m_orientation = playerActor->m_orientation;
+	//looking stays at frame rate so the mouse never feels tied to the simulation rate
+	IntVec2 mouseDelta = frameInput.m_cursorDelta;
 
-	m_playerCamera.SetTransform(m_position, m_orientation);
-	m_playerCamera.SetFieldOfViewDegrees(playerActor->m_definition->m_cameraFOVDegrees);
+	playerActor->m_orientation.m_yawDegrees -= (float)mouseDelta.x * m_mouseTurnRate;
+	playerActor->m_orientation.m_pitchDegrees += (float)mouseDelta.y * m_mouseTurnRate;
 
-	UNUSED(deltaSeconds);
+	playerActor->m_orientation.m_pitchDegrees = GetClamped(playerActor->m_orientation.m_pitchDegrees, -85.0f, 85.0f);
 }
 
 
 void Player::UpdateFromControllerActor(float deltaSeconds)
 {
-	XboxController const& controller = g_theInput->GetController(0);
-	AnalogJoystick const& leftStick = controller.GetLeftStick();
-	AnalogJoystick const& rightStick = controller.GetRightStick();
-
-	float leftStickMagnitude = leftStick.GetMagnitude();
-	float rightStickMagnitude = rightStick.GetMagnitude();
+	FrameInput const& frameInput = m_frameInput;
+	Vec2 leftStick = frameInput.m_leftStick;
+	Vec2 rightStick = frameInput.m_rightStick;
 
 	Actor* playerActor = m_map->GetActorByUID(m_actorUID);
-	if (playerActor == nullptr)
+	if (playerActor == nullptr || playerActor->m_health <= 0)
 	{
 		return;
 	}
 
-	Vec3 movementIntentions = Vec3();
+	m_isSpeedUp = false;
 
-	if (controller.IsButtonDown(XBOX_BUTTON_A))
+	if (frameInput.IsButtonDown(InputButton::CONTROLLER_SPEED_UP))
 	{
 		m_isSpeedUp = true;
 	}
 
-	if (leftStickMagnitude > 0.0f)
+	if (leftStick != Vec2())
 	{
-		movementIntentions.y = -leftStick.GetPosition().x;
-		movementIntentions.x = leftStick.GetPosition().y;
+		m_movementIntentions.y = -leftStick.x;
+		m_movementIntentions.x = leftStick.y;
 
-		movementIntentions.Normalize();
-		movementIntentions = playerActor->GetModelMatrixYawOnly().TransformVectorQuantity3D(movementIntentions);
-
-		if (m_isSpeedUp)
-		{
-			playerActor->MoveInDirection(movementIntentions, playerActor->m_definition->m_runSpeed);
-		}
-		else
-		{
-			playerActor->MoveInDirection(movementIntentions, playerActor->m_definition->m_walkSpeed);
-		}
+		m_movementIntentions.Normalize();
 	}
 
-	if (rightStickMagnitude > 0.0f)
+	if (rightStick != Vec2())
 	{
-		playerActor->m_orientation.m_yawDegrees += -rightStick.GetPosition().x * playerActor->m_definition->m_turnSpeed * deltaSeconds;
-		playerActor->m_orientation.m_pitchDegrees += -rightStick.GetPosition().y * playerActor->m_definition->m_turnSpeed * deltaSeconds;
+		playerActor->m_orientation.m_yawDegrees += -rightStick.x * playerActor->m_definition->m_turnSpeed * deltaSeconds;
+		playerActor->m_orientation.m_pitchDegrees += -rightStick.y * playerActor->m_definition->m_turnSpeed * deltaSeconds;
 	}
 
-	if (controller.GetRightTrigger() > 0.0f)
+	if (frameInput.m_rightTrigger > 0.0f)
 	{
-		m_map->GetActorByUID(m_actorUID)->Attack();
+		m_isAttackHeld = true;
 	}
 
-	if (controller.WasButtonJustPressed(XBOX_BUTTON_X))
+	if (frameInput.WasButtonJustPressed(InputButton::CONTROLLER_WEAPON_1))
 	{
 		playerActor->EquipWeapon(0);
 	}
-	if (controller.WasButtonJustPressed(XBOX_BUTTON_Y))
+	if (frameInput.WasButtonJustPressed(InputButton::CONTROLLER_WEAPON_2))
 	{
 		playerActor->EquipWeapon(1);
 	}
 
-	if (controller.WasButtonJustPressed(XBOX_BUTTON_DOWN))
+	if (frameInput.WasButtonJustPressed(InputButton::CONTROLLER_SWAP_WEAPON))
 	{
 		if (playerActor->m_currentWeapon == playerActor->m_weapons[0])
 		{
@@ -1,5 +1,6 @@
 #pragma once
 #include "Game/Controller.hpp"
+#include "Game/InputRecording.hpp"
 #include "Engine/Renderer/Camera.hpp"
 
 
@@ -15,9 +16,12 @@ public:
 	Player(Game* owner, Map* map, int playerIndex, int xboxID);
 
 	//game flow functions
+	void UpdateInput(float deltaSeconds);
 	void Update(float deltaSeconds);
+	void UpdateCamera();
 
 	void UpdateActor(float deltaSeconds);
+	void UpdateInputActor();
 	void UpdateFromControllerActor(float deltaSeconds);
 
 	void UpdateFreeFly(float deltaSeconds);
@@ -38,6 +42,9 @@ public:
 	float m_rollSpeed = 50.0f;
 	float m_controllerTurnRate = 180.0f;
 	bool  m_isSpeedUp;
+
+	Vec3 m_movementIntentions;		//local space, gathered every frame and applied every simulation tick
+	bool m_isAttackHeld = false;
 	float m_speedUpAmount = 15.0f;
 
 	Game* m_game = nullptr;
@@ -55,4 +62,7 @@ public:
 	int m_playerIndex = 0;
 
 	int m_xboxControllerID = -1;
+
+	FrameInput m_frameInput;	//this frame's input, copied from the game for local players and merged from packets for remote ones
+	bool	   m_isRemote = false;
 };
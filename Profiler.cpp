@@ -0,0 +1,208 @@
+#include "Game/Profiler.hpp"
+#include "Game/GameCommon.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include <atomic>
+#include <mutex>
+#include <fstream>
+
+
+//profiler state
+static std::atomic<bool> s_isProfiling(false);
+static int s_maxEventsPerThread = 262144;
+
+//buffers are only registered under the lock, once per thread, and only read while profiling is stopped
+static std::mutex s_threadBuffersMutex;
+static std::vector<ProfileThreadBuffer*> s_threadBuffers;
+static thread_local ProfileThreadBuffer* t_threadBuffer = nullptr;
+
+
+//
+//static helper functions
+//
+static ProfileThreadBuffer* GetThreadBuffer()
+{
+	if (t_threadBuffer == nullptr)
+	{
+		ProfileThreadBuffer* newBuffer = new ProfileThreadBuffer();
+		newBuffer->m_events.reserve(s_maxEventsPerThread);
+
+		std::lock_guard<std::mutex> lock(s_threadBuffersMutex);
+		newBuffer->m_threadIndex = static_cast<int>(s_threadBuffers.size());
+		s_threadBuffers.push_back(newBuffer);
+		t_threadBuffer = newBuffer;
+	}
+
+	return t_threadBuffer;
+}
+
+
+static bool Event_Profile(EventArgs& args)
+{
+	if (IsProfiling())
+	{
+		std::string traceFilePath = args.GetValue("file", "ProfileTrace.json");
+		StopProfiling(traceFilePath);
+	}
+	else
+	{
+		StartProfiling();
+		g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, "Profiling started, run profile again to stop and write the trace");
+	}
+
+	return true;
+}
+
+
+//
+//constructor and destructor
+//
+ProfileScope::ProfileScope(char const* name)
+	: m_name(name)
+{
+	if (!s_isProfiling.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	m_isRecording = true;
+	GetThreadBuffer()->m_currentDepth++;
+	m_startSeconds = GetCurrentTimeSeconds();
+}
+
+
+ProfileScope::~ProfileScope()
+{
+	if (!m_isRecording)
+	{
+		return;
+	}
+
+	double endSeconds = GetCurrentTimeSeconds();
+
+	ProfileThreadBuffer* threadBuffer = GetThreadBuffer();
+	threadBuffer->m_currentDepth--;
+
+	//never grow past the reserved size so recording can't stall on an allocation
+	if (threadBuffer->m_events.size() >= s_maxEventsPerThread)
+	{
+		threadBuffer->m_numDroppedEvents++;
+		return;
+	}
+
+	ProfileEvent newEvent;
+	newEvent.m_name = m_name;
+	newEvent.m_startSeconds = m_startSeconds;
+	newEvent.m_durationSeconds = endSeconds - m_startSeconds;
+	newEvent.m_depth = threadBuffer->m_currentDepth;
+	threadBuffer->m_events.push_back(newEvent);
+}
+
+
+//
+//profiler management functions
+//
+void ProfilerStartup()
+{
+	s_maxEventsPerThread = g_gameConfigBlackboard.GetValue("profilerMaxEventsPerThread", s_maxEventsPerThread);
+
+	SubscribeEventCallbackFunction("profile", Event_Profile);
+
+	if (g_gameConfigBlackboard.GetValue("profileOnStartup", false))
+	{
+		StartProfiling();
+	}
+}
+
+
+void ProfilerShutdown()
+{
+	UnsubscribeEventCallbackFunction("profile", Event_Profile);
+	s_isProfiling = false;
+
+	std::lock_guard<std::mutex> lock(s_threadBuffersMutex);
+	for (int bufferIndex = 0; bufferIndex < s_threadBuffers.size(); bufferIndex++)
+	{
+		delete s_threadBuffers[bufferIndex];
+		s_threadBuffers[bufferIndex] = nullptr;
+	}
+	s_threadBuffers.clear();
+	t_threadBuffer = nullptr;
+}
+
+
+void StartProfiling()
+{
+	std::lock_guard<std::mutex> lock(s_threadBuffersMutex);
+	for (int bufferIndex = 0; bufferIndex < s_threadBuffers.size(); bufferIndex++)
+	{
+		s_threadBuffers[bufferIndex]->m_events.clear();
+		s_threadBuffers[bufferIndex]->m_numDroppedEvents = 0;
+	}
+
+	s_isProfiling = true;
+}
+
+
+void StopProfiling(std::string const& traceFilePath)
+{
+	s_isProfiling = false;
+
+	if (WriteChromeTrace(traceFilePath))
+	{
+		g_theDevConsole->AddLine(DevConsole::COLOR_INFO_MINOR, Stringf("Profiling stopped, trace written to %s", traceFilePath.c_str()));
+	}
+	else
+	{
+		g_theDevConsole->AddLine(DevConsole::COLOR_ERROR, Stringf("Profiling stopped, but failed to write %s", traceFilePath.c_str()));
+	}
+}
+
+
+bool IsProfiling()
+{
+	return s_isProfiling;
+}
+
+
+bool WriteChromeTrace(std::string const& traceFilePath)
+{
+	//chrome trace_event format, complete events in microseconds, open it in chrome://tracing or perfetto
+	std::ofstream traceFile(traceFilePath);
+	if (!traceFile.is_open())
+	{
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(s_threadBuffersMutex);
+
+	traceFile << "{\"traceEvents\":[\n";
+	bool isFirstEvent = true;
+	int numDroppedEvents = 0;
+	for (int bufferIndex = 0; bufferIndex < s_threadBuffers.size(); bufferIndex++)
+	{
+		ProfileThreadBuffer const* threadBuffer = s_threadBuffers[bufferIndex];
+		numDroppedEvents += threadBuffer->m_numDroppedEvents;
+
+		for (int eventIndex = 0; eventIndex < threadBuffer->m_events.size(); eventIndex++)
+		{
+			ProfileEvent const& event = threadBuffer->m_events[eventIndex];
+			if (!isFirstEvent)
+			{
+				traceFile << ",\n";
+			}
+			isFirstEvent = false;
+
+			traceFile << Stringf("{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", event.m_name, threadBuffer->m_threadIndex,
+				event.m_startSeconds * 1000000.0, event.m_durationSeconds * 1000000.0);
+		}
+	}
+	traceFile << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+	if (numDroppedEvents > 0)
+	{
+		g_theDevConsole->AddLine(DevConsole::COLOR_WARNING, Stringf("Profiler buffers filled up, %d events were dropped", numDroppedEvents));
+	}
+
+	return true;
+}
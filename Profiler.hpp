@@ -0,0 +1,53 @@
+#pragma once
+#include "Engine/Core/EngineCommon.hpp"
+
+
+//one finished zone, names must be string literals since only the pointer is kept
+struct ProfileEvent
+{
+	char const* m_name = nullptr;
+	double		m_startSeconds = 0.0;
+	double		m_durationSeconds = 0.0;
+	int			m_depth = 0;
+};
+
+
+//each thread only ever writes to its own buffer, so recording never takes a lock
+struct ProfileThreadBuffer
+{
+	int						  m_threadIndex = 0;
+	int						  m_currentDepth = 0;
+	int						  m_numDroppedEvents = 0;
+	std::vector<ProfileEvent> m_events;
+};
+
+
+class ProfileScope
+{
+//public member functions
+public:
+	//constructor and destructor
+	explicit ProfileScope(char const* name);
+	~ProfileScope();
+
+//public member variables
+public:
+	char const* m_name = nullptr;
+	double		m_startSeconds = 0.0;
+	bool		m_isRecording = false;
+};
+
+
+//profiler management functions
+void ProfilerStartup();
+void ProfilerShutdown();
+void StartProfiling();
+void StopProfiling(std::string const& traceFilePath);
+bool IsProfiling();
+bool WriteChromeTrace(std::string const& traceFilePath);
+
+
+//scoped timer macro, compiles down to a flag check when profiling is off
+#define PROFILE_CONCATENATE_INNER(a, b) a##b
+#define PROFILE_CONCATENATE(a, b) PROFILE_CONCATENATE_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCATENATE(profileScope_, __LINE__)(name)
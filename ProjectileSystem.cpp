@@ -0,0 +1,379 @@
+#include "Game/ProjectileSystem.hpp"
+#include "Game/Map.hpp"
+#include "Game/Actor.hpp"
+#include "Game/ActorDefinition.hpp"
+#include "Game/Profiler.hpp"
+#include "Game/PerfCounters.hpp"
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Math/MathUtils.hpp"
+
+
+//moves are split into steps no longer than this when walking the tile grid, so each step only touches a handful of tiles
+static const float k_tileSweepStepLength = 0.5f;
+
+//extra reach for the actor bucket query, covers the target's own radius and height
+static const float k_actorSweepMargin = 1.5f;
+
+
+//
+//static helper functions
+//
+static bool SweepDiscAgainstDisc2D(Vec2 const& start, Vec2 const& displacement, Vec2 const& center, float radius, float& out_fraction)
+{
+	Vec2 fromCenter = start - center;
+	float startDistanceSquared = DotProduct2D(fromCenter, fromCenter) - radius * radius;
+	float approachSpeed = DotProduct2D(fromCenter, displacement);
+
+	//already touching only counts when moving further in, otherwise a resting contact would block every move
+	if (startDistanceSquared <= 0.0f)
+	{
+		out_fraction = 0.0f;
+		return approachSpeed < 0.0f;
+	}
+
+	float a = DotProduct2D(displacement, displacement);
+	if (a == 0.0f || approachSpeed >= 0.0f)
+	{
+		return false;
+	}
+
+	float discriminant = approachSpeed * approachSpeed - a * startDistanceSquared;
+	if (discriminant < 0.0f)
+	{
+		return false;
+	}
+
+	float fraction = (-approachSpeed - sqrtf(discriminant)) / a;
+	if (fraction > 1.0f)
+	{
+		return false;
+	}
+
+	out_fraction = fraction;
+	return true;
+}
+
+
+static bool SweepDiscAgainstAABB2D(Vec2 const& start, Vec2 const& displacement, float radius, AABB2 const& box, float& out_fraction, Vec2& out_normal)
+{
+	Vec2 nearestPoint = box.GetNearestPoint(start);
+	Vec2 fromBox = start - nearestPoint;
+	if (DotProduct2D(fromBox, fromBox) < radius * radius)
+	{
+		if (DotProduct2D(fromBox, displacement) >= 0.0f || fromBox == Vec2())
+		{
+			return false;
+		}
+
+		out_fraction = 0.0f;
+		out_normal = fromBox.GetNormalized();
+		return true;
+	}
+
+	//slab test against the box grown by the radius, the corners of the grown box are rounded off below
+	float mins[2] = { box.m_mins.x - radius, box.m_mins.y - radius };
+	float maxs[2] = { box.m_maxs.x + radius, box.m_maxs.y + radius };
+	float starts[2] = { start.x, start.y };
+	float deltas[2] = { displacement.x, displacement.y };
+
+	float enterFraction = -FLT_MAX;
+	float exitFraction = FLT_MAX;
+	int enterAxis = -1;
+	for (int axis = 0; axis < 2; axis++)
+	{
+		if (deltas[axis] == 0.0f)
+		{
+			if (starts[axis] < mins[axis] || starts[axis] > maxs[axis])
+			{
+				return false;
+			}
+			continue;
+		}
+
+		float fractionA = (mins[axis] - starts[axis]) / deltas[axis];
+		float fractionB = (maxs[axis] - starts[axis]) / deltas[axis];
+		float axisEnter = fractionA < fractionB ? fractionA : fractionB;
+		float axisExit = fractionA < fractionB ? fractionB : fractionA;
+		if (axisEnter > enterFraction)
+		{
+			enterFraction = axisEnter;
+			enterAxis = axis;
+		}
+		if (axisExit < exitFraction)
+		{
+			exitFraction = axisExit;
+		}
+	}
+
+	if (enterFraction > exitFraction || enterFraction > 1.0f || exitFraction < 0.0f)
+	{
+		return false;
+	}
+
+	float clampedEnterFraction = enterFraction < 0.0f ? 0.0f : enterFraction;
+	Vec2 enterPoint = start + displacement * clampedEnterFraction;
+	bool isInsideX = enterPoint.x >= box.m_mins.x && enterPoint.x <= box.m_maxs.x;
+	bool isInsideY = enterPoint.y >= box.m_mins.y && enterPoint.y <= box.m_maxs.y;
+	if (enterFraction >= 0.0f && (isInsideX || isInsideY))
+	{
+		out_fraction = enterFraction;
+		out_normal = Vec2();
+		if (enterAxis == 0)
+		{
+			out_normal.x = deltas[0] > 0.0f ? -1.0f : 1.0f;
+		}
+		else
+		{
+			out_normal.y = deltas[1] > 0.0f ? -1.0f : 1.0f;
+		}
+		return true;
+	}
+
+	//entering through a corner region, which is a disc of the sweep radius around the box corner
+	Vec2 corner = Vec2(enterPoint.x < box.m_mins.x ? box.m_mins.x : box.m_maxs.x, enterPoint.y < box.m_mins.y ? box.m_mins.y : box.m_maxs.y);
+	float cornerFraction = 0.0f;
+	if (!SweepDiscAgainstDisc2D(start, displacement, corner, radius, cornerFraction))
+	{
+		return false;
+	}
+
+	out_fraction = cornerFraction;
+	out_normal = (start + displacement * cornerFraction - corner).GetNormalized();
+	return true;
+}
+
+
+//
+//constructor
+//
+ProjectileSystem::ProjectileSystem(Map* map)
+	: m_map(map)
+{
+}
+
+
+//
+//public game flow functions
+//
+void ProjectileSystem::Update(float deltaSeconds)
+{
+	PROFILE_SCOPE("ProjectileSystem::Update");
+
+	//backward so a projectile that dies can swap the last one into its place without skipping anything
+	for (int projectileIndex = static_cast<int>(m_projectileUIDs.size()) - 1; projectileIndex >= 0; projectileIndex--)
+	{
+		Actor* projectile = m_map->GetActorByUID(m_projectileUIDs[projectileIndex]);
+		if (projectile == nullptr || projectile->m_isGarbage || projectile->m_health <= 0)
+		{
+			m_projectileUIDs[projectileIndex] = m_projectileUIDs.back();
+			m_projectileUIDs.pop_back();
+			continue;
+		}
+
+		ActorDefinition const* definition = projectile->m_definition;
+		if (!definition->m_isSimulated)
+		{
+			continue;
+		}
+
+		//same integration as Actor::UpdatePhysics, the move is then swept instead of applied and pushed back out
+		if (!definition->m_isFlying)
+		{
+			projectile->m_velocity.z = 0.0f;
+		}
+		projectile->AddForce((Vec3() - projectile->m_velocity) * definition->m_drag);
+		projectile->m_velocity += projectile->m_acceleration * deltaSeconds;
+		projectile->m_acceleration = Vec3();
+
+		Vec3 displacement = projectile->m_velocity * deltaSeconds;
+		ProjectileSweepHit hit;
+		if (definition->m_collideWithWorld)
+		{
+			SweepAgainstFloorAndCeiling(projectile, displacement, hit);
+			SweepAgainstTiles(projectile, displacement, hit);
+		}
+		if (definition->m_collideWithActors)
+		{
+			SweepAgainstActors(projectile, displacement, hit);
+		}
+		IncrementPerfCounter(PerfCounter::PROJECTILE_SWEEPS);
+
+		projectile->m_position += displacement * hit.m_fraction;
+		if (hit.m_fraction < 1.0f)
+		{
+			//whatever survives the hit slides along the surface next tick instead of sticking to it
+			float speedIntoSurface = DotProduct3D(projectile->m_velocity, hit.m_normal);
+			if (speedIntoSurface < 0.0f)
+			{
+				projectile->m_velocity -= hit.m_normal * speedIntoSurface;
+			}
+
+			if (hit.m_actorHit != nullptr)
+			{
+				IncrementPerfCounter(PerfCounter::COLLISION_PAIRS_COLLIDED);
+				projectile->OnCollideWithActor(hit.m_actorHit);
+				hit.m_actorHit->OnCollideWithActor(projectile);
+			}
+			else
+			{
+				projectile->OnCollide();
+			}
+		}
+
+		if (projectile->m_health <= 0)
+		{
+			m_projectileUIDs[projectileIndex] = m_projectileUIDs.back();
+			m_projectileUIDs.pop_back();
+		}
+	}
+}
+
+
+//
+//public projectile utilities
+//
+void ProjectileSystem::AddProjectile(Actor const* projectile)
+{
+	m_projectileUIDs.push_back(projectile->m_UID);
+}
+
+
+void ProjectileSystem::ClearProjectiles()
+{
+	m_projectileUIDs.clear();
+}
+
+
+//
+//public accessors
+//
+int ProjectileSystem::GetNumProjectiles() const
+{
+	return static_cast<int>(m_projectileUIDs.size());
+}
+
+
+//
+//private sweep functions
+//
+void ProjectileSystem::SweepAgainstTiles(Actor const* projectile, Vec3 const& displacement, ProjectileSweepHit& inout_hit) const
+{
+	Vec2 start = Vec2(projectile->m_position.x, projectile->m_position.y);
+	Vec2 displacementXY = Vec2(displacement.x, displacement.y);
+	float radius = projectile->m_physicsRadius;
+
+	//walk the move a step at a time and stop at the first step that contains a hit, so long moves don't scan a big rectangle
+	int numSteps = 1 + static_cast<int>(displacementXY.GetLength() / k_tileSweepStepLength);
+	for (int stepIndex = 0; stepIndex < numSteps; stepIndex++)
+	{
+		float stepStartFraction = static_cast<float>(stepIndex) / static_cast<float>(numSteps);
+		float stepEndFraction = static_cast<float>(stepIndex + 1) / static_cast<float>(numSteps);
+		if (stepStartFraction >= inout_hit.m_fraction)
+		{
+			return;
+		}
+
+		Vec2 stepStart = start + displacementXY * stepStartFraction;
+		Vec2 stepEnd = start + displacementXY * stepEndFraction;
+		int minX = static_cast<int>(floorf((stepStart.x < stepEnd.x ? stepStart.x : stepEnd.x) - radius));
+		int minY = static_cast<int>(floorf((stepStart.y < stepEnd.y ? stepStart.y : stepEnd.y) - radius));
+		int maxX = static_cast<int>(floorf((stepStart.x > stepEnd.x ? stepStart.x : stepEnd.x) + radius));
+		int maxY = static_cast<int>(floorf((stepStart.y > stepEnd.y ? stepStart.y : stepEnd.y) + radius));
+
+		for (int tileY = minY; tileY <= maxY; tileY++)
+		{
+			for (int tileX = minX; tileX <= maxX; tileX++)
+			{
+				if (!m_map->IsTileSolid(tileX, tileY))
+				{
+					continue;
+				}
+
+				float fraction = 1.0f;
+				Vec2 normal;
+				AABB2 tileBounds = AABB2(static_cast<float>(tileX), static_cast<float>(tileY), static_cast<float>(tileX + 1), static_cast<float>(tileY + 1));
+				if (SweepDiscAgainstAABB2D(start, displacementXY, radius, tileBounds, fraction, normal) && fraction < inout_hit.m_fraction)
+				{
+					inout_hit.m_fraction = fraction;
+					inout_hit.m_normal = Vec3(normal.x, normal.y, 0.0f);
+					inout_hit.m_actorHit = nullptr;
+				}
+			}
+		}
+	}
+}
+
+
+void ProjectileSystem::SweepAgainstFloorAndCeiling(Actor const* projectile, Vec3 const& displacement, ProjectileSweepHit& inout_hit) const
+{
+	float bottom = projectile->m_position.z;
+	float top = projectile->m_position.z + projectile->m_physicsHeight;
+
+	if (displacement.z < 0.0f && bottom + displacement.z < 0.0f)
+	{
+		float fraction = bottom > 0.0f ? -bottom / displacement.z : 0.0f;
+		if (fraction < inout_hit.m_fraction)
+		{
+			inout_hit.m_fraction = fraction;
+			inout_hit.m_normal = Vec3(0.0f, 0.0f, 1.0f);
+			inout_hit.m_actorHit = nullptr;
+		}
+	}
+	if (displacement.z > 0.0f && top + displacement.z > 1.0f)
+	{
+		float fraction = top < 1.0f ? (1.0f - top) / displacement.z : 0.0f;
+		if (fraction < inout_hit.m_fraction)
+		{
+			inout_hit.m_fraction = fraction;
+			inout_hit.m_normal = Vec3(0.0f, 0.0f, -1.0f);
+			inout_hit.m_actorHit = nullptr;
+		}
+	}
+}
+
+
+void ProjectileSystem::SweepAgainstActors(Actor const* projectile, Vec3 const& displacement, ProjectileSweepHit& inout_hit)
+{
+	ActorRadiusQuery query;
+	query.m_center = projectile->m_position + displacement * 0.5f;
+	query.m_radius = displacement.GetLength() * 0.5f + projectile->m_physicsRadius + k_actorSweepMargin;
+	query.m_ignoreActor = projectile;
+	m_map->GetActorsInRadius(query, m_candidateActors);
+
+	//the owner may already be gone, a stale handle resolves to nobody
+	Actor const* owner = m_map->GetActorByUID(projectile->m_projectileOwnerUID);
+
+	Vec2 start = Vec2(projectile->m_position.x, projectile->m_position.y);
+	Vec2 displacementXY = Vec2(displacement.x, displacement.y);
+	for (int candidateIndex = 0; candidateIndex < m_candidateActors.size(); candidateIndex++)
+	{
+		Actor* candidate = m_candidateActors[candidateIndex];
+
+		//owners can't shoot themselves, and projectiles pass through each other
+		if (candidate == owner || candidate->m_health <= 0 || !candidate->m_definition->m_collideWithActors || candidate->m_definition->m_isProjectile)
+		{
+			continue;
+		}
+
+		IncrementPerfCounter(PerfCounter::COLLISION_PAIRS_TESTED);
+
+		float fraction = 1.0f;
+		Vec2 candidateCenter = Vec2(candidate->m_position.x, candidate->m_position.y);
+		if (!SweepDiscAgainstDisc2D(start, displacementXY, candidateCenter, projectile->m_physicsRadius + candidate->m_physicsRadius, fraction) || fraction >= inout_hit.m_fraction)
+		{
+			continue;
+		}
+
+		//the discs touch at this point of the move, it's only a hit if the heights overlap there too
+		float bottom = projectile->m_position.z + displacement.z * fraction;
+		if (bottom > candidate->m_position.z + candidate->m_physicsHeight || bottom + projectile->m_physicsHeight < candidate->m_position.z)
+		{
+			continue;
+		}
+
+		Vec2 contactNormal = (start + displacementXY * fraction - candidateCenter).GetNormalized();
+		inout_hit.m_fraction = fraction;
+		inout_hit.m_normal = Vec3(contactNormal.x, contactNormal.y, 0.0f);
+		inout_hit.m_actorHit = candidate;
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "Game/ActorUID.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/Vec3.hpp"
+
+
+//forward declarations
+class Map;
+class Actor;
+
+
+//earliest contact along one projectile's move this tick, as a fraction of the move
+struct ProjectileSweepHit
+{
+	float  m_fraction = 1.0f;
+	Vec3   m_normal;
+	Actor* m_actorHit = nullptr;	//null for walls, floor and ceiling
+};
+
+
+//projectiles are still actors so they render, replicate and snapshot like everything else, but their motion and collision
+//live here: each in-flight projectile sweeps its disc along its move against the tile grid and the actor buckets,
+//so fast shots can't tunnel through thin walls and none of them add to the actor pair loop
+class ProjectileSystem
+{
+//public member functions
+public:
+	//constructor
+	explicit ProjectileSystem(Map* map);
+
+	//game flow functions
+	void Update(float deltaSeconds);
+
+	//projectile utilities
+	void AddProjectile(Actor const* projectile);
+	void ClearProjectiles();
+
+	//accessors
+	int GetNumProjectiles() const;
+
+//public member variables
+public:
+	Map* m_map = nullptr;
+
+	std::vector<ActorUID> m_projectileUIDs;		//in-flight projectiles packed with no holes, dead ones are swapped out
+	std::vector<Actor*>	  m_candidateActors;	//reused by every actor sweep
+
+//private member functions
+private:
+	void SweepAgainstTiles(Actor const* projectile, Vec3 const& displacement, ProjectileSweepHit& inout_hit) const;
+	void SweepAgainstFloorAndCeiling(Actor const* projectile, Vec3 const& displacement, ProjectileSweepHit& inout_hit) const;
+	void SweepAgainstActors(Actor const* projectile, Vec3 const& displacement, ProjectileSweepHit& inout_hit);
+};
@@ -0,0 +1,344 @@
+#include "Game/VoiceManager.hpp"
+#include "Game/Map.hpp"
+#include "Game/Actor.hpp"
+#include "Game/Player.hpp"
+#include "Game/GameCommon.hpp"
+#include "Engine/Math/MathUtils.hpp"
+
+
+//
+//constructor
+//
+VoiceManager::VoiceManager(Map const* map)
+	: m_map(map)
+{
+	m_maxAudibleVoices = g_gameConfigBlackboard.GetValue("maxAudibleVoices", m_maxAudibleVoices);
+	m_maxAudibleDistance = g_gameConfigBlackboard.GetValue("maxAudibleDistance", m_maxAudibleDistance);
+}
+
+
+//
+//public game flow functions
+//
+void VoiceManager::Update()
+{
+	m_startedThisFrameIndexes.clear();
+
+	for (int voiceIndex = 0; voiceIndex < m_voices.size(); voiceIndex++)
+	{
+		Voice& voice = m_voices[voiceIndex];
+		if (!voice.m_isActive)
+		{
+			continue;
+		}
+
+		//attached voices follow their actor, and loops die with it
+		if (voice.m_ownerUID.IsValid())
+		{
+			Actor const* owner = m_map->GetActorByUID(voice.m_ownerUID);
+			if (owner != nullptr)
+			{
+				voice.m_position = owner->m_position;
+			}
+			else if (voice.m_isLooping)
+			{
+				FreeVoice(voiceIndex);
+				continue;
+			}
+		}
+
+		if (voice.m_playback != MISSING_SOUND_ID)
+		{
+			//only audible one-shots ever need to ask the audio system whether they finished
+			if (!voice.m_isLooping && !g_theAudio->IsPlaying(voice.m_playback))
+			{
+				FreeVoice(voiceIndex);
+				continue;
+			}
+		}
+
+		voice.m_score = GetVoiceScore(voice);
+	}
+
+	for (int voiceIndex = 0; voiceIndex < m_voices.size(); voiceIndex++)
+	{
+		Voice& voice = m_voices[voiceIndex];
+		if (!voice.m_isActive)
+		{
+			continue;
+		}
+
+		if (voice.m_playback != MISSING_SOUND_ID)
+		{
+			if (voice.m_score <= 0.0f)
+			{
+				MakeVirtual(voiceIndex);
+				continue;
+			}
+
+			if (voice.m_ownerUID.IsValid())
+			{
+				g_theAudio->SetSoundPosition(voice.m_playback, voice.m_position);
+			}
+		}
+		else if (voice.m_isLooping && voice.m_score > 0.0f)
+		{
+			TryMakeAudible(voiceIndex);
+		}
+	}
+}
+
+
+void VoiceManager::Shutdown()
+{
+	StopAllVoices();
+	m_voices.clear();
+	m_freeVoiceIndexes.clear();
+}
+
+
+//
+//public voice utilities
+//
+VoiceID VoiceManager::StartVoice(SoundID soundID, ActorUID ownerUID, Vec3 const& position, bool isLooping, float volume, VoicePriority priority)
+{
+	if (soundID == MISSING_SOUND_ID)
+	{
+		return INVALID_VOICE_ID;
+	}
+
+	//identical one-shots started close together in the same frame only need one voice
+	if (!isLooping)
+	{
+		float coalesceDistanceSquared = m_coalesceDistance * m_coalesceDistance;
+		for (int startedIndex = 0; startedIndex < m_startedThisFrameIndexes.size(); startedIndex++)
+		{
+			int voiceIndex = m_startedThisFrameIndexes[startedIndex];
+			Voice const& voice = m_voices[voiceIndex];
+			if (voice.m_isActive && !voice.m_isLooping && voice.m_soundID == soundID && GetDistanceSquared3D(voice.m_position, position) < coalesceDistanceSquared)
+			{
+				return (voice.m_generation << 16) | static_cast<unsigned int>(voiceIndex);
+			}
+		}
+	}
+
+	int voiceIndex = AllocateVoice();
+	Voice& voice = m_voices[voiceIndex];
+	voice.m_soundID = soundID;
+	voice.m_ownerUID = ownerUID;
+	voice.m_position = position;
+	voice.m_isLooping = isLooping;
+	voice.m_volume = volume;
+	voice.m_priority = priority;
+	voice.m_score = GetVoiceScore(voice);
+
+	bool isAudible = voice.m_score > 0.0f && TryMakeAudible(voiceIndex);
+	if (!isAudible && !isLooping)
+	{
+		//one-shots that can't be heard now are never worth resuming later
+		FreeVoice(voiceIndex);
+		return INVALID_VOICE_ID;
+	}
+
+	m_startedThisFrameIndexes.push_back(voiceIndex);
+	return (m_voices[voiceIndex].m_generation << 16) | static_cast<unsigned int>(voiceIndex);
+}
+
+
+void VoiceManager::StopVoice(VoiceID voiceID)
+{
+	int voiceIndex = GetVoiceIndex(voiceID);
+	if (voiceIndex != -1)
+	{
+		FreeVoice(voiceIndex);
+	}
+}
+
+
+void VoiceManager::StopAllVoices()
+{
+	for (int voiceIndex = 0; voiceIndex < m_voices.size(); voiceIndex++)
+	{
+		if (m_voices[voiceIndex].m_isActive)
+		{
+			FreeVoice(voiceIndex);
+		}
+	}
+}
+
+
+//
+//public accessors
+//
+bool VoiceManager::IsVoiceActive(VoiceID voiceID) const
+{
+	return GetVoiceIndex(voiceID) != -1;
+}
+
+
+int VoiceManager::GetNumAudibleVoices() const
+{
+	return m_numAudibleVoices;
+}
+
+
+int VoiceManager::GetNumActiveVoices() const
+{
+	return static_cast<int>(m_voices.size() - m_freeVoiceIndexes.size());
+}
+
+
+float VoiceManager::GetVoiceScore(Voice const& voice) const
+{
+	//priority always outranks loudness, and anything past the audible distance scores zero
+	float distanceSquared = GetDistanceSquaredToNearestListener(voice.m_position);
+	if (distanceSquared >= m_maxAudibleDistance * m_maxAudibleDistance)
+	{
+		return 0.0f;
+	}
+
+	float attenuatedVolume = voice.m_volume * (1.0f - (sqrtf(distanceSquared) / m_maxAudibleDistance));
+	return static_cast<float>(voice.m_priority) * 2.0f + attenuatedVolume;
+}
+
+
+float VoiceManager::GetDistanceSquaredToNearestListener(Vec3 const& position) const
+{
+	float closestDistanceSquared = FLT_MAX;
+
+	for (int playerIndex = 0; playerIndex < m_map->m_players.size(); playerIndex++)
+	{
+		Player const* player = m_map->m_players[playerIndex];
+		if (player == nullptr)
+		{
+			continue;
+		}
+
+		float distanceSquared = GetDistanceSquared3D(player->m_position, position);
+		if (distanceSquared < closestDistanceSquared)
+		{
+			closestDistanceSquared = distanceSquared;
+		}
+	}
+
+	return closestDistanceSquared;
+}
+
+
+//
+//private voice functions
+//
+int VoiceManager::GetVoiceIndex(VoiceID voiceID) const
+{
+	if (voiceID == INVALID_VOICE_ID)
+	{
+		return -1;
+	}
+
+	int voiceIndex = static_cast<int>(voiceID & 65535);
+	if (voiceIndex >= m_voices.size())
+	{
+		return -1;
+	}
+
+	Voice const& voice = m_voices[voiceIndex];
+	if (!voice.m_isActive || (voice.m_generation & 65535) != (voiceID >> 16))
+	{
+		return -1;
+	}
+
+	return voiceIndex;
+}
+
+
+int VoiceManager::AllocateVoice()
+{
+	int voiceIndex = -1;
+	if (m_freeVoiceIndexes.empty())
+	{
+		voiceIndex = static_cast<int>(m_voices.size());
+		m_voices.push_back(Voice());
+	}
+	else
+	{
+		voiceIndex = m_freeVoiceIndexes.back();
+		m_freeVoiceIndexes.pop_back();
+	}
+
+	Voice& voice = m_voices[voiceIndex];
+	unsigned int generation = voice.m_generation;
+	voice = Voice();
+	voice.m_generation = generation;
+	voice.m_isActive = true;
+
+	return voiceIndex;
+}
+
+
+void VoiceManager::FreeVoice(int voiceIndex)
+{
+	Voice& voice = m_voices[voiceIndex];
+	if (voice.m_playback != MISSING_SOUND_ID)
+	{
+		g_theAudio->StopSound(voice.m_playback);
+		voice.m_playback = MISSING_SOUND_ID;
+		m_numAudibleVoices--;
+	}
+
+	voice.m_isActive = false;
+	voice.m_generation = (voice.m_generation + 1) & 65535;
+	m_freeVoiceIndexes.push_back(voiceIndex);
+}
+
+
+bool VoiceManager::TryMakeAudible(int voiceIndex)
+{
+	Voice& voice = m_voices[voiceIndex];
+
+	if (m_numAudibleVoices >= m_maxAudibleVoices)
+	{
+		//steal the weakest audible voice, but only if this one matters more
+		int weakestIndex = -1;
+		float weakestScore = FLT_MAX;
+		for (int otherIndex = 0; otherIndex < m_voices.size(); otherIndex++)
+		{
+			Voice const& otherVoice = m_voices[otherIndex];
+			if (otherVoice.m_isActive && otherVoice.m_playback != MISSING_SOUND_ID && otherVoice.m_score < weakestScore)
+			{
+				weakestScore = otherVoice.m_score;
+				weakestIndex = otherIndex;
+			}
+		}
+
+		if (weakestIndex == -1 || weakestScore >= voice.m_score)
+		{
+			return false;
+		}
+
+		MakeVirtual(weakestIndex);
+	}
+
+	voice.m_playback = g_theAudio->StartSoundAt(voice.m_soundID, voice.m_position, voice.m_isLooping, voice.m_volume);
+	m_numAudibleVoices++;
+	return true;
+}
+
+
+void VoiceManager::MakeVirtual(int voiceIndex)
+{
+	Voice& voice = m_voices[voiceIndex];
+
+	//loops keep their slot and restart when they become audible again, one-shots are just dropped
+	if (!voice.m_isLooping)
+	{
+		FreeVoice(voiceIndex);
+		return;
+	}
+
+	if (voice.m_playback != MISSING_SOUND_ID)
+	{
+		g_theAudio->StopSound(voice.m_playback);
+		voice.m_playback = MISSING_SOUND_ID;
+		m_numAudibleVoices--;
+	}
+}
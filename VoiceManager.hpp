@@ -0,0 +1,82 @@
+#pragma once
+#include "Game/ActorUID.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Math/Vec3.hpp"
+#include "Engine/Audio/AudioSystem.hpp"
+
+
+//forward declarations
+class Map;
+
+
+typedef unsigned int VoiceID;
+constexpr VoiceID INVALID_VOICE_ID = 0xffffffff;
+
+
+enum class VoicePriority
+{
+	LOW,
+	NORMAL,
+	HIGH,
+};
+
+
+struct Voice
+{
+	SoundID			m_soundID = MISSING_SOUND_ID;
+	SoundPlaybackID m_playback = MISSING_SOUND_ID;	//only set while the voice is audible, virtual loops keep their slot without one
+	ActorUID		m_ownerUID = ActorUID(ActorUID::INVALID, ActorUID::INVALID);
+	Vec3			m_position;
+	float			m_volume = 1.0f;
+	VoicePriority	m_priority = VoicePriority::NORMAL;
+	bool			m_isLooping = false;
+	bool			m_isActive = false;
+	float			m_score = 0.0f;
+	unsigned int	m_generation = 0;
+};
+
+
+class VoiceManager
+{
+//public member functions
+public:
+	//constructor
+	explicit VoiceManager(Map const* map);
+
+	//game flow functions
+	void Update();
+	void Shutdown();
+
+	//voice utilities
+	VoiceID StartVoice(SoundID soundID, ActorUID ownerUID, Vec3 const& position, bool isLooping = false, float volume = 1.0f, VoicePriority priority = VoicePriority::NORMAL);
+	void	StopVoice(VoiceID voiceID);
+	void	StopAllVoices();
+
+	//accessors
+	bool  IsVoiceActive(VoiceID voiceID) const;
+	int	  GetNumAudibleVoices() const;
+	int	  GetNumActiveVoices() const;
+	float GetVoiceScore(Voice const& voice) const;
+	float GetDistanceSquaredToNearestListener(Vec3 const& position) const;
+
+//private member functions
+private:
+	int	 GetVoiceIndex(VoiceID voiceID) const;
+	int	 AllocateVoice();
+	void FreeVoice(int voiceIndex);
+	bool TryMakeAudible(int voiceIndex);
+	void MakeVirtual(int voiceIndex);
+
+//public member variables
+public:
+	Map const* m_map = nullptr;
+
+	std::vector<Voice> m_voices;
+	std::vector<int>   m_freeVoiceIndexes;
+	std::vector<int>   m_startedThisFrameIndexes;	//for coalescing identical sounds started in the same frame
+	int				   m_numAudibleVoices = 0;
+
+	int	  m_maxAudibleVoices = 32;
+	float m_maxAudibleDistance = 24.0f;
+	float m_coalesceDistance = 1.0f;
+};
@@ -59,12 +59,12 @@ void Weapon::Fire()
 
 		if (result.m_actorHit != nullptr && !result.m_actorHit->m_definition->m_immuneToLight)
 		{
-			result.m_actorHit->AddImpulse(result.m_raycastResult.m_rayDirection * m_definition->m_focusLightImpulse);
+			m_owner->m_map->m_commandBuffer->QueueImpulse(result.m_actorHit->m_UID, result.m_raycastResult.m_rayDirection * m_definition->m_focusLightImpulse);
 
 			if (m_damageIntervalTimer <= 0.0f)
 			{
 				m_damageIntervalTimer = m_definition->m_focusLightDamageInterval;
-				result.m_actorHit->TakeDamage(m_owner->m_UID, static_cast<int>(m_definition->m_focusLightDamage));
+				m_owner->m_map->m_commandBuffer->QueueDamage(result.m_actorHit->m_UID, m_owner->m_UID, static_cast<int>(m_definition->m_focusLightDamage));
 			}
 		}
 	}
@@ -80,15 +80,16 @@ void Weapon::Fire()
 			{
 				int damageAmount = static_cast<int>(g_rng.RollRandomFloatInRange(m_definition->m_rayDamage.m_min, m_definition->m_rayDamage.m_max));
 
-				result.m_actorHit->TakeDamage(m_owner->m_UID, damageAmount);
-				result.m_actorHit->AddImpulse(result.m_raycastResult.m_rayDirection * m_definition->m_rayImpulse);
+				//pellets from one shot are summed per target when the buffer runs, so a volley is one hit
+				m_owner->m_map->m_commandBuffer->QueueDamage(result.m_actorHit->m_UID, m_owner->m_UID, damageAmount);
+				m_owner->m_map->m_commandBuffer->QueueImpulse(result.m_actorHit->m_UID, result.m_raycastResult.m_rayDirection * m_definition->m_rayImpulse);
 
-				//spawn blood splatter actor at impact position
-				m_owner->m_map->SpawnActor("BloodSplatter", result.m_raycastResult.m_impactPos, EulerAngles());
+				//spawn blood splatter effect at impact position
+				m_owner->m_map->m_commandBuffer->QueueSpawnEffect(m_definition->m_rayHitActorEffect, m_definition->m_rayHitActorEffectIndex, result.m_raycastResult.m_impactPos);
 			}
 			else
 			{
-				m_owner->m_map->SpawnActor("BulletHit", result.m_raycastResult.m_impactPos, EulerAngles());
+				m_owner->m_map->m_commandBuffer->QueueSpawnEffect(m_definition->m_rayHitWallEffect, m_definition->m_rayHitWallEffectIndex, result.m_raycastResult.m_impactPos);
 			}
 		}
 	}
@@ -98,53 +99,42 @@ void Weapon::Fire()
 		{
 			Vec3 randomVelocityDirection = GetRandomDirectionInCone(m_definition->m_projectileCone);
 
-			m_owner->m_map->SpawnProjectile(m_definition->m_projectileActor, m_owner->m_position + Vec3(0.0f, 0.0f, m_owner->m_definition->m_eyeHeight), m_owner->m_orientation, randomVelocityDirection * m_definition->m_projectileSpeed, m_owner);
+			m_owner->m_map->m_commandBuffer->QueueSpawnProjectile(m_definition->m_projectileActor, m_owner->m_position + Vec3(0.0f, 0.0f, m_owner->m_definition->m_eyeHeight), m_owner->m_orientation, randomVelocityDirection * m_definition->m_projectileSpeed, m_owner->m_UID);
 		}
 	}
 	if (m_definition->m_meleeCount > 0)
 	{
+		ActorRadiusQuery meleeQuery;
+		meleeQuery.m_center = m_owner->m_position;
+		meleeQuery.m_radius = m_definition->m_meleeRange;
+		meleeQuery.m_forwardXY = m_owner->GetModelMatrixYawOnly().GetIBasis2D();
+		meleeQuery.m_arcDegrees = m_definition->m_meleeArc;
+		meleeQuery.m_ignoreActor = m_owner;
+		if (m_owner->m_definition->m_faction == ActorFaction::DEMON)
+		{
+			meleeQuery.m_filterByFaction = true;
+			meleeQuery.m_faction = ActorFaction::MARINE;
+		}
+		if (m_owner->m_definition->m_faction == ActorFaction::MARINE)
+		{
+			meleeQuery.m_filterByFaction = true;
+			meleeQuery.m_faction = ActorFaction::DEMON;
+		}
+
+		//swings don't move anyone, so the same set of nearby targets is good for all of them
+		std::vector<Actor*> meleeTargets;
+		m_owner->m_map->GetActorsInRadius(meleeQuery, meleeTargets);
+
 		for (int meleeIndex = 0; meleeIndex < m_definition->m_meleeCount; meleeIndex++)
 		{
 			float closestEnemyDistance = FLT_MAX;
 			Actor* closestEnemy = nullptr;
 
-			for (int actorIndex = 0; actorIndex < m_owner->m_map->m_allActors.size(); actorIndex++)
+			for (int targetIndex = 0; targetIndex < meleeTargets.size(); targetIndex++)
 			{
-				Actor* target = m_owner->m_map->m_allActors[actorIndex];
-				if (target == nullptr)
-				{
-					continue;
-				}
-
-				if (m_owner->m_definition->m_faction == ActorFaction::DEMON)
-				{
-					if (target->m_definition->m_faction != ActorFaction::MARINE)
-					{
-						continue;
-					}
-				}
-				if (m_owner->m_definition->m_faction == ActorFaction::MARINE)
-				{
-					if (target->m_definition->m_faction != ActorFaction::DEMON)
-					{
-						continue;
-					}
-				}
+				Actor* target = meleeTargets[targetIndex];
 
 				float targetDistance = GetDistance3D(m_owner->m_position, target->m_position);
-				if (targetDistance > m_definition->m_meleeRange)
-				{
-					continue;
-				}
-
-				Vec3 targetDisplacement = target->m_position - m_owner->m_position;
-				Vec2 targetDisplacementXY = Vec2(targetDisplacement.x, targetDisplacement.y);
-				float targetDisplacementAngle = GetAngleDegreesBetweenVectors2D(m_owner->GetModelMatrixYawOnly().GetIBasis2D(), targetDisplacementXY);
-				if (targetDisplacementAngle > m_definition->m_meleeArc * 0.5f)
-				{
-					continue;
-				}
-
 				if (targetDistance < closestEnemyDistance)
 				{
 					closestEnemyDistance = targetDistance;
@@ -156,8 +146,8 @@ void Weapon::Fire()
 
 			if (closestEnemy != nullptr)
 			{
-				closestEnemy->TakeDamage(m_owner->m_UID, damageAmount);
-				closestEnemy->AddImpulse(m_owner->GetModelMatrixYawOnly().GetIBasis3D() * m_definition->m_meleeImpulse);
+				m_owner->m_map->m_commandBuffer->QueueDamage(closestEnemy->m_UID, m_owner->m_UID, damageAmount);
+				m_owner->m_map->m_commandBuffer->QueueImpulse(closestEnemy->m_UID, m_owner->GetModelMatrixYawOnly().GetIBasis3D() * m_definition->m_meleeImpulse);
 			}
 		}
 	}
@@ -1,5 +1,6 @@
 #include "Game/WeaponDefinition.hpp"
 #include "Game/Game.hpp"
+#include "Game/EffectDefinition.hpp"
 #include "Engine/Renderer/Shader.hpp"
 #include "Engine/Renderer/Texture.hpp"
 #include "Engine/Renderer/Renderer.hpp"
@@ -33,6 +34,11 @@ WeaponDefinition::WeaponDefinition(XmlElement const& element)
 	m_meleeImpulse = ParseXmlAttribute(element, "meleeImpulse", m_meleeImpulse);
 	m_holdToUse = ParseXmlAttribute(element, "holdToUse", m_holdToUse);
 
+	m_rayHitActorEffect = ParseXmlAttribute(element, "rayHitActorEffect", m_rayHitActorEffect);
+	m_rayHitWallEffect = ParseXmlAttribute(element, "rayHitWallEffect", m_rayHitWallEffect);
+	m_rayHitActorEffectIndex = EffectDefinition::GetEffectDefinitionIndex(m_rayHitActorEffect);
+	m_rayHitWallEffectIndex = EffectDefinition::GetEffectDefinitionIndex(m_rayHitWallEffect);
+
 	m_lightIntensity = ParseXmlAttribute(element, "lightIntensity", m_lightIntensity);
 	m_focusLightIntensity = ParseXmlAttribute(element, "focusLightIntensity", m_focusLightIntensity);
 	m_lightRadius = ParseXmlAttribute(element, "lightRadius", m_lightRadius);
@@ -60,6 +60,12 @@ public:
 	FloatRange  m_meleeDamage = FloatRange(0.0f, 0.0f);
 	float		m_meleeImpulse = 0.0f;
 	bool		m_holdToUse = false;
+
+	//ray hit effect parameters, indexes are looked up once at load and are -1 when the effect spawns as an actor instead
+	std::string m_rayHitActorEffect = "BloodSplatter";
+	std::string m_rayHitWallEffect = "BulletHit";
+	int			m_rayHitActorEffectIndex = -1;
+	int			m_rayHitWallEffectIndex = -1;
 	
 	//flashlight parameters
 	float		m_lightIntensity = 0.0f;